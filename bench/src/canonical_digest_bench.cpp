@@ -0,0 +1,81 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "kdlcpp/digest.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+#include "kdlcpp/detail/sha256.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Measures the throughput of hashing the canonical serialization of a large
+ * document, streamed into the digest and through a materialized string.
+ *
+ * Usage: kdlcpp_canonical_digest_bench [routes] [iterations]
+ */
+
+namespace {
+
+document make_document(std::size_t routes) {
+  document doc;
+  for (std::size_t r = 0; r < routes; ++r) {
+    node route{"route"};
+    route.get_arguments().push_back(value{"/api/v1/item" + std::to_string(r)});
+    route.get_properties().insert("weight", value{static_cast<double>(r % 10) * 0.1});
+    route.get_properties().insert("method", value{string_type{"GET"}});
+    route.get_properties().insert("enabled", value{r % 3 != 0});
+    node retry{"retry-policy"};
+    retry.get_properties().insert("attempts", value{3});
+    retry.get_properties().insert("backoff", value{0.25});
+    route.get_children().push_back(std::move(retry));
+    doc.root().get_children().push_back(std::move(route));
+  }
+  return doc;
+}
+
+template <typename function_type>
+double measure_ms(std::size_t iterations, function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    function();
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count() / static_cast<double>(iterations);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t routes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  const std::size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+  const document doc = make_document(routes);
+
+  serialize_options options;
+  options.output_style = serialize_options::style::canonical;
+  stream<std::ostringstream> text{std::ostringstream{}};
+  detail::serialize::serialize_document(text, doc, options);
+  const double megabytes = static_cast<double>(text.get().str().size()) / (1024.0 * 1024.0);
+
+  digest_type sink{};
+  const double streamed = measure_ms(iterations, [&] { sink = canonical_digest(doc); });
+  const double materialized = measure_ms(iterations, [&] {
+    stream<std::ostringstream> out{std::ostringstream{}};
+    detail::serialize::serialize_document(out, doc, options);
+    detail::sha256 hash;
+    hash.update(out.get().str());
+    sink = hash.finish();
+  });
+  const double hash_only = measure_ms(iterations, [&] {
+    detail::sha256 hash;
+    hash.update(text.get().str());
+    sink = hash.finish();
+  });
+
+  std::cout << "canonical text: " << megabytes << " MiB, digest " << to_hex(sink).substr(0, 16) << "...\n"
+            << "streamed digest:        " << streamed << " ms (" << megabytes / streamed * 1000 << " MiB/s)\n"
+            << "serialize, then hash:   " << materialized << " ms\n"
+            << "sha256 of text alone:   " << hash_only << " ms (" << megabytes / hash_only * 1000 << " MiB/s)\n";
+  return 0;
+}
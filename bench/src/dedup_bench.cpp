@@ -0,0 +1,52 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "kdlcpp/dedup.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Measures a deduplication pass over a generated route table where every
+ * route carries the same retry policy and headers, and the memory it saves.
+ *
+ * Usage: kdlcpp_dedup_bench [routes]
+ */
+
+namespace {
+
+string_type make_text(std::size_t routes) {
+  string_type text;
+  for (std::size_t r = 0; r < routes; ++r) {
+    text += "route \"/api/v1/item" + std::to_string(r) + "\" {\n"
+            "  retry-policy attempts=3 backoff=\"exponential-with-jitter\" max-delay=30.0 {\n"
+            "    retry-on \"connection-reset\" \"gateway-timeout\" \"service-unavailable\"\n"
+            "  }\n"
+            "  headers {\n"
+            "    set \"x-forwarded-proto\" \"https\"\n"
+            "    set \"strict-transport-security\" \"max-age=31536000; includeSubDomains\"\n"
+            "  }\n"
+            "}\n";
+  }
+  return text;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t routes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  auto doc = detail::parse::parse_document(make_text(routes));
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto summary = deduplicate(doc);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << routes << " routes\n"
+            << "dedup pass:      " << std::chrono::duration<double, std::milli>(elapsed).count() << " ms\n"
+            << "shared subtrees: " << summary.shared_subtrees << "\n"
+            << "references:      " << summary.references << "\n"
+            << "bytes saved:     " << summary.bytes_saved / 1024 << " KiB ("
+            << summary.bytes_saved / routes << " per route)\n";
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "kdlcpp/document_builder.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Compares building a large document through the node API with building
+ * it through a document_builder, in time and in peak heap usage.
+ * Every top-level node gets a few children, each with arguments and
+ * properties.
+ *
+ * Usage: kdlcpp_document_builder_bench [top-level-nodes]
+ */
+
+namespace {
+
+std::atomic<std::size_t> live_bytes{0};
+std::atomic<std::size_t> peak_bytes{0};
+
+void track_allocation(std::size_t size) noexcept {
+  const auto live = live_bytes.fetch_add(size) + size;
+  auto peak = peak_bytes.load();
+  while (live > peak && !peak_bytes.compare_exchange_weak(peak, live)) {
+  }
+}
+
+/// Measures the time and the heap peak above the starting usage.
+template <typename function_type>
+void measure(const char* label, function_type function) {
+  peak_bytes = live_bytes.load();
+  const auto baseline = live_bytes.load();
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << label << std::chrono::duration<double, std::milli>(elapsed).count() << " ms, peak "
+            << static_cast<double>(peak_bytes.load() - baseline) / (1024.0 * 1024.0) << " MiB\n";
+}
+
+constexpr std::size_t children_per_node = 4;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+  // A size header records the size to release on delete.
+  auto* block = static_cast<std::size_t*>(std::malloc(size + sizeof(std::max_align_t)));
+  if (!block) {
+    throw std::bad_alloc{};
+  }
+  *block = size;
+  track_allocation(size);
+  return reinterpret_cast<char*>(block) + sizeof(std::max_align_t);
+}
+
+void operator delete(void* pointer) noexcept {
+  if (pointer) {
+    auto* block = reinterpret_cast<std::size_t*>(static_cast<char*>(pointer) - sizeof(std::max_align_t));
+    live_bytes.fetch_sub(*block);
+    std::free(block);
+  }
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  operator delete(pointer);
+}
+
+int main(int argc, char** argv) {
+  const std::size_t nodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  std::cout << nodes * (1 + children_per_node) << " nodes\n";
+
+  measure("node API:         ", [&] {
+    document doc;
+    for (std::size_t i = 0; i < nodes; ++i) {
+      node entry{"entry"};
+      entry.get_arguments().push_back(value{static_cast<value::integral>(i)});
+      for (std::size_t j = 0; j < children_per_node; ++j) {
+        node child{"field"};
+        child.get_arguments().push_back(value{static_cast<value::integral>(j)});
+        child.get_arguments().push_back(value{0.5});
+        child.get_properties().insert("kind", value{string_type{"scalar"}});
+        entry.get_children().push_back(child);
+      }
+      doc.root().get_children().push_back(entry);
+    }
+  });
+
+  measure("document_builder: ", [&] {
+    document_builder builder{nodes};
+    for (std::size_t i = 0; i < nodes; ++i) {
+      builder.begin_node("entry", {children_per_node, 1, 0}).arg(value{static_cast<value::integral>(i)});
+      for (std::size_t j = 0; j < children_per_node; ++j) {
+        builder.begin_node("field", {0, 2, 1})
+          .arg(value{static_cast<value::integral>(j)})
+          .arg(value{0.5})
+          .prop("kind", value{string_type{"scalar"}})
+          .end_node();
+      }
+      builder.end_node();
+    }
+    const document doc = builder.finish();
+  });
+  return 0;
+}
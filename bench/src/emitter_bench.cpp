@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "kdlcpp/emitter.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Compares exporting many nodes by building a document and serializing it
+ * with writing the same nodes through an emitter.
+ *
+ * Usage: kdlcpp_emitter_bench [nodes] [output-path]
+ */
+
+namespace {
+
+template <typename function_type>
+double measure(function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+stream<std::ofstream> open(const std::string& path) {
+  return stream<std::ofstream>{std::ofstream{path, std::ios::binary | std::ios::trunc}};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t nodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  const std::string path = argc > 2 ? argv[2] : "kdlcpp_emitter_bench.kdl";
+
+  const double tree = measure([&] {
+    node root{"export"};
+    auto& children = root.get_children();
+    for (std::size_t i = 0; i < nodes; ++i) {
+      node record{"record"};
+      record.get_arguments().push_back(value{static_cast<value::integral>(i)});
+      record.get_properties().insert("weight", value{0.5 * static_cast<double>(i)});
+      record.get_properties().insert("label", value{string_type{"item"}});
+      children.push_back(std::move(record));
+    }
+    auto out = open(path);
+    detail::serialize::serialize_node(out, root);
+  });
+
+  const double emitted = measure([&] {
+    auto out = open(path);
+    emitter<std::ofstream> writer{out};
+    writer.begin_node("export").begin_children();
+    for (std::size_t i = 0; i < nodes; ++i) {
+      writer.begin_node("record")
+        .arg(value{static_cast<value::integral>(i)})
+        .prop("label", value{string_type{"item"}})
+        .prop("weight", value{0.5 * static_cast<double>(i)})
+        .end_node();
+    }
+    writer.end_node();
+    writer.flush();
+  });
+
+  std::remove(path.c_str());
+  std::cout << nodes << " nodes\n"
+            << "build tree + serialize: " << tree << " ms\n"
+            << "emitter:                " << emitted << " ms\n";
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "kdlcpp/detail/serialize.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Measures string classification and escaping throughput against memcpy,
+ * for clean ASCII strings and for strings needing escapes.
+ *
+ * Usage: kdlcpp_escape_bench [string-length] [iterations]
+ */
+
+namespace {
+
+/// Sink copying every write into a fixed buffer, wrapping around when full,
+/// as an output buffer flushed to I/O would.
+struct buffer_sink {
+  std::vector<char> bytes = std::vector<char>(1 << 20);
+  std::size_t used = 0;
+
+  buffer_sink& operator<<(std::string_view text) {
+    if (used + text.size() > bytes.size()) {
+      used = 0;
+    }
+    std::memcpy(bytes.data() + used, text.data(), text.size());
+    used += text.size();
+    return *this;
+  }
+
+  buffer_sink& operator<<(char c) {
+    return *this << std::string_view{&c, 1};
+  }
+};
+
+template <typename function_type>
+double gigabytes_per_second(std::size_t bytes, std::size_t iterations, function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    function();
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(bytes * iterations) / elapsed.count() / 1e9;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t length = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+  const std::size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+
+  string_type clean(length, 'a');
+  for (std::size_t i = 7; i < length; i += 8) {
+    clean[i] = ' ';
+  }
+  string_type dirty = clean;
+  for (std::size_t i = 63; i < length; i += 64) {
+    dirty[i] = '"';
+  }
+
+  std::vector<char> target(length + 16);
+  const double copy = gigabytes_per_second(length, iterations, [&] {
+    std::memcpy(target.data(), clean.data(), clean.size());
+    asm volatile("" : : "r"(target.data()) : "memory");
+  });
+
+  std::size_t classes = 0;
+  const double classify = gigabytes_per_second(length, iterations, [&] {
+    classes += static_cast<std::size_t>(detail::escape::classify(clean));
+  });
+
+  auto run_serialize = [&](const string_type& text) {
+    stream<buffer_sink> out{buffer_sink{}};
+    return gigabytes_per_second(length, iterations, [&] {
+      detail::serialize::serialize_string(out, text, true);
+    });
+  };
+
+  std::cout << "string length: " << length << " bytes\n"
+            << "memcpy:                   " << copy << " GB/s\n"
+            << "classify (clean ASCII):   " << classify << " GB/s\n"
+            << "serialize (clean ASCII):  " << run_serialize(clean) << " GB/s\n"
+            << "serialize (1 escape/64B): " << run_serialize(dirty) << " GB/s\n"
+            << (classes == 0 ? "" : "\n");
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "kdlcpp/incremental_document.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Compares the cost of reloading a large KDL text after a one-byte edit
+ * through a full parse and through incremental_document::update().
+ *
+ * Usage: kdlcpp_incremental_document_bench [top-level-nodes] [iterations]
+ */
+
+namespace {
+
+string_type make_text(std::size_t nodes) {
+  string_type text;
+  for (std::size_t i = 0; i < nodes; ++i) {
+    text += "route \"/api/v1/item" + std::to_string(i) + "\" weight=" +
+            std::to_string(i % 10) + " {\n  retry 3 backoff=0.5\n  timeout 30\n}\n";
+  }
+  return text;
+}
+
+template <typename function_type>
+double measure(std::size_t iterations, function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    function(i);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t nodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  const std::size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+  // Two versions differing by one digit in the middle of the text.
+  const string_type original = make_text(nodes);
+  string_type edited = original;
+  const auto middle = edited.find("timeout 30", edited.size() / 2);
+  edited[middle + 8] = '4';
+
+  std::size_t sink = 0;
+  const double full = measure(iterations, [&](std::size_t i) {
+    sink += detail::parse::parse_document(i % 2 ? original : edited).root().get_children().size();
+  });
+
+  incremental_document doc{original};
+  const double incremental = measure(iterations, [&](std::size_t i) {
+    sink += doc.update(i % 2 ? original : edited).reparsed_bytes;
+  });
+
+  std::cout << "text: " << original.size() / 1024 << " KiB, " << nodes << " top-level nodes\n"
+            << "full parse:         " << full << " us/reload\n"
+            << "incremental update: " << incremental << " us/reload\n"
+            << (sink == 0 ? "" : "\n");
+  return 0;
+}
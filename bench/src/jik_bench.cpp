@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "kdlcpp/jik.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Compares the throughput of the JSON-in-KDL transcoder, in both
+ * directions, with parsing the same KDL into a document.
+ *
+ * Usage: kdlcpp_jik_bench [records]
+ */
+
+namespace {
+
+template <typename function_type>
+double measure(function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+/// Discards its input, so that only the transcoding is measured.
+struct null_sink {
+  template <typename value_type>
+  null_sink& operator<<(const value_type&) noexcept {
+    return *this;
+  }
+};
+
+double mib_per_s(std::size_t bytes, double ms) {
+  return static_cast<double>(bytes) / (1024.0 * 1024.0) / (ms / 1000.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t records = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+
+  std::ostringstream text;
+  text << "- {\n";
+  for (std::size_t i = 0; i < records; ++i) {
+    text << "  - id=" << i << " name=\"record " << i << "\" weight=" << (0.25 * static_cast<double>(i))
+         << " active=#true { tags \"a\" \"b\" \"c\" }\n";
+  }
+  text << "}\n";
+  const string_type kdl = text.str();
+
+  stream<std::stringstream> json_out{std::stringstream{}};
+  kdl_to_json(kdl, json_out);
+  const string_type json = json_out.get().str();
+
+  const double parsed = measure([&] { (void)detail::parse::parse_document(kdl); });
+  const double to_json = measure([&] {
+    stream<null_sink> out{null_sink{}};
+    kdl_to_json(kdl, out);
+  });
+  const double to_kdl = measure([&] {
+    stream<null_sink> out{null_sink{}};
+    json_to_kdl(json, out);
+  });
+
+  std::cout << records << " records, " << kdl.size() << " bytes of KDL, " << json.size() << " bytes of JSON\n"
+            << "parse_document: " << parsed << " ms (" << mib_per_s(kdl.size(), parsed) << " MiB/s)\n"
+            << "kdl_to_json:    " << to_json << " ms (" << mib_per_s(kdl.size(), to_json) << " MiB/s)\n"
+            << "json_to_kdl:    " << to_kdl << " ms (" << mib_per_s(json.size(), to_kdl) << " MiB/s)\n";
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "kdlcpp/detail/parse.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Compares the size of a document written in each serializer style,
+ * and the time taken to write it and to parse it back.
+ *
+ * Usage: kdlcpp_layout_bench [sections] [entries-per-section]
+ */
+
+namespace {
+
+document make_document(std::size_t sections, std::size_t entries) {
+  document doc;
+  for (std::size_t s = 0; s < sections; ++s) {
+    node section{"section"};
+    for (std::size_t e = 0; e < entries; ++e) {
+      node entry{"entry"};
+      entry.get_arguments().push_back(value{static_cast<value::integral>(e)});
+      entry.get_properties().insert("enabled", value{e % 2 == 0});
+      node limit{"limit"};
+      limit.get_arguments().push_back(value{0.5});
+      entry.get_children().push_back(std::move(limit));
+      section.get_children().push_back(std::move(entry));
+    }
+    doc.root().get_children().push_back(std::move(section));
+  }
+  return doc;
+}
+
+template <typename function_type>
+double measure_ms(function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t sections = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+  const std::size_t entries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+  const document doc = make_document(sections, entries);
+
+  const std::pair<const char*, serialize_options::style> styles[] = {
+    {"standard", serialize_options::style::standard},
+    {"compact ", serialize_options::style::compact},
+    {"pretty  ", serialize_options::style::pretty},
+  };
+  for (const auto& [label, style] : styles) {
+    serialize_options options;
+    options.output_style = style;
+
+    string_type text;
+    const double write = measure_ms([&] {
+      stream<std::ostringstream> out{std::ostringstream{}};
+      detail::serialize::serialize_document(out, doc, options);
+      text = out.get().str();
+    });
+    const double parse = measure_ms([&] { detail::parse::parse_document(text); });
+
+    std::cout << label << ": " << text.size() / 1024 << " KiB, write " << write
+              << " ms, parse " << parse << " ms\n";
+  }
+  return 0;
+}
@@ -0,0 +1,75 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Compares loading a large KDL text and reading a single top-level section
+ * through a full parse and through a lazy parse.
+ *
+ * Usage: kdlcpp_lazy_parse_bench [sections] [entries-per-section] [iterations]
+ */
+
+namespace {
+
+string_type make_text(std::size_t sections, std::size_t entries) {
+  string_type text;
+  for (std::size_t s = 0; s < sections; ++s) {
+    text += "section \"s" + std::to_string(s) + "\" {\n";
+    for (std::size_t e = 0; e < entries; ++e) {
+      text += "  entry " + std::to_string(e) + " label=\"item {" + std::to_string(e) +
+              "}\" {\n    value 0.25 1.5\n  }\n";
+    }
+    text += "}\n";
+  }
+  return text;
+}
+
+template <typename function_type>
+double measure(std::size_t iterations, function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    function();
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count() / static_cast<double>(iterations);
+}
+
+/// Reads every value of one section.
+std::size_t read_section(const node& section) {
+  std::size_t count = 0;
+  for (const auto& entry : section.get_children()) {
+    for (const auto& item : entry.get_children()) {
+      count += item.get_arguments().size();
+    }
+  }
+  return count;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t sections = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  const std::size_t entries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500;
+  const std::size_t iterations = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5;
+  const string_type text = make_text(sections, entries);
+
+  std::size_t sink = 0;
+  const double full = measure(iterations, [&] {
+    const auto doc = detail::parse::parse_document(text);
+    sink += read_section(doc.root().get_children()[sections / 2]);
+  });
+  const double lazy = measure(iterations, [&] {
+    const auto doc = detail::parse::parse_document_lazy(text);
+    sink += read_section(doc.root().get_children()[sections / 2]);
+  });
+
+  std::cout << "text: " << text.size() / 1024 << " KiB, " << sections << " sections\n"
+            << "full parse, read one section: " << full << " ms\n"
+            << "lazy parse, read one section: " << lazy << " ms\n"
+            << (sink == 0 ? "" : "\n");
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "kdlcpp/detail/parse.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Measures numeric throughput: formatting decimals and integers through
+ * the serializer versus std::ostream insertion, and parsing them back.
+ *
+ * Usage: kdlcpp_number_bench [numbers-per-kind]
+ */
+
+namespace {
+
+template <typename function_type>
+double millions_per_second(std::size_t count, function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(count) / elapsed.count() / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+  node samples{"samples"};
+  node counters{"counters"};
+  for (std::size_t i = 0; i < count; ++i) {
+    samples.get_arguments().push_back(value{static_cast<double>(i) * 1.000123 + 0.1});
+    counters.get_arguments().push_back(value{static_cast<value::integral>(i * 2654435761u)});
+  }
+
+  std::string decimals_text;
+  std::string integrals_text;
+  const double decimal_format = millions_per_second(count, [&] {
+    stream<std::ostringstream> out{std::ostringstream{}};
+    detail::serialize::serialize_node(out, samples);
+    decimals_text = out.get().str();
+  });
+  const double integral_format = millions_per_second(count, [&] {
+    stream<std::ostringstream> out{std::ostringstream{}};
+    detail::serialize::serialize_node(out, counters);
+    integrals_text = out.get().str();
+  });
+  const double ostream_format = millions_per_second(count, [&] {
+    std::ostringstream out;
+    out.precision(17);
+    for (const auto number : *samples.get_arguments().packed_decimals()) {
+      out << number << ' ';
+    }
+  });
+
+  const double decimal_parse = millions_per_second(count, [&] {
+    detail::parse::parse_document(decimals_text);
+  });
+  const double integral_parse = millions_per_second(count, [&] {
+    detail::parse::parse_document(integrals_text);
+  });
+
+  std::cout << count << " numbers per kind\n"
+            << "format decimals (to_chars):        " << decimal_format << " M/s\n"
+            << "format decimals (ostream, 17 dig): " << ostream_format << " M/s\n"
+            << "format integrals:                  " << integral_format << " M/s\n"
+            << "parse decimals:                    " << decimal_parse << " M/s\n"
+            << "parse integrals:                   " << integral_parse << " M/s\n";
+  return 0;
+}
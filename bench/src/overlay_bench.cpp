@@ -0,0 +1,105 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "kdlcpp/overlay.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Measures the cost of a reload through an overlay of base, region and
+ * host layers against merging them into a new document, and the cost of
+ * property lookups through the overlay against the merged document.
+ *
+ * Usage: kdlcpp_overlay_bench [sections] [keys-per-section] [lookups]
+ */
+
+namespace {
+
+template <typename function_type>
+double milliseconds(function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+/// A layer setting every n-th key of every n-th section.
+document make_layer(std::size_t sections, std::size_t keys, std::size_t stride, int tag) {
+  std::string text;
+  for (std::size_t s = 0; s < sections; s += stride) {
+    text += "section-" + std::to_string(s) + " {\n";
+    for (std::size_t k = 0; k < keys; k += stride) {
+      text += "  key-" + std::to_string(k) + " " + std::to_string(tag) + " source=\"layer-" +
+              std::to_string(tag) + "\"\n";
+    }
+    text += "}\n";
+  }
+  return detail::parse::parse_document(text);
+}
+
+const node* find_child(const node& parent, const std::string& name) {
+  for (const auto& child : parent.get_children()) {
+    if (child.get_name() == name) {
+      return &child;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t sections = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  const std::size_t keys = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+  const std::size_t lookups = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 200000;
+
+  const document base = make_layer(sections, keys, 1, 0);
+  const document region = make_layer(sections, keys, 3, 1);
+  const document host = make_layer(sections, keys, 10, 2);
+
+  overlay view;
+  const double reload_overlay = milliseconds([&] {
+    view = overlay{};
+    view.push_layer(base);
+    view.push_layer(region);
+    view.push_layer(host);
+  });
+  document merged;
+  const double reload_merge = milliseconds([&] {
+    merged = view.materialize();
+  });
+
+  std::mt19937 random{7};
+  std::vector<std::pair<std::string, std::string>> paths;
+  for (std::size_t i = 0; i < lookups; ++i) {
+    paths.emplace_back("section-" + std::to_string(random() % sections), "key-" + std::to_string(random() % keys));
+  }
+
+  long long checksum = 0;
+  const double lookup_merged = milliseconds([&] {
+    for (const auto& [section, key] : paths) {
+      const node* found = find_child(*find_child(merged.root(), section), key);
+      checksum += *found->get_arguments().at(0)->get<value::integral>();
+    }
+  });
+  const double lookup_overlay = milliseconds([&] {
+    const overlay_node root = view.root();
+    for (const auto& [section, key] : paths) {
+      const auto found = root.get_child(section)->get_child(key);
+      checksum -= *found->get_arguments().at(0)->get<value::integral>();
+    }
+  });
+
+  std::cout << "layers: 3, " << sections << " sections of " << keys << " keys\n"
+            << "reload, overlay:        " << reload_overlay << " ms\n"
+            << "reload, merge:          " << reload_merge << " ms\n"
+            << "lookup, merged document: " << lookup_merged * 1e6 / lookups << " ns\n"
+            << "lookup, overlay:         " << lookup_overlay * 1e6 / lookups << " ns\n"
+            << (checksum == 0 ? "" : "checksum mismatch\n");
+  return checksum == 0 ? 0 : 1;
+}
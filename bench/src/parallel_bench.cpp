@@ -0,0 +1,80 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include "kdlcpp/parallel.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Compares an expensive per-node computation run by a sequential
+ * recursion with parallel_transform_reduce() on pools of increasing size.
+ *
+ * Usage: kdlcpp_parallel_bench [top-level-nodes] [work-per-node]
+ */
+
+namespace {
+
+template <typename function_type>
+double measure(function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+/// Stands for an expensive transform, such as resolving a secret.
+std::uint64_t work(const node& current, std::size_t rounds) {
+  std::uint64_t hash = 1469598103934665603ull;
+  for (std::size_t round = 0; round < rounds; ++round) {
+    for (const char c : current.get_name()) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+std::uint64_t sequential(const node& current, std::size_t rounds) {
+  std::uint64_t result = work(current, rounds);
+  for (const auto& child : current.get_children()) {
+    result ^= sequential(child, rounds);
+  }
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t nodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  const std::size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+
+  node root{"root"};
+  for (std::size_t i = 0; i < nodes; ++i) {
+    node entry{"entry-" + std::to_string(i)};
+    for (std::size_t j = 0; j < i % 8; ++j) {
+      entry.get_children().emplace_back("value-" + std::to_string(j));
+    }
+    root.get_children().push_back(std::move(entry));
+  }
+
+  std::uint64_t expected = 0;
+  const double baseline = measure([&] { expected = sequential(root, rounds); });
+  std::cout << nodes << " top-level nodes, " << rounds << " rounds per node\n"
+            << "sequential: " << baseline << " ms\n";
+
+  const auto hardware = std::max(1u, std::thread::hardware_concurrency());
+  for (std::size_t threads = 1; threads <= hardware; threads *= 2) {
+    thread_pool pool{threads};
+    std::uint64_t result = 0;
+    const double elapsed = measure([&] {
+      result = parallel_transform_reduce(pool, root, std::uint64_t{0},
+        [&](const node& current) { return work(current, rounds); },
+        [](std::uint64_t a, std::uint64_t b) { return a ^ b; });
+    });
+    std::cout << threads << " threads: " << elapsed << " ms (x" << baseline / elapsed << ")"
+              << (result == expected ? "" : " MISMATCH") << '\n';
+  }
+  return 0;
+}
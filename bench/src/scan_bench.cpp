@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "kdlcpp/detail/parse.hpp"
+#include "kdlcpp/detail/scan.hpp"
+
+using namespace kdlcpp;
+using namespace kdlcpp::detail::scan;
+
+/**
+ * Measures UTF-8 validation, byte-set scans and document parsing on each
+ * instruction set the CPU supports, for ASCII text and for text mixing
+ * multi-byte code points.
+ *
+ * Usage: kdlcpp_scan_bench [text-length] [iterations]
+ */
+
+namespace {
+
+template <typename function_type>
+double gigabytes_per_second(std::size_t bytes, std::size_t iterations, function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    function();
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(bytes * iterations) / elapsed.count() / 1e9;
+}
+
+/// A document of string-heavy nodes, about length bytes long.
+std::string make_document(std::size_t length, bool ascii) {
+  const std::string word = ascii ? "value" : "caf\xC3\xA9\xE2\x82\xAC";
+  std::string text;
+  for (std::size_t i = 0; text.size() < length; ++i) {
+    text += "entry-" + std::to_string(i) + " \"";
+    for (int j = 0; j < 8; ++j) {
+      text += word + ' ';
+    }
+    text += "\" // " + word + " note\n";
+  }
+  return text;
+}
+
+const char* isa_name(isa kind) {
+  switch (kind) {
+    case isa::scalar: return "scalar";
+    case isa::sse42: return "sse4.2";
+    case isa::avx2: return "avx2";
+  }
+  return "?";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t length = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 16;
+  const std::size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+
+  const std::string ascii = make_document(length, true);
+  const std::string mixed = make_document(length, false);
+  const std::string plain(ascii.size(), 'k');
+  const isa best = active_isa();
+  std::size_t found = 0;
+
+  std::cout << "text length: " << ascii.size() << " bytes\n";
+  for (const isa kind : {isa::scalar, isa::sse42, isa::avx2}) {
+    if (!use_isa(kind)) {
+      continue;
+    }
+    const double validate_ascii = gigabytes_per_second(ascii.size(), iterations, [&] {
+      found += validate_utf8(ascii);
+    });
+    const double validate_mixed = gigabytes_per_second(mixed.size(), iterations, [&] {
+      found += validate_utf8(mixed);
+    });
+    const double find = gigabytes_per_second(plain.size(), iterations, [&] {
+      found += find_first_of_bulk(plain, identifier_stops);
+    });
+    const double parse_ascii = gigabytes_per_second(ascii.size(), iterations / 50 + 1, [&] {
+      found += detail::parse::parse_document(ascii).root().get_children().size();
+    });
+    const double parse_mixed = gigabytes_per_second(mixed.size(), iterations / 50 + 1, [&] {
+      found += detail::parse::parse_document(mixed).root().get_children().size();
+    });
+    std::cout << isa_name(kind) << ":\n"
+              << "  validate (ASCII):      " << validate_ascii << " GB/s\n"
+              << "  validate (mixed):      " << validate_mixed << " GB/s\n"
+              << "  find_first_of:         " << find << " GB/s\n"
+              << "  parse (ASCII):         " << parse_ascii << " GB/s\n"
+              << "  parse (mixed):         " << parse_mixed << " GB/s\n";
+  }
+  use_isa(best);
+  std::cout << (found == 0 ? "" : "\n");
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "kdlcpp/detail/serialize.hpp"
+
+using namespace kdlcpp;
+using namespace kdlcpp::detail::serialize;
+
+/**
+ * Compares re-serializing a large document after a one-node edit with
+ * serialize_document() and with serialize_document_cached().
+ *
+ * Usage: kdlcpp_serialize_cached_bench [sections] [entries-per-section]
+ */
+
+namespace {
+
+document make_document(std::size_t sections, std::size_t entries) {
+  document doc;
+  doc.set_name("telemetry");
+  auto& top = doc.root().get_children();
+  for (std::size_t s = 0; s < sections; ++s) {
+    node section{"section"};
+    section.get_properties().insert("id", value{static_cast<value::integral>(s)});
+    for (std::size_t e = 0; e < entries; ++e) {
+      node entry{"entry"};
+      entry.get_arguments().push_back(value{static_cast<value::integral>(e)});
+      entry.get_arguments().push_back(value{0.25 * static_cast<double>(e)});
+      entry.get_properties().insert("label", value{string_type{"sample"}});
+      section.get_children().push_back(std::move(entry));
+    }
+    top.push_back(std::move(section));
+  }
+  return doc;
+}
+
+template <typename function_type>
+double measure_ms(function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t sections = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+  const std::size_t entries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+
+  document doc = make_document(sections, entries);
+  std::size_t bytes = 0;
+  auto write = [&](auto serialize) {
+    stream<std::ostringstream> out{std::ostringstream{}};
+    serialize(out);
+    bytes = out.get().str().size();
+  };
+  auto edit = [&] {
+    doc.root().get_children()[sections / 2].get_children()[entries / 2]
+       .get_arguments().insert_at(0, value{value::integral{-1}});
+  };
+
+  const double plain = measure_ms([&] { write([&](auto& out) { serialize_document(out, doc); }); });
+  const double warm = measure_ms([&] { write([&](auto& out) { serialize_document_cached(out, doc); }); });
+  edit();
+  const double cached = measure_ms([&] { write([&](auto& out) { serialize_document_cached(out, doc); }); });
+
+  std::cout << sections * entries << " nodes, " << bytes / (1024 * 1024) << " MiB\n"
+            << "serialize_document:                  " << plain << " ms\n"
+            << "serialize_document_cached (cold):    " << warm << " ms\n"
+            << "serialize_document_cached (1 edit):  " << cached << " ms\n";
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "kdlcpp/shared_document.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Measures read throughput of many threads taking snapshots of a
+ * shared_document while a writer keeps publishing new versions, and
+ * compares it with the same workload behind a std::mutex.
+ *
+ * Usage: kdlcpp_shared_document_bench [readers] [milliseconds] [reload-us]
+ */
+
+namespace {
+
+document make_document(std::size_t nodes) {
+  document doc;
+  doc.set_name("config");
+  auto& children = doc.root().get_children();
+  for (std::size_t i = 0; i < nodes; ++i) {
+    node child{"entry"};
+    child.get_arguments().push_back(value{static_cast<value::integral>(i)});
+    child.get_properties().insert("enabled", value{true});
+    children.push_back(std::move(child));
+  }
+  return doc;
+}
+
+template <typename read_fn, typename write_fn>
+double run(std::size_t readers, std::chrono::milliseconds duration,
+           std::chrono::microseconds reload_period, read_fn read, write_fn write) {
+  std::atomic<bool> done{false};
+  std::atomic<std::uint64_t> total_reads{0};
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < readers; ++i) {
+    threads.emplace_back([&] {
+      std::uint64_t reads = 0;
+      std::uint64_t sink = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        sink += read();
+        ++reads;
+      }
+      total_reads += reads + (sink == 0xdeadbeef);
+    });
+  }
+
+  std::thread writer{[&] {
+    while (!done.load(std::memory_order_relaxed)) {
+      write();
+      std::this_thread::sleep_for(reload_period);
+    }
+  }};
+
+  std::this_thread::sleep_for(duration);
+  done = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  writer.join();
+
+  const auto seconds = std::chrono::duration<double>(duration).count();
+  return static_cast<double>(total_reads.load()) / seconds;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t readers = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                       : std::max(2u, std::thread::hardware_concurrency());
+  const std::chrono::milliseconds duration{argc > 2 ? std::strtol(argv[2], nullptr, 10) : 1000};
+  const std::chrono::microseconds reload{argc > 3 ? std::strtol(argv[3], nullptr, 10) : 1000};
+  constexpr std::size_t nodes = 1000;
+
+  auto read_document = [](const document& doc) -> std::uint64_t {
+    return doc.root().get_children().size() + doc.name().size();
+  };
+
+  shared_document shared{make_document(nodes), readers + 1};
+  const double lock_free = run(readers, duration, reload,
+    [&] { return read_document(*shared.acquire()); },
+    [&] { shared.publish(make_document(nodes)); });
+
+  std::mutex mutex;
+  document guarded = make_document(nodes);
+  const double locked = run(readers, duration, reload,
+    [&] {
+      std::lock_guard<std::mutex> lock{mutex};
+      return read_document(guarded);
+    },
+    [&] {
+      auto next = make_document(nodes);
+      std::lock_guard<std::mutex> lock{mutex};
+      guarded = std::move(next);
+    });
+
+  std::cout << "readers: " << readers
+            << ", reload every " << reload.count() << "us\n"
+            << "shared_document: " << lock_free / 1e6 << " Mreads/s\n"
+            << "std::mutex:      " << locked / 1e6 << " Mreads/s\n";
+  return 0;
+}
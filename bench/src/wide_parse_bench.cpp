@@ -0,0 +1,49 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+
+/**
+ * Parses documents of growing width, all nodes at the top level, and
+ * reports the time per node: it stays flat as long as appending a
+ * sibling does not depend on the number of siblings.
+ *
+ * Usage: kdlcpp_wide_parse_bench [top-level-nodes]
+ */
+
+namespace {
+
+string_type make_text(std::size_t nodes) {
+  string_type text;
+  for (std::size_t i = 0; i < nodes; ++i) {
+    text += "entry " + std::to_string(i) + " label=\"sample\"\n";
+  }
+  return text;
+}
+
+template <typename function_type>
+double measure_ms(function_type function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t largest = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 80000;
+
+  for (std::size_t nodes = largest / 4; nodes <= largest; nodes *= 2) {
+    const string_type text = make_text(nodes);
+    std::size_t parsed = 0;
+    const double elapsed = measure_ms([&] {
+      parsed = detail::parse::parse_document(text).root().get_children().size();
+    });
+    std::cout << parsed << " top-level nodes: " << elapsed << " ms, "
+              << elapsed * 1e6 / static_cast<double>(nodes) << " ns per node\n";
+  }
+  return 0;
+}
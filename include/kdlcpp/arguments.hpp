@@ -2,6 +2,8 @@
 
 #include "kdlcpp/value.hpp"
 
+#include <iterator>
+#include <variant>
 #include <vector>
 
 namespace kdlcpp {
@@ -11,36 +13,189 @@ namespace kdlcpp {
  * of unnamed values passed in a specific order. Each argument
  * is a kdlcpp::value and the order in which they are stored
  * is significant. arguments are always relative to a single node.
+ *
+ * While every argument is an integral, or every argument is a decimal,
+ * the list is stored packed as a plain array of that type. Inserting a
+ * value of another type switches transparently to generic storage.
  */
 class arguments {
 public:
+  /**
+   * The way arguments are currently stored.
+   */
+  enum class storage {
+    generic,   // A list of kdlcpp::value.
+    integral,  // A packed array of value::integral.
+    decimal    // A packed array of value::decimal.
+  };
+
+  /**
+   * Read-only iterator yielding each argument as a kdlcpp::value,
+   * whatever the storage.
+   */
+  class const_iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value;
+
+    const_iterator(const arguments* args, std::size_t index) noexcept
+      : m_args(args), m_index(index) {}
+
+    [[nodiscard]] value operator*() const noexcept {
+      return m_args->get(m_index);
+    }
+
+    const_iterator& operator++() noexcept {
+      ++m_index;
+      return *this;
+    }
+
+    const_iterator operator++(int) noexcept {
+      auto previous = *this;
+      ++m_index;
+      return previous;
+    }
+
+    [[nodiscard]] bool operator==(const const_iterator& other) const noexcept {
+      return m_index == other.m_index;
+    }
+
+    [[nodiscard]] bool operator!=(const const_iterator& other) const noexcept {
+      return m_index != other.m_index;
+    }
+
+  private:
+    const arguments* m_args;
+    std::size_t m_index;
+  };
+
+  /**
+   * An argument reached through a mutable iterator. It reads the argument
+   * without changing the storage, and writes it through insert_at(), so
+   * that packed storage is only given up for a value of another type.
+   */
+  class reference {
+  public:
+    reference(arguments* args, std::size_t index) noexcept
+      : m_args(args), m_index(index) {}
+
+    [[nodiscard]] operator value() const noexcept {
+      return m_args->get(m_index);
+    }
+
+    [[nodiscard]] value::type get_type() const noexcept {
+      return m_args->get_type(m_index);
+    }
+
+    template <typename T>
+    [[nodiscard]] std::optional<T> get() const noexcept {
+      if (const auto* list = std::get_if<generic_list>(&m_args->m_arguments_list)) {
+        return (*list)[m_index].template get<T>();
+      }
+      return m_args->get(m_index).template get<T>();
+    }
+
+    template <typename T>
+    void set(const T& val) {
+      m_args->insert_at(m_index, value{val});
+    }
+
+    reference& operator=(const value& val) {
+      m_args->insert_at(m_index, val);
+      return *this;
+    }
+
+  private:
+    arguments* m_args;
+    std::size_t m_index;
+  };
+
+  /**
+   * Iterator yielding each argument as an arguments::reference.
+   */
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = arguments::reference;
+
+    iterator(arguments* args, std::size_t index) noexcept
+      : m_args(args), m_index(index) {}
+
+    [[nodiscard]] reference operator*() const noexcept {
+      return reference{m_args, m_index};
+    }
+
+    iterator& operator++() noexcept {
+      ++m_index;
+      return *this;
+    }
+
+    iterator operator++(int) noexcept {
+      auto previous = *this;
+      ++m_index;
+      return previous;
+    }
+
+    [[nodiscard]] bool operator==(const iterator& other) const noexcept {
+      return m_index == other.m_index;
+    }
+
+    [[nodiscard]] bool operator!=(const iterator& other) const noexcept {
+      return m_index != other.m_index;
+    }
+
+  private:
+    arguments* m_args;
+    std::size_t m_index;
+  };
 
   /**
    * Returns an iterator to the beginning of the arguments list.
+   * Iterating does not change the storage; see arguments::reference.
+   */
+  [[nodiscard]] inline iterator begin() noexcept {
+    return iterator{this, 0};
+  }
+
+  /**
+   * Returns a const iterator to the beginning of the arguments list.
    */
-  [[nodiscard]] inline auto begin() noexcept {
-    return m_arguments_list.begin();
+  [[nodiscard]] inline const_iterator begin() const noexcept {
+    return const_iterator{this, 0};
   }
 
   /**
    * Returns a const iterator to the beginning of the arguments list.
    */
-  [[nodiscard]] inline auto begin() const noexcept {
-    return m_arguments_list.cbegin();
+  [[nodiscard]] inline const_iterator cbegin() const noexcept {
+    return const_iterator{this, 0};
   }
 
   /**
    * Returns an iterator to the end of the arguments list.
    */
-  [[nodiscard]] inline auto end() noexcept {
-    return m_arguments_list.end();
+  [[nodiscard]] inline iterator end() noexcept {
+    return iterator{this, size()};
   }
 
   /**
    * Returns a const iterator to the end of the arguments list.
    */
-  [[nodiscard]] inline auto end() const noexcept {
-    return m_arguments_list.cend();
+  [[nodiscard]] inline const_iterator end() const noexcept {
+    return const_iterator{this, size()};
+  }
+
+  /**
+   * Returns a const iterator to the end of the arguments list.
+   */
+  [[nodiscard]] inline const_iterator cend() const noexcept {
+    return const_iterator{this, size()};
   }
 
   /**
@@ -71,6 +226,26 @@ public:
    */
   void push_back(const value& val) noexcept;
 
+  /**
+   * Appends a new argument at the end of the argument list,
+   * moving its content.
+   * @param val The value to append.
+   */
+  void push_back(value&& val) noexcept;
+
+  /**
+   * Reserves room for a number of arguments, so that appending them
+   * does not reallocate. The room is kept when the first argument
+   * decides the storage.
+   * @param count The number of arguments to make room for.
+   */
+  void reserve(std::size_t count);
+
+  /**
+   * Releases the room reserved beyond the current arguments.
+   */
+  void shrink_to_fit();
+
   /**
    * Removes the argument at the specified index.
    * @param index The index of the argument to remove.
@@ -78,9 +253,52 @@ public:
    */
   bool erase(const std::size_t index) noexcept;
 
+  /**
+   * Gets the way arguments are currently stored.
+   * @return The storage kind.
+   */
+  [[nodiscard]] storage get_storage() const noexcept;
+
+  /**
+   * Gets the packed integral arguments, to process them in bulk.
+   * @return The packed array, or nullptr if the storage is not integral.
+   */
+  [[nodiscard]] const std::vector<value::integral>* packed_integrals() const noexcept;
+
+  /**
+   * Gets the packed integral arguments for in-place modification.
+   * @return The packed array, or nullptr if the storage is not integral.
+   */
+  [[nodiscard]] std::vector<value::integral>* packed_integrals() noexcept;
+
+  /**
+   * Gets the packed decimal arguments, to process them in bulk.
+   * @return The packed array, or nullptr if the storage is not decimal.
+   */
+  [[nodiscard]] const std::vector<value::decimal>* packed_decimals() const noexcept;
+
+  /**
+   * Gets the packed decimal arguments for in-place modification.
+   * @return The packed array, or nullptr if the storage is not decimal.
+   */
+  [[nodiscard]] std::vector<value::decimal>* packed_decimals() noexcept;
+
 private:
-  /// The growable, ordered list of arguments.
-  std::vector<value> m_arguments_list;
+  using generic_list = std::vector<value>;
+  using integral_list = std::vector<value::integral>;
+  using decimal_list = std::vector<value::decimal>;
+
+  /// Gets the argument at an index known to be in range.
+  [[nodiscard]] value get(std::size_t index) const noexcept;
+
+  /// Gets the type of the argument at an index known to be in range.
+  [[nodiscard]] value::type get_type(std::size_t index) const noexcept;
+
+  /// Switches to generic storage if needed and returns the generic list.
+  generic_list& generic();
+
+  /// The growable, ordered list of arguments, packed when homogeneous.
+  std::variant<generic_list, integral_list, decimal_list> m_arguments_list;
 };
 
 } // namespace kdlcpp
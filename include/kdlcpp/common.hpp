@@ -1,9 +1,38 @@
 #pragma once
 
+#include <stdexcept>
 #include <string>
 
 namespace kdlcpp {
 
 using string_type = std::string;
 
-} // namespace kdlcpp
\ No newline at end of file
+/**
+ * @brief Thrown when a KDL document cannot be parsed.
+ *
+ * Carries the byte offset of the offending input together with
+ * its 1-based line and column.
+ */
+class parse_error : public std::runtime_error {
+public:
+  parse_error(const string_type& message, std::size_t offset,
+              std::size_t line, std::size_t column)
+    : std::runtime_error(std::to_string(line) + ":" + std::to_string(column) + ": " + message),
+      m_offset(offset), m_line(line), m_column(column) {}
+
+  /// Byte offset of the error in the input.
+  [[nodiscard]] std::size_t offset() const noexcept { return m_offset; }
+
+  /// 1-based line of the error.
+  [[nodiscard]] std::size_t line() const noexcept { return m_line; }
+
+  /// 1-based column (in bytes) of the error.
+  [[nodiscard]] std::size_t column() const noexcept { return m_column; }
+
+private:
+  std::size_t m_offset;
+  std::size_t m_line;
+  std::size_t m_column;
+};
+
+} // namespace kdlcpp
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "kdlcpp/document.hpp"
+
+namespace kdlcpp {
+
+/**
+ * The outcome of a deduplication pass.
+ */
+struct dedup_summary {
+  std::size_t shared_subtrees{0};  // Distinct subtrees now stored once.
+  std::size_t references{0};       // Duplicates replaced by a reference.
+  std::size_t bytes_saved{0};      // Estimated heap bytes released.
+};
+
+/**
+ * Stores identical subtrees once. Every subtree that appears more than once
+ * below the given node, compared by name, arguments, properties and
+ * children, is moved into an immutable shared node, and each occurrence
+ * becomes a reference to it (see node::share()). A reference is copied
+ * back the first time it is modified, so sharing is invisible to readers.
+ *
+ * Strings are shared as part of the subtrees holding them; subtrees owning
+ * less memory than a shared node costs are left alone. Deferred children are
+ * parsed, and subtrees already shared are reused by later passes.
+ *
+ * @param root The node whose descendants are deduplicated.
+ * @return What was shared and an estimate of the memory released.
+ */
+dedup_summary deduplicate(node& root);
+
+/**
+ * Stores identical subtrees of a document once.
+ * @see deduplicate(node&)
+ * @param doc The document to deduplicate.
+ * @return What was shared and an estimate of the memory released.
+ */
+dedup_summary deduplicate(document& doc);
+
+} // namespace kdlcpp
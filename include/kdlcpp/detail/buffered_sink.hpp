@@ -0,0 +1,73 @@
+#pragma once
+
+#include "kdlcpp/common.hpp"
+#include "kdlcpp/stream.hpp"
+
+#include <string_view>
+
+namespace kdlcpp::detail {
+
+/**
+ * @brief A stream type that gathers small writes in a fixed-size buffer
+ *        and forwards them to a target stream in large chunks.
+ *
+ * It is meant to be wrapped in a kdlcpp::stream, so that the serializer
+ * functions can write to it.
+ *
+ * @tparam target_type The type of the stream wrapped by the target.
+ */
+template <typename target_type>
+class buffered_sink {
+public:
+  /**
+   * @param target The stream receiving the buffered bytes.
+   * @param capacity The number of bytes gathered before forwarding them.
+   */
+  buffered_sink(stream<target_type>& target, std::size_t capacity) : m_target(&target) {
+    m_buffer.reserve(capacity);
+  }
+
+  buffered_sink& operator<<(char c) {
+    if (m_buffer.size() == m_buffer.capacity()) {
+      flush();
+    }
+    m_buffer.push_back(c);
+    return *this;
+  }
+
+  buffered_sink& operator<<(std::string_view text) {
+    if (m_buffer.size() + text.size() > m_buffer.capacity()) {
+      flush();
+      if (text.size() >= m_buffer.capacity()) {
+        *m_target << text;
+        return *this;
+      }
+    }
+    m_buffer.append(text);
+    return *this;
+  }
+
+  buffered_sink& operator<<(const char* text) {
+    return *this << std::string_view{text};
+  }
+
+  buffered_sink& operator<<(const string_type& text) {
+    return *this << std::string_view{text};
+  }
+
+  /**
+   * @brief Forwards the buffered bytes to the target stream.
+   */
+  void flush() {
+    if (!m_buffer.empty()) {
+      *m_target << std::string_view{m_buffer};
+      m_buffer.clear();
+    }
+  }
+
+private:
+  stream<target_type>* m_target;
+  string_type m_buffer;
+};
+
+} // namespace kdlcpp::detail
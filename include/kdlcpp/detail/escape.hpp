@@ -0,0 +1,53 @@
+#pragma once
+
+#include "kdlcpp/common.hpp"
+
+#include <string_view>
+
+namespace kdlcpp::detail::escape {
+
+/**
+ * @brief How a string has to be written in a KDL document.
+ */
+enum class string_class {
+  identifier,  // Can be written bare, without quotes.
+  plain,       // Must be quoted, but needs no escaping.
+  escaped      // Must be quoted and contains bytes that need escaping.
+};
+
+/**
+ * @brief Classifies a string in a single pass.
+ *
+ * The scans run on the widest vector instructions the CPU has. Strings
+ * containing non-ASCII bytes are never reported as identifiers, and are
+ * reported as escaped so that newline and disallowed code points
+ * can be checked.
+ *
+ * @param text The string to classify.
+ * @return The string class.
+ */
+[[nodiscard]] string_class classify(std::string_view text) noexcept;
+
+/**
+ * @brief Finds the first byte that may need escaping in a quoted string:
+ *        a control character, `"`, `\`, DEL or any non-ASCII byte.
+ *
+ * @param text The string to scan.
+ * @return The offset of the byte, or text.size() if there is none.
+ */
+[[nodiscard]] std::size_t find_escape(std::string_view text) noexcept;
+
+/**
+ * @brief Escapes the code point starting at the beginning of a string.
+ *
+ * Newline and disallowed code points are written as `\u{...}`,
+ * invalid UTF-8 bytes as `\u{fffd}`.
+ *
+ * @param text The string; its first byte was reported by find_escape().
+ * @param out Replaced with the escape sequence, or with the code point
+ *        itself when it can be written as is.
+ * @return The number of input bytes consumed.
+ */
+std::size_t escape_code_point(std::string_view text, string_type& out);
+
+} // namespace kdlcpp::detail::escape
@@ -0,0 +1,385 @@
+#pragma once
+
+#include "kdlcpp/common.hpp"
+#include "kdlcpp/stream.hpp"
+#include "kdlcpp/value.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+#include <charconv>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace kdlcpp::detail::json {
+
+/**
+ * @brief Serializes a string as a quoted JSON string.
+ *
+ * Quotes, backslashes and control characters are escaped; any other
+ * byte, UTF-8 sequences included, is copied as is.
+ *
+ * @tparam stream_type The underlying stream type.
+ * @param out_stream The destination stream.
+ * @param text The string to serialize.
+ */
+template <typename stream_type>
+void serialize_string(stream<stream_type>& out_stream, std::string_view text) {
+  static constexpr char hex_digits[] = "0123456789abcdef";
+
+  out_stream << '"';
+  std::size_t start = 0;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const auto c = static_cast<unsigned char>(text[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    out_stream << text.substr(start, i - start);
+    switch (c) {
+      case '"':  out_stream << "\\\""; break;
+      case '\\': out_stream << "\\\\"; break;
+      case '\n': out_stream << "\\n"; break;
+      case '\r': out_stream << "\\r"; break;
+      case '\t': out_stream << "\\t"; break;
+      case '\b': out_stream << "\\b"; break;
+      case '\f': out_stream << "\\f"; break;
+      default: {
+        const char escape[] = {'\\', 'u', '0', '0', hex_digits[c >> 4], hex_digits[c & 0xF]};
+        out_stream << std::string_view{escape, sizeof(escape)};
+        break;
+      }
+    }
+    start = i + 1;
+  }
+  out_stream << text.substr(start);
+  out_stream << '"';
+}
+
+/**
+ * @brief A streaming JSON reader that reports what it reads as events,
+ *        without building any tree.
+ *
+ * Nesting is tracked with one byte per open container, so memory does
+ * not depend on the size of the input. The handler must provide:
+ * ```
+ * void begin_object();
+ * void key(string_type key);
+ * void end_object();
+ * void begin_array();
+ * void end_array();
+ * void scalar(value val);
+ * ```
+ * Numbers without fraction or exponent that fit value::integral are
+ * reported as integrals, any other number as a decimal.
+ * Errors are reported by throwing kdlcpp::parse_error.
+ *
+ * @tparam handler_type The event handler type.
+ */
+template <typename handler_type>
+class reader {
+public:
+  /**
+   * @param input The whole JSON text.
+   * @param handler The handler receiving the events.
+   */
+  reader(std::string_view input, handler_type& handler) noexcept
+    : m_input(input), m_handler(handler) {
+    if (m_input.substr(0, 3) == "\xEF\xBB\xBF") {
+      m_pos = 3;
+    }
+  }
+
+  /**
+   * @brief Reads the single JSON value making up the input.
+   */
+  void parse() {
+    for (;;) {
+      if (parse_value() && !parse_after_value()) {
+        return;
+      }
+    }
+  }
+
+private:
+  [[noreturn]] void fail(const string_type& message) const {
+    std::size_t line = 1;
+    std::size_t line_start = 0;
+    for (std::size_t i = 0; i < m_pos && i < m_input.size(); ++i) {
+      if (m_input[i] == '\n') {
+        ++line;
+        line_start = i + 1;
+      }
+    }
+    throw parse_error{message, m_pos, line, m_pos - line_start + 1};
+  }
+
+  [[nodiscard]] char peek() const noexcept {
+    return m_pos < m_input.size() ? m_input[m_pos] : '\0';
+  }
+
+  void skip_whitespace() noexcept {
+    while (m_pos < m_input.size()) {
+      const char c = m_input[m_pos];
+      if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+        return;
+      }
+      ++m_pos;
+    }
+  }
+
+  void expect(char c, const char* message) {
+    skip_whitespace();
+    if (peek() != c) {
+      fail(message);
+    }
+    ++m_pos;
+  }
+
+  /// Reads a value, or only the opening of a container.
+  /// @return true if a whole value was read.
+  bool parse_value() {
+    skip_whitespace();
+    switch (peek()) {
+      case '{':
+        ++m_pos;
+        m_handler.begin_object();
+        skip_whitespace();
+        if (peek() == '}') {
+          ++m_pos;
+          m_handler.end_object();
+          return true;
+        }
+        m_open.push_back('{');
+        parse_key();
+        return false;
+      case '[':
+        ++m_pos;
+        m_handler.begin_array();
+        skip_whitespace();
+        if (peek() == ']') {
+          ++m_pos;
+          m_handler.end_array();
+          return true;
+        }
+        m_open.push_back('[');
+        return false;
+      case '"':
+        m_handler.scalar(value{parse_string()});
+        return true;
+      case 't':
+        parse_keyword("true");
+        m_handler.scalar(value{true});
+        return true;
+      case 'f':
+        parse_keyword("false");
+        m_handler.scalar(value{false});
+        return true;
+      case 'n':
+        parse_keyword("null");
+        m_handler.scalar(value{});
+        return true;
+      default:
+        m_handler.scalar(parse_number());
+        return true;
+    }
+  }
+
+  /// Closes the containers ended after a value.
+  /// @return true if another value follows, false at the end of the input.
+  bool parse_after_value() {
+    for (;;) {
+      skip_whitespace();
+      if (m_open.empty()) {
+        if (m_pos < m_input.size()) {
+          fail("unexpected content after the JSON value");
+        }
+        return false;
+      }
+      const char c = peek();
+      if (c == ',') {
+        ++m_pos;
+        if (m_open.back() == '{') {
+          parse_key();
+        }
+        return true;
+      }
+      if (c == '}' && m_open.back() == '{') {
+        ++m_pos;
+        m_open.pop_back();
+        m_handler.end_object();
+      } else if (c == ']' && m_open.back() == '[') {
+        ++m_pos;
+        m_open.pop_back();
+        m_handler.end_array();
+      } else {
+        fail(m_open.back() == '{' ? "expected ',' or '}'" : "expected ',' or ']'");
+      }
+    }
+  }
+
+  void parse_key() {
+    skip_whitespace();
+    if (peek() != '"') {
+      fail("expected a string key");
+    }
+    auto key = parse_string();
+    expect(':', "expected ':'");
+    m_handler.key(std::move(key));
+  }
+
+  void parse_keyword(std::string_view keyword) {
+    if (m_input.substr(m_pos, keyword.size()) != keyword) {
+      fail("unexpected character");
+    }
+    m_pos += keyword.size();
+  }
+
+  string_type parse_string() {
+    const std::size_t start = m_pos++;
+    string_type out;
+    for (;;) {
+      const std::size_t run = m_pos;
+      while (m_pos < m_input.size()) {
+        const auto c = static_cast<unsigned char>(m_input[m_pos]);
+        if (c == '"' || c == '\\' || c < 0x20) {
+          break;
+        }
+        if (c < 0x80) {
+          ++m_pos;
+          continue;
+        }
+        std::size_t length = 0;
+        parse::decode_utf8(m_input, m_pos, length);
+        if (length == 0) {
+          fail("invalid UTF-8");
+        }
+        m_pos += length;
+      }
+      out.append(m_input.substr(run, m_pos - run));
+
+      if (m_pos >= m_input.size()) {
+        m_pos = start;
+        fail("unterminated string");
+      }
+      const char c = m_input[m_pos++];
+      if (c == '"') {
+        return out;
+      }
+      if (c != '\\') {
+        --m_pos;
+        fail("control character in string");
+      }
+      parse_escape(out);
+    }
+  }
+
+  void parse_escape(string_type& out) {
+    switch (peek()) {
+      case '"':  out.push_back('"'); break;
+      case '\\': out.push_back('\\'); break;
+      case '/':  out.push_back('/'); break;
+      case 'b':  out.push_back('\b'); break;
+      case 'f':  out.push_back('\f'); break;
+      case 'n':  out.push_back('\n'); break;
+      case 'r':  out.push_back('\r'); break;
+      case 't':  out.push_back('\t'); break;
+      case 'u': {
+        ++m_pos;
+        char32_t cp = parse_hex4();
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+          if (m_input.substr(m_pos, 2) != "\\u") {
+            fail("unpaired surrogate in escape");
+          }
+          m_pos += 2;
+          const char32_t low = parse_hex4();
+          if (low < 0xDC00 || low > 0xDFFF) {
+            fail("unpaired surrogate in escape");
+          }
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+          fail("unpaired surrogate in escape");
+        }
+        parse::append_utf8(out, cp);
+        return;
+      }
+      default:
+        fail("invalid escape");
+    }
+    ++m_pos;
+  }
+
+  char32_t parse_hex4() {
+    if (m_pos + 4 > m_input.size()) {
+      fail("expected four hexadecimal digits");
+    }
+    std::uint32_t cp = 0;
+    const auto result = std::from_chars(m_input.data() + m_pos, m_input.data() + m_pos + 4, cp, 16);
+    if (result.ec != std::errc{} || result.ptr != m_input.data() + m_pos + 4) {
+      fail("expected four hexadecimal digits");
+    }
+    m_pos += 4;
+    return static_cast<char32_t>(cp);
+  }
+
+  value parse_number() {
+    const std::size_t start = m_pos;
+    const auto digits = [&] {
+      const std::size_t first = m_pos;
+      while (m_pos < m_input.size() && m_input[m_pos] >= '0' && m_input[m_pos] <= '9') {
+        ++m_pos;
+      }
+      return m_pos - first;
+    };
+
+    if (peek() == '-') {
+      ++m_pos;
+    }
+    const std::size_t integer_start = m_pos;
+    const std::size_t integer_digits = digits();
+    if (integer_digits == 0 || (integer_digits > 1 && m_input[integer_start] == '0')) {
+      m_pos = start;
+      fail(integer_digits == 0 ? "unexpected character" : "invalid number");
+    }
+    bool is_decimal = false;
+    if (peek() == '.') {
+      ++m_pos;
+      is_decimal = true;
+      if (digits() == 0) {
+        fail("expected digits after '.'");
+      }
+    }
+    if (peek() == 'e' || peek() == 'E') {
+      ++m_pos;
+      is_decimal = true;
+      if (peek() == '+' || peek() == '-') {
+        ++m_pos;
+      }
+      if (digits() == 0) {
+        fail("expected exponent digits");
+      }
+    }
+
+    const char* first = m_input.data() + start;
+    const char* last = m_input.data() + m_pos;
+    if (!is_decimal) {
+      value::integral number = 0;
+      const auto result = std::from_chars(first, last, number);
+      if (result.ec == std::errc{}) {
+        return value{number};
+      }
+    }
+    value::decimal number = 0;
+    const auto result = std::from_chars(first, last, number);
+    if (result.ec != std::errc{}) {
+      m_pos = start;
+      fail("number out of range");
+    }
+    return value{number};
+  }
+
+  std::string_view m_input;
+  handler_type& m_handler;
+  std::size_t m_pos{0};
+  std::vector<char> m_open;
+};
+
+} // namespace kdlcpp::detail::json
@@ -0,0 +1,1226 @@
+#pragma once
+
+#include "kdlcpp/common.hpp"
+#include "kdlcpp/value.hpp"
+#include "kdlcpp/node.hpp"
+#include "kdlcpp/document.hpp"
+#include "kdlcpp/detail/scan.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace kdlcpp::detail::parse {
+
+/**
+ * @brief Decodes the UTF-8 code point starting at a given offset.
+ *
+ * @param input The input text.
+ * @param pos The offset of the first byte of the code point.
+ * @param length Receives the number of bytes of the code point,
+ *        or 0 if the sequence is not valid UTF-8.
+ * @return The decoded code point.
+ */
+constexpr char32_t decode_utf8(std::string_view input, std::size_t pos, std::size_t& length) noexcept {
+  const auto byte = [&](std::size_t i) {
+    return static_cast<unsigned char>(input[pos + i]);
+  };
+  const auto continuation = [&](std::size_t i) {
+    return pos + i < input.size() && (byte(i) & 0xC0) == 0x80;
+  };
+
+  const unsigned char lead = byte(0);
+  if (lead < 0x80) {
+    length = 1;
+    return lead;
+  }
+  if (lead >= 0xC2 && lead <= 0xDF && continuation(1)) {
+    length = 2;
+    return (char32_t(lead & 0x1F) << 6) | (byte(1) & 0x3F);
+  }
+  if (lead >= 0xE0 && lead <= 0xEF && continuation(1) && continuation(2)) {
+    const char32_t cp = (char32_t(lead & 0x0F) << 12) | (char32_t(byte(1) & 0x3F) << 6) | (byte(2) & 0x3F);
+    if (cp >= 0x800 && (cp < 0xD800 || cp > 0xDFFF)) {
+      length = 3;
+      return cp;
+    }
+  }
+  if (lead >= 0xF0 && lead <= 0xF4 && continuation(1) && continuation(2) && continuation(3)) {
+    const char32_t cp = (char32_t(lead & 0x07) << 18) | (char32_t(byte(1) & 0x3F) << 12) |
+                        (char32_t(byte(2) & 0x3F) << 6) | (byte(3) & 0x3F);
+    if (cp >= 0x10000 && cp <= 0x10FFFF) {
+      length = 4;
+      return cp;
+    }
+  }
+  length = 0;
+  return 0;
+}
+
+/**
+ * @brief Appends a code point to a string as UTF-8.
+ */
+inline void append_utf8(string_type& out, char32_t cp) {
+  if (cp < 0x80) {
+    out.push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+/// Unicode white space, as defined by the KDL specification.
+constexpr bool is_whitespace(char32_t cp) noexcept {
+  return cp == 0x09 || cp == 0x20 || cp == 0xA0 || cp == 0x1680 ||
+         (cp >= 0x2000 && cp <= 0x200A) || cp == 0x202F || cp == 0x205F || cp == 0x3000;
+}
+
+/// Newline code points, as defined by the KDL specification (CRLF aside).
+constexpr bool is_newline(char32_t cp) noexcept {
+  return cp == 0x0A || cp == 0x0D || cp == 0x0B || cp == 0x0C ||
+         cp == 0x85 || cp == 0x2028 || cp == 0x2029;
+}
+
+/// Code points that may never appear in a KDL document.
+constexpr bool is_disallowed(char32_t cp) noexcept {
+  return (cp <= 0x08) || (cp >= 0x0E && cp <= 0x1F) || cp == 0x7F ||
+         (cp >= 0xD800 && cp <= 0xDFFF) || cp == 0x200E || cp == 0x200F ||
+         (cp >= 0x202A && cp <= 0x202E) || (cp >= 0x2066 && cp <= 0x2069) || cp == 0xFEFF;
+}
+
+/// Code points that may appear in an identifier string.
+constexpr bool is_identifier_char(char32_t cp) noexcept {
+  switch (cp) {
+    case '\\': case '/': case '(': case ')': case '{': case '}':
+    case ';': case '[': case ']': case '"': case '#': case '=':
+      return false;
+    default:
+      return !is_whitespace(cp) && !is_newline(cp) && !is_disallowed(cp);
+  }
+}
+
+/// Bytes that may start something that hides or moves a brace.
+constexpr scan::byte_set block_special_bytes = scan::make_byte_set([](unsigned char c) {
+  return c == '{' || c == '}' || c == '"' || c == '#' || c == '/';
+});
+
+/**
+ * @brief Event handler that builds kdlcpp::node trees from parser events.
+ *
+ * Every top-level node is appended to the children of the given root.
+ */
+class dom_handler {
+public:
+  explicit dom_handler(node& root) noexcept : m_root(root) {}
+
+  void begin_node(string_type name, string_type /*type*/) {
+    m_stack.emplace_back(name);
+  }
+
+  void argument(value val, string_type /*type*/) {
+    m_stack.back().get_arguments().push_back(val);
+  }
+
+  void property(string_type key, value val, string_type /*type*/) {
+    m_stack.back().get_properties().insert(key, val);
+  }
+
+  void begin_children() {}
+
+  void end_children() {}
+
+  void end_node() {
+    node finished = std::move(m_stack.back());
+    m_stack.pop_back();
+    auto& parent = m_stack.empty() ? m_root : m_stack.back();
+    parent.append_child(std::move(finished));
+  }
+
+protected:
+  /// The node whose content is being reported.
+  node& current() noexcept {
+    return m_stack.back();
+  }
+
+private:
+  node& m_root;
+  std::vector<node> m_stack;
+};
+
+/**
+ * @brief Event handler that builds kdlcpp::node trees whose children blocks
+ *        are parsed on first access.
+ *
+ * The parser skips children blocks for this handler and only reports where
+ * they start; each node keeps a reference to the shared source text.
+ */
+class lazy_dom_handler : public dom_handler {
+public:
+  lazy_dom_handler(node& root, std::shared_ptr<const string_type> source) noexcept
+    : dom_handler(root), m_source(std::move(source)) {}
+
+  void deferred_children(std::size_t offset) {
+    current().defer_children(m_source, offset);
+  }
+
+  /// The text the deferred offsets refer to.
+  [[nodiscard]] std::string_view source() const noexcept {
+    return *m_source;
+  }
+
+private:
+  std::shared_ptr<const string_type> m_source;
+};
+
+/// Whether a handler wants children blocks skipped and reported
+/// through `deferred_children(offset)` instead of parsed.
+template <typename handler_type, typename = void>
+struct defers_children : std::false_type {};
+
+template <typename handler_type>
+struct defers_children<handler_type, std::void_t<decltype(
+  std::declval<handler_type&>().deferred_children(std::size_t{}))>> : std::true_type {};
+
+/**
+ * @brief An event-driven KDL parser.
+ *
+ * The parser walks the input once and reports what it finds to a handler,
+ * which must provide:
+ * ```
+ * void begin_node(string_type name, string_type type);
+ * void argument(value val, string_type type);
+ * void property(string_type key, value val, string_type type);
+ * void begin_children();
+ * void end_children();
+ * void end_node();
+ * ```
+ * `type` carries the type annotation, or is empty when there is none.
+ * Content disabled with a slashdash (`/-`) produces no events.
+ * A handler that also provides `void deferred_children(std::size_t offset)`
+ * gets children blocks skipped: instead of the events for their content,
+ * it receives the offset right after their `{`.
+ * Errors are reported by throwing kdlcpp::parse_error.
+ *
+ * @tparam handler_type The event handler type.
+ */
+template <typename handler_type>
+class parser {
+public:
+  /**
+   * @param input The whole KDL text.
+   * @param handler The handler receiving the events.
+   * @param offset Where parsing starts. It must be the beginning of the input
+   *        or a position right after a top-level node.
+   */
+  parser(std::string_view input, handler_type& handler, std::size_t offset = 0) noexcept
+    : m_input(input), m_handler(handler), m_pos(offset) {
+    if (m_pos == 0 && m_input.substr(0, 3) == "\xEF\xBB\xBF") {
+      m_pos = 3;
+    }
+  }
+
+  /**
+   * @brief Parses every remaining node until the end of the input.
+   */
+  void parse_document() {
+    while (parse_top_level_node()) {
+    }
+  }
+
+  /**
+   * @brief Parses the next top-level node, including the trivia in front of it
+   *        and its terminator.
+   *
+   * @return true if a node was reported, false if only trivia (white space,
+   *         comments and slashdashed nodes) was left before the end of the input.
+   */
+  bool parse_top_level_node() {
+    for (;;) {
+      skip_line_space();
+      if (at_end()) {
+        return false;
+      }
+      if (peek() == '}') {
+        fail("unexpected '}'");
+      }
+      if (parse_node()) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * @brief Parses the nodes of a children block up to and including
+   *        its closing brace. The parser must start right after the `{`.
+   */
+  void parse_children_block() {
+    parse_children_nodes();
+  }
+
+  /**
+   * @brief Gets the offset of the first byte not consumed yet.
+   */
+  [[nodiscard]] std::size_t position() const noexcept {
+    return m_pos;
+  }
+
+  /**
+   * @brief Gets the number of comments and slashdashes skipped so far,
+   *        which produce no events and are lost by a round trip.
+   */
+  [[nodiscard]] std::size_t comments() const noexcept {
+    return m_comments;
+  }
+
+  /**
+   * @brief Gets the number of type annotations parsed so far, which
+   *        kdlcpp::node does not keep and a round trip loses.
+   */
+  [[nodiscard]] std::size_t annotations() const noexcept {
+    return m_annotations;
+  }
+
+private:
+  [[noreturn]] void fail(const string_type& message) const {
+    fail_at(message, m_pos);
+  }
+
+  [[noreturn]] void fail_at(const string_type& message, std::size_t offset) const {
+    std::size_t line = 1;
+    std::size_t line_start = 0;
+    for (std::size_t i = 0; i < offset && i < m_input.size(); ++i) {
+      if (m_input[i] == '\n') {
+        ++line;
+        line_start = i + 1;
+      }
+    }
+    throw parse_error{message, offset, line, offset - line_start + 1};
+  }
+
+  [[nodiscard]] bool at_end() const noexcept {
+    return m_pos >= m_input.size();
+  }
+
+  [[nodiscard]] char peek(std::size_t ahead = 0) const noexcept {
+    return m_pos + ahead < m_input.size() ? m_input[m_pos + ahead] : '\0';
+  }
+
+  [[nodiscard]] bool starts_with(std::string_view prefix) const noexcept {
+    return m_input.substr(m_pos, prefix.size()) == prefix;
+  }
+
+  /**
+   * Length of the run of bytes from the current position, up to limit,
+   * that are not in a set, skipped without decoding them. The input is
+   * validated as UTF-8 ahead of the scans, a window at a time, and runs
+   * stop where the validated bytes end: from there, the code points are
+   * decoded one by one and invalid UTF-8 is reported where it is reached.
+   */
+  std::size_t plain_run(const scan::byte_set& stops, std::size_t limit) {
+    if (m_pos > m_valid_end || (m_pos == m_valid_end && !m_invalid)) {
+      const std::size_t end = std::min(m_input.size(), m_pos + validation_window);
+      m_valid_end = m_pos + scan::validate_utf8(m_input.substr(m_pos, end - m_pos));
+      // A sequence cut by the end of the window is validated with the next one.
+      m_invalid = m_valid_end < end && (end == m_input.size() || end - m_valid_end > 3);
+    }
+    const std::size_t end = std::min(m_valid_end, limit);
+    return m_pos < end ? scan::find_first_of(m_input.substr(m_pos, end - m_pos), stops) : 0;
+  }
+
+  /// Decodes the code point at a given position, failing on invalid UTF-8.
+  char32_t code_point_at(std::size_t pos, std::size_t& length) const {
+    const char32_t cp = decode_utf8(m_input, pos, length);
+    if (length == 0) {
+      fail_at("invalid UTF-8", pos);
+    }
+    return cp;
+  }
+
+  /// Length of the newline at a given position, or 0.
+  std::size_t newline_length(std::size_t pos) const {
+    if (pos >= m_input.size()) {
+      return 0;
+    }
+    const char c = m_input[pos];
+    if (c == '\r') {
+      return pos + 1 < m_input.size() && m_input[pos + 1] == '\n' ? 2 : 1;
+    }
+    if (c == '\n' || c == '\x0B' || c == '\x0C') {
+      return 1;
+    }
+    if (static_cast<unsigned char>(c) < 0x80) {
+      return 0;
+    }
+    std::size_t length = 0;
+    return is_newline(code_point_at(pos, length)) ? length : 0;
+  }
+
+  /// Length of the white space at a given position, or 0.
+  std::size_t whitespace_length(std::size_t pos) const {
+    if (pos >= m_input.size()) {
+      return 0;
+    }
+    const char c = m_input[pos];
+    if (c == ' ' || c == '\t') {
+      return 1;
+    }
+    if (static_cast<unsigned char>(c) < 0x80) {
+      return 0;
+    }
+    std::size_t length = 0;
+    return is_whitespace(code_point_at(pos, length)) ? length : 0;
+  }
+
+  /// Skips a `//` comment up to and including its newline.
+  void skip_single_line_comment() {
+    ++m_comments;
+    m_pos += 2;
+    while (!at_end()) {
+      if (const auto run = plain_run(scan::text_stops, m_input.size())) {
+        m_pos += run;
+        continue;
+      }
+      if (const auto length = newline_length(m_pos)) {
+        m_pos += length;
+        return;
+      }
+      std::size_t length = 0;
+      if (is_disallowed(code_point_at(m_pos, length))) {
+        fail("disallowed code point in comment");
+      }
+      m_pos += length;
+    }
+  }
+
+  /// Skips a (possibly nested) `/* */` comment.
+  void skip_multi_line_comment() {
+    ++m_comments;
+    const std::size_t start = m_pos;
+    std::size_t depth = 0;
+    while (!at_end()) {
+      if (starts_with("/*")) {
+        ++depth;
+        m_pos += 2;
+      } else if (starts_with("*/")) {
+        m_pos += 2;
+        if (--depth == 0) {
+          return;
+        }
+      } else {
+        ++m_pos;
+      }
+    }
+    fail_at("unterminated block comment", start);
+  }
+
+  /// Skips white space, newlines and comments between nodes.
+  void skip_line_space() {
+    for (;;) {
+      if (const auto length = whitespace_length(m_pos)) {
+        m_pos += length;
+      } else if (const auto length = newline_length(m_pos)) {
+        m_pos += length;
+      } else if (starts_with("//")) {
+        skip_single_line_comment();
+      } else if (starts_with("/*")) {
+        skip_multi_line_comment();
+      } else {
+        return;
+      }
+    }
+  }
+
+  /**
+   * Skips white space, block comments and line continuations within a node.
+   * @return true if anything was skipped.
+   */
+  bool skip_node_space() {
+    const std::size_t start = m_pos;
+    for (;;) {
+      if (const auto length = whitespace_length(m_pos)) {
+        m_pos += length;
+      } else if (starts_with("/*")) {
+        skip_multi_line_comment();
+      } else if (peek() == '\\') {
+        ++m_pos;
+        while (const auto length = whitespace_length(m_pos)) {
+          m_pos += length;
+        }
+        if (starts_with("//")) {
+          skip_single_line_comment();
+        } else if (const auto length = newline_length(m_pos)) {
+          m_pos += length;
+        } else if (!at_end()) {
+          fail("expected newline after line continuation");
+        }
+      } else {
+        return m_pos != start;
+      }
+    }
+  }
+
+  /// Whether the node ends here: newline, `;`, `//`, `}` or end of input.
+  bool at_node_terminator() const {
+    return at_end() || peek() == ';' || peek() == '}' ||
+           starts_with("//") || newline_length(m_pos) != 0;
+  }
+
+  /**
+   * Parses a node and its terminator.
+   * @return false if the node was disabled by a slashdash.
+   */
+  bool parse_node() {
+    const bool disabled = starts_with("/-");
+    if (disabled) {
+      ++m_comments;
+      m_pos += 2;
+      skip_line_space();
+      ++m_suppressed;
+    }
+
+    string_type type = parse_type_annotation();
+    if (!type.empty()) {
+      skip_node_space();
+    }
+    if (!starts_string()) {
+      fail("expected a node name");
+    }
+    string_type name = parse_string();
+    if (!m_suppressed) {
+      m_handler.begin_node(std::move(name), std::move(type));
+    }
+
+    bool seen_children = false;
+    for (;;) {
+      const bool spaced = skip_node_space();
+      if (at_node_terminator()) {
+        break;
+      }
+
+      bool slashdash = false;
+      if (starts_with("/-")) {
+        if (!spaced) {
+          fail("expected white space before slashdash");
+        }
+        ++m_comments;
+        m_pos += 2;
+        skip_line_space();
+        slashdash = true;
+      }
+
+      if (peek() == '{') {
+        if (seen_children && !slashdash) {
+          fail("a node can only have one children block");
+        }
+        parse_children(slashdash);
+        seen_children = seen_children || !slashdash;
+        continue;
+      }
+      if (!spaced && !slashdash) {
+        fail("expected white space");
+      }
+      if (seen_children) {
+        fail("arguments and properties must come before children");
+      }
+      parse_property_or_argument(slashdash);
+    }
+
+    if (peek() == ';') {
+      ++m_pos;
+    } else if (starts_with("//")) {
+      skip_single_line_comment();
+    } else if (const auto length = newline_length(m_pos)) {
+      m_pos += length;
+    }
+
+    if (!m_suppressed) {
+      m_handler.end_node();
+    }
+    if (disabled) {
+      --m_suppressed;
+    }
+    return !disabled;
+  }
+
+  void parse_children(bool disabled) {
+    m_suppressed += disabled;
+    ++m_pos;
+    if constexpr (defers_children<handler_type>::value) {
+      const std::size_t offset = m_pos;
+      skip_children_block();
+      if (!m_suppressed) {
+        m_handler.deferred_children(offset);
+      }
+    } else {
+      if (!m_suppressed) {
+        m_handler.begin_children();
+      }
+      parse_children_nodes();
+      if (!m_suppressed) {
+        m_handler.end_children();
+      }
+    }
+    m_suppressed -= disabled;
+  }
+
+  /// Parses nodes up to and including the closing brace of a children block.
+  void parse_children_nodes() {
+    for (;;) {
+      skip_line_space();
+      if (at_end()) {
+        fail("expected '}'");
+      }
+      if (peek() == '}') {
+        ++m_pos;
+        return;
+      }
+      parse_node();
+    }
+  }
+
+  /**
+   * Skips the rest of a children block, up to and including its closing brace.
+   * Only strings and comments are looked into, as they are the only places
+   * where a brace does not count; the content is validated when it is parsed.
+   */
+  void skip_children_block() {
+    const std::size_t start = m_pos - 1;
+    std::size_t depth = 1;
+    while (!at_end()) {
+      m_pos += scan::find_first_of(m_input.substr(m_pos), block_special_bytes);
+      if (at_end()) {
+        break;
+      }
+      switch (peek()) {
+        case '{':
+          ++depth;
+          ++m_pos;
+          break;
+        case '}':
+          ++m_pos;
+          if (--depth == 0) {
+            return;
+          }
+          break;
+        case '"':
+          skip_string_contents(0);
+          break;
+        case '#': {
+          std::size_t hashes = 0;
+          while (peek(hashes) == '#') {
+            ++hashes;
+          }
+          m_pos += hashes;
+          if (peek() == '"') {
+            skip_string_contents(hashes);
+          }
+          break;
+        }
+        default:
+          if (starts_with("//")) {
+            skip_single_line_comment();
+          } else if (starts_with("/*")) {
+            skip_multi_line_comment();
+          } else {
+            ++m_pos;
+          }
+          break;
+      }
+    }
+    fail_at("expected '}'", start);
+  }
+
+  /// Skips a quoted string starting at its opening quote; `hashes` is the
+  /// number of `#` in front of a raw string, which has no escapes.
+  void skip_string_contents(std::size_t hashes) {
+    const std::size_t start = m_pos;
+    const std::size_t quotes = starts_with("\"\"\"") ? 3 : 1;
+    m_pos += quotes;
+    while (!at_end()) {
+      if (hashes == 0 && peek() == '\\') {
+        m_pos += 2;
+        continue;
+      }
+      std::size_t closing = 0;
+      while (closing < quotes && peek(closing) == '"') {
+        ++closing;
+      }
+      if (closing == quotes) {
+        std::size_t trailing = 0;
+        while (trailing < hashes && peek(quotes + trailing) == '#') {
+          ++trailing;
+        }
+        if (trailing == hashes) {
+          m_pos += quotes + hashes;
+          return;
+        }
+      }
+      ++m_pos;
+    }
+    fail_at("unterminated string", start);
+  }
+
+  void parse_property_or_argument(bool disabled) {
+    m_suppressed += disabled;
+    string_type type = parse_type_annotation();
+    if (!type.empty()) {
+      skip_node_space();
+      value val = parse_value();
+      if (!m_suppressed) {
+        m_handler.argument(std::move(val), std::move(type));
+      }
+    } else if (starts_string()) {
+      string_type text = parse_string();
+      if (peek() == '=') {
+        ++m_pos;
+        string_type value_type = parse_type_annotation();
+        if (!value_type.empty()) {
+          skip_node_space();
+        }
+        value val = parse_value();
+        if (!m_suppressed) {
+          m_handler.property(std::move(text), std::move(val), std::move(value_type));
+        }
+      } else if (!m_suppressed) {
+        m_handler.argument(value{text}, string_type{});
+      }
+    } else {
+      value val = parse_value();
+      if (!m_suppressed) {
+        m_handler.argument(std::move(val), string_type{});
+      }
+    }
+    m_suppressed -= disabled;
+  }
+
+  /// Parses `(type)` if present, returning the type or an empty string.
+  string_type parse_type_annotation() {
+    if (peek() != '(') {
+      return {};
+    }
+    ++m_pos;
+    skip_node_space();
+    if (!starts_string()) {
+      fail("expected a type name");
+    }
+    string_type type = parse_string();
+    skip_node_space();
+    if (peek() != ')') {
+      fail("expected ')'");
+    }
+    ++m_pos;
+    ++m_annotations;
+    return type;
+  }
+
+  /// Whether a number starts at the current position.
+  bool starts_number() const noexcept {
+    const char c = peek();
+    if (c >= '0' && c <= '9') {
+      return true;
+    }
+    if (c == '+' || c == '-') {
+      const char next = peek(1);
+      return (next >= '0' && next <= '9') || (next == '.' && peek(2) >= '0' && peek(2) <= '9');
+    }
+    if (c == '.') {
+      return peek(1) >= '0' && peek(1) <= '9';
+    }
+    return false;
+  }
+
+  /// Whether a string (identifier, quoted or raw) starts at the current position.
+  bool starts_string() const {
+    if (at_end() || starts_number()) {
+      return false;
+    }
+    if (peek() == '"') {
+      return true;
+    }
+    if (peek() == '#') {
+      std::size_t i = 0;
+      while (peek(i) == '#') {
+        ++i;
+      }
+      return peek(i) == '"';
+    }
+    std::size_t length = 0;
+    return is_identifier_char(code_point_at(m_pos, length));
+  }
+
+  value parse_value() {
+    if (at_end()) {
+      fail("expected a value");
+    }
+    if (starts_number()) {
+      return parse_number();
+    }
+    if (peek() == '#' && peek(1) != '#' && peek(1) != '"') {
+      return parse_keyword();
+    }
+    if (!starts_string()) {
+      fail("expected a value");
+    }
+    return value{parse_string()};
+  }
+
+  value parse_keyword() {
+    const std::size_t start = m_pos;
+    ++m_pos;
+    while (!at_end()) {
+      std::size_t length = 0;
+      if (!is_identifier_char(code_point_at(m_pos, length))) {
+        break;
+      }
+      m_pos += length;
+    }
+    const auto keyword = m_input.substr(start, m_pos - start);
+    if (keyword == "#true") {
+      return value{true};
+    }
+    if (keyword == "#false") {
+      return value{false};
+    }
+    if (keyword == "#null") {
+      return value{};
+    }
+    if (keyword == "#inf") {
+      return value{std::numeric_limits<value::decimal>::infinity()};
+    }
+    if (keyword == "#-inf") {
+      return value{-std::numeric_limits<value::decimal>::infinity()};
+    }
+    if (keyword == "#nan") {
+      return value{std::numeric_limits<value::decimal>::quiet_NaN()};
+    }
+    fail_at("unknown keyword '" + string_type{keyword} + "'", start);
+  }
+
+  /**
+   * Parses a number: decimal (with optional fraction and exponent),
+   * hexadecimal (`0x`), octal (`0o`) or binary (`0b`), all with an
+   * optional sign and `_` separators between digits.
+   */
+  value parse_number() {
+    const std::size_t start = m_pos;
+    const bool negative = peek() == '-';
+    if (peek() == '+' || peek() == '-') {
+      ++m_pos;
+    }
+
+    if (peek() == '0' && (peek(1) == 'x' || peek(1) == 'o' || peek(1) == 'b')) {
+      const int base = peek(1) == 'x' ? 16 : peek(1) == 'o' ? 8 : 2;
+      m_pos += 2;
+      const std::size_t digits_start = m_pos;
+      if (!scan_digits(base)) {
+        fail_at("expected digits after radix prefix", start);
+      }
+      check_number_end(start);
+      return value{to_integral(start, digits_start, base, negative)};
+    }
+
+    bool decimal = false;
+    if (!scan_digits(10)) {
+      fail_at("invalid number", start);
+    }
+    if (peek() == '.') {
+      ++m_pos;
+      decimal = true;
+      if (!scan_digits(10)) {
+        fail_at("expected digits after '.'", start);
+      }
+    }
+    if (peek() == 'e' || peek() == 'E') {
+      ++m_pos;
+      decimal = true;
+      if (peek() == '+' || peek() == '-') {
+        ++m_pos;
+      }
+      if (!scan_digits(10)) {
+        fail_at("expected exponent digits", start);
+      }
+    }
+    check_number_end(start);
+
+    if (!decimal) {
+      return value{to_integral(start, start + (peek_at(start) == '+' || negative), 10, negative)};
+    }
+
+    // from_chars does not accept a leading '+'.
+    const std::size_t first = start + (peek_at(start) == '+');
+    string_type stripped;
+    const auto text = without_underscores(first, stripped);
+    value::decimal result{};
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), result);
+    if (ec != std::errc{} || ptr != text.data() + text.size()) {
+      fail_at("decimal out of range", start);
+    }
+    return value{result};
+  }
+
+  [[nodiscard]] char peek_at(std::size_t pos) const noexcept {
+    return pos < m_input.size() ? m_input[pos] : '\0';
+  }
+
+  /// Consumes a digit followed by digits and underscores in the given base.
+  bool scan_digits(int base) noexcept {
+    const auto is_digit = [base](char c) {
+      if (base == 16) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+      }
+      return c >= '0' && c < static_cast<char>('0' + base);
+    };
+    if (!is_digit(peek())) {
+      return false;
+    }
+    ++m_pos;
+    while (is_digit(peek()) || peek() == '_') {
+      ++m_pos;
+    }
+    return true;
+  }
+
+  /// Fails if the number runs into identifier characters (e.g. `12abc`).
+  void check_number_end(std::size_t start) const {
+    if (!at_end() && is_identifier_char(static_cast<unsigned char>(peek()))) {
+      fail_at("invalid number", start);
+    }
+  }
+
+  /// The text from first to the current position, without underscores.
+  std::string_view without_underscores(std::size_t first, string_type& storage) const {
+    const auto text = m_input.substr(first, m_pos - first);
+    if (text.find('_') == std::string_view::npos) {
+      return text;
+    }
+    storage.reserve(text.size());
+    for (const char c : text) {
+      if (c != '_') {
+        storage.push_back(c);
+      }
+    }
+    return storage;
+  }
+
+  /// Converts the digits from digits_start to the current position.
+  value::integral to_integral(std::size_t start, std::size_t digits_start, int base, bool negative) const {
+    string_type storage;
+    const auto digits = without_underscores(digits_start, storage);
+    std::uint64_t magnitude = 0;
+    const auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), magnitude, base);
+    const std::uint64_t limit = negative ? std::uint64_t{1} << 63 : (std::uint64_t{1} << 63) - 1;
+    if (ec != std::errc{} || ptr != digits.data() + digits.size() || magnitude > limit) {
+      fail_at("integer out of range", start);
+    }
+    return negative ? static_cast<value::integral>(0 - magnitude) : static_cast<value::integral>(magnitude);
+  }
+
+  string_type parse_string() {
+    if (peek() == '"') {
+      return starts_with("\"\"\"") ? parse_multi_line_string(0) : parse_quoted_string();
+    }
+    if (peek() == '#') {
+      return parse_raw_string();
+    }
+    return parse_identifier();
+  }
+
+  string_type parse_identifier() {
+    const std::size_t start = m_pos;
+    while (!at_end()) {
+      if (const auto run = plain_run(scan::identifier_stops, m_input.size())) {
+        m_pos += run;
+        continue;
+      }
+      std::size_t length = 0;
+      if (!is_identifier_char(code_point_at(m_pos, length))) {
+        break;
+      }
+      m_pos += length;
+    }
+    const auto text = m_input.substr(start, m_pos - start);
+    if (text == "true" || text == "false" || text == "null" ||
+        text == "inf" || text == "-inf" || text == "nan") {
+      fail_at("keywords must be written with a leading '#'", start);
+    }
+    return string_type{text};
+  }
+
+  /// Appends the escape sequence at the current position (after the '\').
+  void parse_escape(string_type& out) {
+    const char c = peek();
+    switch (c) {
+      case 'n': out.push_back('\n'); ++m_pos; return;
+      case 'r': out.push_back('\r'); ++m_pos; return;
+      case 't': out.push_back('\t'); ++m_pos; return;
+      case 'b': out.push_back('\b'); ++m_pos; return;
+      case 'f': out.push_back('\f'); ++m_pos; return;
+      case 's': out.push_back(' '); ++m_pos; return;
+      case '"': out.push_back('"'); ++m_pos; return;
+      case '\\': out.push_back('\\'); ++m_pos; return;
+      case 'u': {
+        if (peek(1) != '{') {
+          fail("expected '{' in unicode escape");
+        }
+        m_pos += 2;
+        char32_t cp = 0;
+        std::size_t count = 0;
+        for (; count < 7 && peek() != '}'; ++count, ++m_pos) {
+          const char h = peek();
+          const int digit = (h >= '0' && h <= '9') ? h - '0'
+                          : (h >= 'a' && h <= 'f') ? h - 'a' + 10
+                          : (h >= 'A' && h <= 'F') ? h - 'A' + 10 : -1;
+          if (digit < 0) {
+            fail("invalid unicode escape");
+          }
+          cp = cp * 16 + static_cast<char32_t>(digit);
+        }
+        if (count == 0 || count > 6 || peek() != '}' || cp > 0x10FFFF ||
+            (cp >= 0xD800 && cp <= 0xDFFF)) {
+          fail("invalid unicode escape");
+        }
+        ++m_pos;
+        append_utf8(out, cp);
+        return;
+      }
+      default: {
+        // Whitespace escape: skips all following white space and newlines.
+        bool skipped = false;
+        for (;;) {
+          if (const auto length = whitespace_length(m_pos)) {
+            m_pos += length;
+          } else if (const auto length = newline_length(m_pos)) {
+            m_pos += length;
+          } else {
+            break;
+          }
+          skipped = true;
+        }
+        if (!skipped) {
+          fail("invalid escape sequence");
+        }
+      }
+    }
+  }
+
+  string_type parse_quoted_string() {
+    const std::size_t start = m_pos++;
+    string_type out;
+    for (;;) {
+      if (const auto run = plain_run(scan::string_stops, m_input.size())) {
+        out.append(m_input.substr(m_pos, run));
+        m_pos += run;
+        continue;
+      }
+      if (at_end()) {
+        fail_at("unterminated string", start);
+      }
+      const char c = peek();
+      if (c == '"') {
+        ++m_pos;
+        return out;
+      }
+      if (c == '\\') {
+        ++m_pos;
+        parse_escape(out);
+        continue;
+      }
+      if (newline_length(m_pos)) {
+        fail("newline in single-line string");
+      }
+      std::size_t length = 0;
+      if (is_disallowed(code_point_at(m_pos, length))) {
+        fail("disallowed code point in string");
+      }
+      out.append(m_input.substr(m_pos, length));
+      m_pos += length;
+    }
+  }
+
+  string_type parse_raw_string() {
+    const std::size_t start = m_pos;
+    std::size_t hashes = 0;
+    while (peek() == '#') {
+      ++hashes;
+      ++m_pos;
+    }
+    if (starts_with("\"\"\"")) {
+      return parse_multi_line_string(hashes);
+    }
+    ++m_pos;
+
+    string_type closing = "\"" + string_type(hashes, '#');
+    const std::size_t end = m_input.find(closing, m_pos);
+    if (end == std::string_view::npos) {
+      fail_at("unterminated raw string", start);
+    }
+    const std::size_t content_start = m_pos;
+    while (m_pos < end) {
+      if (const auto run = plain_run(scan::text_stops, end)) {
+        m_pos += run;
+        continue;
+      }
+      if (newline_length(m_pos)) {
+        fail("newline in single-line raw string");
+      }
+      std::size_t length = 0;
+      if (is_disallowed(code_point_at(m_pos, length))) {
+        fail("disallowed code point in string");
+      }
+      m_pos += length;
+    }
+    m_pos = end + closing.size();
+    return string_type{m_input.substr(content_start, end - content_start)};
+  }
+
+  /**
+   * Parses a `"""` string (raw when hashes > 0). The closing line's
+   * indentation is removed from every line; escapes are interpreted
+   * after dedenting.
+   */
+  string_type parse_multi_line_string(std::size_t hashes) {
+    const std::size_t start = m_pos;
+    m_pos += 3;
+    const auto first_newline = newline_length(m_pos);
+    if (!first_newline) {
+      fail("expected newline after '\"\"\"'");
+    }
+    m_pos += first_newline;
+
+    // Split into lines until a line made of white space followed by the delimiter.
+    const string_type closing = "\"\"\"" + string_type(hashes, '#');
+    std::vector<std::string_view> lines;
+    std::string_view indent;
+    for (;;) {
+      const std::size_t line_start = m_pos;
+      while (const auto length = whitespace_length(m_pos)) {
+        m_pos += length;
+      }
+      if (starts_with(closing)) {
+        indent = m_input.substr(line_start, m_pos - line_start);
+        m_pos += closing.size();
+        break;
+      }
+      while (!at_end() && !newline_length(m_pos)) {
+        if (const auto run = plain_run(scan::string_stops, m_input.size())) {
+          m_pos += run;
+          continue;
+        }
+        if (hashes == 0 && peek() == '\\' && !newline_length(m_pos + 1)) {
+          m_pos += 2;
+          continue;
+        }
+        if (starts_with(closing)) {
+          fail("multi-line string delimiter must be on its own line");
+        }
+        std::size_t length = 0;
+        if (is_disallowed(code_point_at(m_pos, length))) {
+          fail("disallowed code point in string");
+        }
+        m_pos += length;
+      }
+      if (at_end()) {
+        fail_at("unterminated multi-line string", start);
+      }
+      lines.push_back(m_input.substr(line_start, m_pos - line_start));
+      m_pos += newline_length(m_pos);
+    }
+
+    string_type dedented;
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+      auto line = lines[i];
+      if (line.substr(0, indent.size()) == indent) {
+        line.remove_prefix(indent.size());
+      } else if (line.find_first_not_of(" \t") != std::string_view::npos) {
+        fail_at("multi-line string line does not match the closing indentation", start);
+      } else {
+        line = {};
+      }
+      if (i > 0) {
+        dedented.push_back('\n');
+      }
+      dedented.append(line);
+    }
+    if (hashes > 0) {
+      return dedented;
+    }
+
+    string_type out;
+    out.reserve(dedented.size());
+    for (std::size_t i = 0; i < dedented.size(); ++i) {
+      if (dedented[i] != '\\') {
+        out.push_back(dedented[i]);
+        continue;
+      }
+      parser<handler_type> escape{dedented, m_handler, i + 1};
+      escape.parse_escape(out);
+      i = escape.position() - 1;
+    }
+    return out;
+  }
+
+  template <typename> friend class parser;
+
+  std::string_view m_input;
+  handler_type& m_handler;
+  static constexpr std::size_t validation_window = 4096;
+
+  std::size_t m_pos;
+  std::size_t m_suppressed{0};
+  std::size_t m_comments{0};
+  std::size_t m_annotations{0};
+  std::size_t m_valid_end{0};  // End of the bytes known to be valid UTF-8.
+  bool m_invalid{false};       // Whether invalid UTF-8 starts at m_valid_end.
+};
+
+/**
+ * @brief Parses a KDL document from text.
+ *
+ * @param input The KDL text.
+ * @return The parsed document; top-level nodes become children of its root.
+ * @throws kdlcpp::parse_error If the input is not valid KDL.
+ */
+inline document parse_document(std::string_view input) {
+  document doc;
+  dom_handler handler{doc.root()};
+  parser<dom_handler> p{input, handler};
+  p.parse_document();
+  return doc;
+}
+
+/**
+ * @brief Parses a KDL document lazily.
+ *
+ * Top-level nodes are parsed with their arguments and properties, while
+ * children blocks are only located. A node parses its block, in the same
+ * lazy way, the first time its children are accessed; until then the nodes
+ * share ownership of the text.
+ *
+ * @param input The KDL text.
+ * @return The parsed document; top-level nodes become children of its root.
+ * @throws kdlcpp::parse_error If the input is not valid KDL outside children
+ *         blocks. Errors inside a block are thrown by the first access to it.
+ */
+inline document parse_document_lazy(string_type input) {
+  document doc;
+  lazy_dom_handler handler{doc.root(), std::make_shared<const string_type>(std::move(input))};
+  parser<lazy_dom_handler> p{handler.source(), handler};
+  p.parse_document();
+  return doc;
+}
+
+} // namespace kdlcpp::detail::parse
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace kdlcpp::detail::scan {
+
+/**
+ * @brief The instruction sets the scans can run on.
+ */
+enum class isa {
+  scalar,  // Portable code, one byte at a time.
+  sse42,   // 16 bytes at a time, with SSE4.2 and SSSE3 shuffles.
+  avx2     // 32 bytes at a time.
+};
+
+/**
+ * @brief A set of byte values, laid out for table lookups in vector registers.
+ *
+ * Entry `low` of `rows[0]` has bit `h` set when the byte `h << 4 | low`
+ * belongs to the set, for the high nibbles 0 to 7; `rows[1]` holds the
+ * high nibbles 8 to 15 the same way.
+ */
+struct byte_set {
+  std::uint8_t rows[2][16]{};
+
+  [[nodiscard]] constexpr bool contains(unsigned char c) const noexcept {
+    return (rows[c >> 7][c & 0x0F] >> ((c >> 4) & 0x07)) & 1;
+  }
+};
+
+/**
+ * @brief Builds the set of the bytes a predicate accepts.
+ */
+template <typename predicate_type>
+constexpr byte_set make_byte_set(predicate_type predicate) noexcept {
+  byte_set set{};
+  for (unsigned c = 0; c < 256; ++c) {
+    if (predicate(static_cast<unsigned char>(c))) {
+      set.rows[c >> 7][c & 0x0F] |= static_cast<std::uint8_t>(1u << ((c >> 4) & 0x07));
+    }
+  }
+  return set;
+}
+
+/// ASCII newlines: LF, VT, FF and CR.
+constexpr bool is_ascii_newline(unsigned char c) noexcept {
+  return c >= 0x0A && c <= 0x0D;
+}
+
+/// ASCII code points that may never appear in a KDL document.
+constexpr bool is_ascii_disallowed(unsigned char c) noexcept {
+  return c <= 0x08 || (c >= 0x0E && c <= 0x1F) || c == 0x7F;
+}
+
+/// Printable ASCII bytes that end an identifier string.
+constexpr bool is_ascii_punctuation(unsigned char c) noexcept {
+  switch (c) {
+    case '\\': case '/': case '(': case ')': case '{': case '}':
+    case ';': case '[': case ']': case '"': case '#': case '=':
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Lead bytes of the multi-byte code points that are white space, newlines
+ * or disallowed: U+0085 and U+00A0 (C2), U+1680 (E1), U+2000 to U+206F
+ * (E2), U+3000 (E3) and U+FEFF (EF).
+ */
+constexpr bool is_special_lead(unsigned char c) noexcept {
+  return c == 0xC2 || c == 0xE1 || c == 0xE2 || c == 0xE3 || c == 0xEF;
+}
+
+/**
+ * Bytes that may end an identifier in valid UTF-8: every ASCII byte that
+ * is not an identifier character, and the lead bytes of multi-byte code
+ * points that may not be identifier characters.
+ */
+constexpr byte_set identifier_stops = make_byte_set([](unsigned char c) {
+  return c <= 0x20 || c == 0x7F || is_ascii_punctuation(c) || is_special_lead(c);
+});
+
+/**
+ * Bytes that need a closer look inside a quoted string in valid UTF-8:
+ * quotes, backslashes, newlines and disallowed code points.
+ */
+constexpr byte_set string_stops = make_byte_set([](unsigned char c) {
+  return c == '"' || c == '\\' || is_ascii_newline(c) || is_ascii_disallowed(c) || is_special_lead(c);
+});
+
+/**
+ * Bytes that need a closer look inside comments and raw strings in valid
+ * UTF-8: newlines and disallowed code points.
+ */
+constexpr byte_set text_stops = make_byte_set([](unsigned char c) {
+  return is_ascii_newline(c) || is_ascii_disallowed(c) || is_special_lead(c);
+});
+
+/**
+ * Bytes a quoted string may need escaped: control characters, `"`, `\`,
+ * DEL and any non-ASCII byte.
+ */
+constexpr byte_set escape_stops = make_byte_set([](unsigned char c) {
+  return c < 0x20 || c == '"' || c == '\\' || c >= 0x7F;
+});
+
+/**
+ * Bytes that keep a string from being written bare: everything but the
+ * printable ASCII identifier characters.
+ */
+constexpr byte_set bare_stops = make_byte_set([](unsigned char c) {
+  return c <= 0x20 || c >= 0x7F || is_ascii_punctuation(c);
+});
+
+/**
+ * @brief Gets the instruction set the scans run on: the best one the CPU
+ *        supports, unless another one was selected with use_isa().
+ */
+[[nodiscard]] isa active_isa() noexcept;
+
+/**
+ * @brief Checks whether the CPU and the build support an instruction set.
+ */
+[[nodiscard]] bool is_supported(isa kind) noexcept;
+
+/**
+ * @brief Selects the instruction set the scans run on, for every thread.
+ *
+ * Meant for tests and benchmarks; the default is the best one supported.
+ *
+ * @return false, leaving the selection unchanged, if it is not supported.
+ */
+bool use_isa(isa kind) noexcept;
+
+/**
+ * @brief Finds the first byte belonging to a set, in bulk.
+ *
+ * @param text The bytes to scan.
+ * @param set The bytes to look for.
+ * @return The offset of the byte, or text.size() if there is none.
+ */
+[[nodiscard]] std::size_t find_first_of_bulk(std::string_view text, const byte_set& set) noexcept;
+
+/**
+ * @brief Finds the first byte belonging to a set.
+ *
+ * Short texts, such as most names, are scanned inline; longer ones by
+ * find_first_of_bulk() on the active instruction set.
+ *
+ * @param text The bytes to scan.
+ * @param set The bytes to look for.
+ * @return The offset of the byte, or text.size() if there is none.
+ */
+[[nodiscard]] inline std::size_t find_first_of(std::string_view text, const byte_set& set) noexcept {
+  if (text.size() >= 32) {
+    return find_first_of_bulk(text, set);
+  }
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    if (set.contains(static_cast<unsigned char>(text[i]))) {
+      return i;
+    }
+  }
+  return text.size();
+}
+
+/**
+ * @brief Validates UTF-8, in bulk.
+ *
+ * Overlong forms, surrogates, code points above U+10FFFF and sequences
+ * cut short, including at the end of the text, are invalid.
+ *
+ * @param text The bytes to validate.
+ * @return The offset of the first byte of the first invalid sequence,
+ *         or text.size() if the text is valid UTF-8.
+ */
+[[nodiscard]] std::size_t validate_utf8(std::string_view text) noexcept;
+
+} // namespace kdlcpp::detail::scan
@@ -3,13 +3,110 @@
 #include "kdlcpp/stream.hpp"
 #include "kdlcpp/value.hpp"
 #include "kdlcpp/detail/tokens.hpp"
+#include "kdlcpp/detail/escape.hpp"
 #include "kdlcpp/properties.hpp"
 #include "kdlcpp/arguments.hpp"
 #include "kdlcpp/node.hpp"
 #include "kdlcpp/document.hpp"
+#include "kdlcpp/serialize_options.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace kdlcpp::detail::serialize {
 
+/**
+ * @brief Serializes a string, quoting and escaping it only as needed.
+ * 
+ * The string is classified in a single pass. Identifiers are written bare
+ * when allowed; otherwise the string is quoted, and escaped strings are
+ * written as runs of clean bytes separated by escape sequences.
+ * 
+ * @tparam stream_type The underlying stream type.
+ * @param out_stream The destination stream.
+ * @param text The string to serialize.
+ * @param allow_bare Whether the string may be written without quotes.
+ */
+template <typename stream_type>
+void serialize_string(
+  stream<stream_type>& out_stream, std::string_view text, bool allow_bare) {
+  const auto kind = escape::classify(text);
+  if (kind == escape::string_class::identifier && allow_bare) {
+    out_stream << text;
+    return;
+  }
+
+  out_stream << tokens::$quote;
+  if (kind != escape::string_class::escaped) {
+    out_stream << text;
+  } else {
+    string_type sequence;
+    while (!text.empty()) {
+      const auto clean = escape::find_escape(text);
+      out_stream << text.substr(0, clean);
+      text.remove_prefix(clean);
+      if (!text.empty()) {
+        text.remove_prefix(escape::escape_code_point(text, sequence));
+        out_stream << sequence;
+      }
+    }
+  }
+  out_stream << tokens::$quote;
+}
+
+/**
+ * @brief Serializes an integer with std::to_chars.
+ * 
+ * @tparam stream_type The underlying stream type.
+ * @param out_stream The destination stream.
+ * @param number The integer to serialize.
+ */
+template <typename stream_type>
+void serialize_integral(stream<stream_type>& out_stream, value::integral number) {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+  out_stream << std::string_view{buffer, static_cast<std::size_t>(result.ptr - buffer)};
+}
+
+/**
+ * @brief Serializes a decimal with the shortest representation that
+ *        parses back to the same value.
+ * 
+ * Infinities and NaN are written as `#inf`, `#-inf` and `#nan`. Whole
+ * numbers get a trailing `.0` so that they are read back as decimals.
+ * 
+ * @tparam stream_type The underlying stream type.
+ * @param out_stream The destination stream.
+ * @param number The decimal to serialize.
+ */
+template <typename stream_type>
+void serialize_decimal(stream<stream_type>& out_stream, value::decimal number) {
+  if (std::isnan(number)) {
+    out_stream << tokens::$nan;
+    return;
+  }
+  if (std::isinf(number)) {
+    out_stream << (number > 0 ? tokens::$inf : tokens::$ninf);
+    return;
+  }
+
+  char buffer[32];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer) - 2, number);
+  std::string_view text{buffer, static_cast<std::size_t>(result.ptr - buffer)};
+  if (text.find_first_of(".e") == std::string_view::npos) {
+    *result.ptr = '.';
+    *(result.ptr + 1) = '0';
+    text = std::string_view{buffer, text.size() + 2};
+  }
+  out_stream << text;
+}
+
 /**
  * @brief Serializes a `kdlcpp::value` instance into a stream.
  * 
@@ -17,15 +114,16 @@ namespace kdlcpp::detail::serialize {
  * - null      → `"null"`
  * - boolean   → `"true"` or `"false"`
  * - integral  → `123`
- * - decimal   → `3.14`
- * - string    → `"hello"`
+ * - decimal   → `3.14`, `1.0`, `#inf`, `#-inf` or `#nan`
+ * - string    → `"hello"`, or `hello` when bare strings are allowed
  *
  * @tparam stream_type The underlying stream type.
  * @param out_stream The destination stream.
  * @param val The value to serialize.
+ * @param bare_strings Whether identifier strings may be written without quotes.
  */
 template <typename stream_type>
-void serialize_value(stream<stream_type>& out_stream, const value& val) {
+void serialize_value(stream<stream_type>& out_stream, const value& val, bool bare_strings = false) {
   switch (val.get_type()) {
     case value::type::null:
       out_stream << tokens::$null;
@@ -40,21 +138,21 @@ void serialize_value(stream<stream_type>& out_stream, const value& val) {
     case value::type::integral: {
       auto content = val.get<value::integral>();
       if (content) {
-        out_stream << *content;
+        serialize_integral(out_stream, *content);
       }
       break;
     }
     case value::type::decimal: {
       auto content = val.get<value::decimal>();
       if (content) {
-        out_stream << *content;
+        serialize_decimal(out_stream, *content);
       }
       break;
     }
     case value::type::string: {
       auto content = val.get<value::string>();
       if (content) {
-        out_stream << tokens::$quote << *content << tokens::$quote;
+        serialize_string(out_stream, *content, bare_strings);
       }
       break;
     }
@@ -64,19 +162,36 @@ void serialize_value(stream<stream_type>& out_stream, const value& val) {
 /**
  * @brief Serializes a key-value property.
  * 
- * Format: `"key"=value`
+ * Format: `key=value`, with the key quoted when it is not an identifier.
  * 
  * @tparam stream_type The underlying stream type.
  * @param out_stream The destination stream.
  * @param key The property key.
  * @param val The property value.
+ * @param bare_strings Whether an identifier string value may be written without quotes.
  */
 template <typename stream_type>
 void serialize_property(
-  stream<stream_type>& out_stream, const string_type& key, const value& val) {
-  out_stream << tokens::$quote << key << tokens::$quote;
+  stream<stream_type>& out_stream, std::string_view key, const value& val,
+  bool bare_strings = false) {
+  serialize_string(out_stream, key, true);
   out_stream << tokens::$equal;
-  serialize_value(out_stream, val);
+  serialize_value(out_stream, val, bare_strings);
+}
+
+/**
+ * @brief Whether a style writes nodes in the compact layout.
+ */
+[[nodiscard]] inline bool is_compact(const serialize_options& options) noexcept {
+  return options.output_style == serialize_options::style::compact ||
+         options.output_style == serialize_options::style::canonical;
+}
+
+/**
+ * @brief Whether a style writes identifier string values without quotes.
+ */
+[[nodiscard]] inline bool writes_bare_strings(const serialize_options& options) noexcept {
+  return options.output_style == serialize_options::style::canonical;
 }
 
 /**
@@ -85,13 +200,43 @@ void serialize_property(
  * @tparam stream_type The underlying stream type.
  * @param out_stream The destination stream.
  * @param props The collection of properties.
+ * @param options The output layout.
  */
 template <typename stream_type>
 void serialize_properties(
-  stream<stream_type>& out_stream, const properties& props) {
-  for (const auto& [key, val] : props) {
-    serialize_property(out_stream, key, val);
-    out_stream << tokens::$space;
+  stream<stream_type>& out_stream, const properties& props,
+  const serialize_options& options = {}) {
+  const bool standard = options.output_style == serialize_options::style::standard;
+  const bool bare = writes_bare_strings(options);
+  const auto write = [&](const string_type& key, const value& val) {
+    if (!standard) {
+      out_stream << tokens::$space;
+    }
+    serialize_property(out_stream, key, val, bare);
+    if (standard) {
+      out_stream << tokens::$space;
+    }
+  };
+
+  if (options.output_style != serialize_options::style::canonical && !options.sort_properties) {
+    for (const auto& [key, val] : props) {
+      write(key, val);
+    }
+    return;
+  }
+
+  // The map iteration order depends on its history and on the standard
+  // library, so sorted output orders properties by the bytes of their keys.
+  std::vector<const std::pair<const string_type, value>*> sorted;
+  sorted.reserve(props.size());
+  for (const auto& property : props) {
+    sorted.push_back(&property);
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const auto* lhs, const auto* rhs) {
+    return lhs->first < rhs->first;
+  });
+  for (const auto* property : sorted) {
+    write(property->first, property->second);
   }
 }
 
@@ -101,41 +246,319 @@ void serialize_properties(
  * @tparam stream_type The underlying stream type.
  * @param out_stream The destination stream.
  * @param args The list of arguments.
+ * @param options The output layout.
  */
 template <typename stream_type>
 void serialize_arguments(
-  stream<stream_type>& out_stream, const arguments& args) {
-  for (const auto& arg : args) {
-    serialize_value(out_stream, arg);
+  stream<stream_type>& out_stream, const arguments& args,
+  const serialize_options& options = {}) {
+  // In the standard style every item is followed by a space,
+  // in the others it is preceded by one.
+  const bool standard = options.output_style == serialize_options::style::standard;
+  const auto write_each = [&](const auto& items, auto write) {
+    for (const auto& item : items) {
+      if (!standard) {
+        out_stream << tokens::$space;
+      }
+      write(item);
+      if (standard) {
+        out_stream << tokens::$space;
+      }
+    }
+  };
+
+  // Packed runs are formatted straight from the array, without
+  // building a value for every element.
+  if (const auto* integrals = args.packed_integrals()) {
+    write_each(*integrals, [&](value::integral number) { serialize_integral(out_stream, number); });
+  } else if (const auto* decimals = args.packed_decimals()) {
+    write_each(*decimals, [&](value::decimal number) { serialize_decimal(out_stream, number); });
+  } else {
+    const bool bare = writes_bare_strings(options);
+    write_each(args, [&](const value& arg) { serialize_value(out_stream, arg, bare); });
+  }
+}
+
+/**
+ * @brief Writes the indentation of a nesting level in the pretty style.
+ *
+ * The indentation is written in slices of a constant run of characters,
+ * so no string is built for it.
+ * 
+ * @tparam stream_type The underlying stream type.
+ * @param out_stream The destination stream.
+ * @param options The output layout.
+ * @param depth The nesting level.
+ */
+template <typename stream_type>
+void serialize_indent(
+  stream<stream_type>& out_stream, const serialize_options& options, std::size_t depth) {
+  constexpr std::string_view spaces = "                                                                ";
+  constexpr std::string_view tabs = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+  const std::string_view run = options.indent_char == '\t' ? tabs : spaces;
+  for (std::size_t left = options.indent * depth; left > 0;) {
+    const std::size_t count = left < run.size() ? left : run.size();
+    out_stream << run.substr(0, count);
+    left -= count;
+  }
+}
+
+/**
+ * @brief Whether a node is written with a children block.
+ *
+ * The standard style writes a block for every node,
+ * the others only for nodes that have children.
+ */
+[[nodiscard]] inline bool has_children_block(const serialize_options& options, bool has_children) noexcept {
+  return has_children || options.output_style == serialize_options::style::standard;
+}
+
+/**
+ * @brief Identifies the bytes a node is serialized to for given options
+ *        and nesting level, so that cached bytes are only reused when
+ *        they would be written again the same way.
+ *
+ * @param options The output layout.
+ * @param depth The nesting level.
+ * @return 0 for the standard style with unsorted properties, whose output
+ *         does not depend on depth.
+ */
+[[nodiscard]] inline std::uint64_t format_tag(const serialize_options& options, std::size_t depth) noexcept {
+  // The canonical style sorts properties whatever the option says.
+  const std::uint64_t sorted = options.sort_properties ? std::uint64_t{1} << 63 : 0;
+  switch (options.output_style) {
+    case serialize_options::style::standard:
+      return sorted;
+    case serialize_options::style::compact:
+      return sorted | (depth == 0 ? 1 : 2);
+    case serialize_options::style::canonical:
+      return depth == 0 ? 4 : 6;
+    case serialize_options::style::pretty:
+      break;
+  }
+  return sorted | 3 | (options.indent_char == '\t' ? 4u : 0u) |
+         (static_cast<std::uint64_t>(options.indent & 0xFFFF) << 3) |
+         (static_cast<std::uint64_t>(depth) << 19);
+}
+
+/**
+ * @brief Serializes the part of a node that comes before its children block:
+ *        indentation, name, arguments and properties.
+ * 
+ * @tparam stream_type The underlying stream type.
+ * @param out_stream The destination stream.
+ * @param node_ The node to serialize.
+ * @param options The output layout.
+ * @param depth The nesting level of the node.
+ */
+template <typename stream_type>
+void serialize_node_head(
+  stream<stream_type>& out_stream, const node& node_,
+  const serialize_options& options = {}, std::size_t depth = 0) {
+  if (options.output_style == serialize_options::style::pretty) {
+    serialize_indent(out_stream, options, depth);
+  }
+  serialize_string(out_stream, node_.get_name(), true);
+  if (options.output_style == serialize_options::style::standard) {
     out_stream << tokens::$space;
   }
+  serialize_arguments(out_stream, node_.get_arguments(), options);
+  serialize_properties(out_stream, node_.get_properties(), options);
+}
+
+/**
+ * @brief Opens the children block of a node.
+ * 
+ * @tparam stream_type The underlying stream type.
+ * @param out_stream The destination stream.
+ * @param options The output layout.
+ */
+template <typename stream_type>
+void serialize_children_open(
+  stream<stream_type>& out_stream, const serialize_options& options = {}) {
+  switch (options.output_style) {
+    case serialize_options::style::standard:
+      out_stream << tokens::$lbrace << tokens::$newln;
+      break;
+    case serialize_options::style::compact:
+    case serialize_options::style::canonical:
+      out_stream << tokens::$lbrace;
+      break;
+    case serialize_options::style::pretty:
+      out_stream << tokens::$space << tokens::$lbrace << tokens::$newln;
+      break;
+  }
+}
+
+/**
+ * @brief Writes what separates a child node from the previous one.
+ *
+ * Only the compact layout needs a separator, `;`, between siblings
+ * inside a children block.
+ * 
+ * @tparam stream_type The underlying stream type.
+ * @param out_stream The destination stream.
+ * @param options The output layout.
+ * @param depth The nesting level of the child.
+ * @param first Whether the child is the first one of its block.
+ */
+template <typename stream_type>
+void serialize_sibling_separator(
+  stream<stream_type>& out_stream, const serialize_options& options,
+  std::size_t depth, bool first) {
+  if (is_compact(options) && depth > 0 && !first) {
+    out_stream << tokens::$semi;
+  }
+}
+
+/**
+ * @brief Serializes the part of a node that comes after its children:
+ *        the end of the children block, if any, and the node terminator.
+ * 
+ * @tparam stream_type The underlying stream type.
+ * @param out_stream The destination stream.
+ * @param children_block Whether the children block was opened.
+ * @param options The output layout.
+ * @param depth The nesting level of the node.
+ */
+template <typename stream_type>
+void serialize_node_close(
+  stream<stream_type>& out_stream, bool children_block = true,
+  const serialize_options& options = {}, std::size_t depth = 0) {
+  switch (options.output_style) {
+    case serialize_options::style::standard:
+      out_stream << tokens::$newln << tokens::$rbrace << tokens::$newln;
+      break;
+    case serialize_options::style::compact:
+    case serialize_options::style::canonical:
+      if (children_block) {
+        out_stream << tokens::$rbrace;
+      }
+      if (depth == 0) {
+        out_stream << tokens::$newln;
+      }
+      break;
+    case serialize_options::style::pretty:
+      if (children_block) {
+        serialize_indent(out_stream, options, depth);
+        out_stream << tokens::$rbrace;
+      }
+      out_stream << tokens::$newln;
+      break;
+  }
 }
 
 /**
  * @brief Serializes a KDL node and its children recursively.
  * 
- * Format:
+ * Standard format:
  * ```
  * node-name arg1 arg2 key="value" {
- *   child-node ...
+ * child-node ...
+ * }
+ * ```
+ * Compact format: `node-name arg1 key="value"{child-node;other-node}`.
+ * Pretty format:
+ * ```
+ * node-name arg1 key="value" {
+ *     child-node
  * }
  * ```
  * 
  * @tparam stream_type The underlying stream type.
  * @param out_stream The destination stream.
  * @param node_ The node to serialize.
+ * @param options The output layout.
+ * @param depth The nesting level of the node.
  */
 template <typename stream_type>
 void serialize_node(
-  stream<stream_type>& out_stream, const node& node_) {
-  out_stream << node_.get_name() << tokens::$space;
-  serialize_arguments(out_stream, node_.get_arguments());
-  serialize_properties(out_stream, node_.get_properties());
-  out_stream << tokens::$lbrace << tokens::$newln;
-  for (const auto& child : node_.get_children()) {
-    serialize_node(out_stream, child);
+  stream<stream_type>& out_stream, const node& node_,
+  const serialize_options& options = {}, std::size_t depth = 0) {
+  serialize_node_head(out_stream, node_, options, depth);
+  const auto& children = node_.get_children();
+  const bool children_block = has_children_block(options, !children.empty());
+  if (children_block) {
+    serialize_children_open(out_stream, options);
+  }
+  bool first = true;
+  for (const auto& child : children) {
+    serialize_sibling_separator(out_stream, options, depth + 1, first);
+    serialize_node(out_stream, child, options, depth + 1);
+    first = false;
+  }
+  serialize_node_close(out_stream, children_block, options, depth);
+}
+
+/**
+ * @brief Serializes a KDL node, reusing the bytes cached by a previous call
+ *        for every subtree that was not modified since.
+ * 
+ * Dirty nodes are formatted again and their bytes cached on the way out,
+ * so after a small edit only the path from the edited node up to the root
+ * is formatted; clean subtrees are copied as they are. The output is the
+ * same as serialize_node(). Each cached node keeps the bytes of its whole
+ * subtree, so memory grows with the depth of the tree. Bytes cached for
+ * other options, or for another nesting level in the pretty style, are
+ * formatted again.
+ * 
+ * @tparam stream_type The underlying stream type.
+ * @param out_stream The destination stream.
+ * @param node_ The node to serialize.
+ * @param options The output layout.
+ * @param depth The nesting level of the node.
+ */
+template <typename stream_type>
+void serialize_node_cached(
+  stream<stream_type>& out_stream, node& node_,
+  const serialize_options& options = {}, std::size_t depth = 0) {
+  const auto tag = format_tag(options, depth);
+  if (!node_.is_dirty() && node_.get_serialized_format() == tag) {
+    out_stream << node_.get_serialized();
+    return;
+  }
+
+  stream<std::ostringstream> buffer{std::ostringstream{}};
+  if (node_.get_shared()) {
+    // Mutable access would copy the shared content back, so shared
+    // subtrees are written through the const path.
+    serialize_node(buffer, std::as_const(node_), options, depth);
+  } else {
+    serialize_node_head(buffer, std::as_const(node_), options, depth);
+    auto& children = node_.get_children();
+    const bool children_block = has_children_block(options, !children.empty());
+    if (children_block) {
+      serialize_children_open(buffer, options);
+    }
+    bool first = true;
+    for (auto& child : children) {
+      serialize_sibling_separator(buffer, options, depth + 1, first);
+      serialize_node_cached(buffer, child, options, depth + 1);
+      first = false;
+    }
+    serialize_node_close(buffer, children_block, options, depth);
+  }
+
+  node_.set_serialized(buffer.get().str(), tag);
+  out_stream << node_.get_serialized();
+}
+
+/**
+ * @brief Writes the comment header with the document name. The compact
+ *        layout leaves it out, as comments are not read back.
+ * 
+ * @tparam stream_type The type of the underlying stream.
+ * @param out_stream The output stream to write to.
+ * @param doc The document to serialize.
+ * @param options The output layout.
+ */
+template <typename stream_type>
+void serialize_document_header(
+  stream<stream_type>& out_stream, const document& doc, const serialize_options& options) {
+  if (!is_compact(options)) {
+    out_stream << tokens::$slash << tokens::$slash << tokens::$space;
+    out_stream << doc.name() << tokens::$newln;
   }
-  out_stream << tokens::$newln << tokens::$rbrace << tokens::$newln;
 }
 
 /**
@@ -153,17 +576,38 @@ void serialize_node(
  * @tparam stream_type The type of the underlying stream.
  * @param out_stream The output stream to write to.
  * @param doc The document to serialize.
+ * @param options The output layout.
  */
 template <typename stream_type>
 void serialize_document(
-  stream<stream_type>& out_stream, const document& doc) {
-  out_stream << tokens::$slash << tokens::$slash << tokens::$space;
-  out_stream << doc.name() << tokens::$newln;
+  stream<stream_type>& out_stream, const document& doc,
+  const serialize_options& options = {}) {
+  serialize_document_header(out_stream, doc, options);
   for (const auto& node_: doc.root().get_children()) {
-    serialize_node(out_stream, node_);
+    serialize_node(out_stream, node_, options);
+  }
+}
+
+/**
+ * @brief Serializes a `kdlcpp::document` into a stream, reusing the
+ *        bytes cached for every clean subtree.
+ * 
+ * @see serialize_node_cached
+ * 
+ * @tparam stream_type The type of the underlying stream.
+ * @param out_stream The output stream to write to.
+ * @param doc The document to serialize.
+ * @param options The output layout.
+ */
+template <typename stream_type>
+void serialize_document_cached(
+  stream<stream_type>& out_stream, document& doc,
+  const serialize_options& options = {}) {
+  serialize_document_header(out_stream, doc, options);
+  for (auto& node_: doc.root().get_children()) {
+    serialize_node_cached(out_stream, node_, options);
   }
 }
 
 
 } // namespace kdlcpp::detail::serialize
-  
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "kdlcpp/common.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace kdlcpp::detail {
+
+/**
+ * @brief Incremental SHA-256 (FIPS 180-4).
+ *
+ * Input can be fed in pieces of any size; small pieces are gathered
+ * in the block buffer, so writing one byte at a time stays cheap.
+ */
+class sha256 {
+public:
+  using digest_type = std::array<std::uint8_t, 32>;
+
+  /**
+   * @brief Hashes more input.
+   * @param data The bytes to hash.
+   */
+  void update(std::string_view data) noexcept {
+    if (m_used + data.size() < block_size) {
+      std::memcpy(m_block + m_used, data.data(), data.size());
+      m_used += data.size();
+      m_length += data.size();
+      return;
+    }
+    update_blocks(data);
+  }
+
+  /**
+   * @brief Hashes one more byte.
+   * @param c The byte to hash.
+   */
+  void update(char c) noexcept {
+    m_block[m_used++] = static_cast<std::uint8_t>(c);
+    ++m_length;
+    if (m_used == block_size) {
+      compress(m_block);
+      m_used = 0;
+    }
+  }
+
+  /**
+   * @brief Completes the hash. The object must not be updated afterwards.
+   * @return The digest of all the input.
+   */
+  [[nodiscard]] digest_type finish() noexcept;
+
+private:
+  static constexpr std::size_t block_size = 64;
+
+  void update_blocks(std::string_view data) noexcept;
+  void compress(const std::uint8_t* block) noexcept;
+
+  std::uint32_t m_state[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+  };
+  std::uint8_t m_block[block_size];
+  std::size_t m_used{0};
+  std::uint64_t m_length{0};
+};
+
+/**
+ * @brief A stream type that hashes what is written to it instead of
+ *        storing it. Meant to be wrapped in a kdlcpp::stream.
+ */
+class digest_sink {
+public:
+  digest_sink& operator<<(char c) noexcept {
+    m_hash.update(c);
+    return *this;
+  }
+
+  digest_sink& operator<<(std::string_view text) noexcept {
+    m_hash.update(text);
+    return *this;
+  }
+
+  digest_sink& operator<<(const char* text) noexcept {
+    return *this << std::string_view{text};
+  }
+
+  digest_sink& operator<<(const string_type& text) noexcept {
+    return *this << std::string_view{text};
+  }
+
+  /**
+   * @brief Completes the hash of everything written so far.
+   */
+  [[nodiscard]] sha256::digest_type finish() noexcept {
+    return m_hash.finish();
+  }
+
+private:
+  sha256 m_hash;
+};
+
+} // namespace kdlcpp::detail
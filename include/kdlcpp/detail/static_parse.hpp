@@ -0,0 +1,1280 @@
+#pragma once
+
+#include "kdlcpp/common.hpp"
+#include "kdlcpp/value.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+namespace kdlcpp::detail::static_kdl {
+
+/// A string stored in the character table of a static document.
+struct string_ref {
+  std::size_t offset{0};
+  std::size_t length{0};
+};
+
+/// A value as stored in a static document; strings refer to the character table.
+struct raw_value {
+  value::type kind{value::type::null};
+  value::boolean boolean{false};
+  value::integral integral{0};
+  value::decimal decimal{0};
+  string_ref text{};
+};
+
+/**
+ * @brief A node of a static document.
+ *
+ * Arguments and properties are ranges of the argument and property
+ * tables; children are a range of the child index table.
+ */
+struct node_entry {
+  string_ref name{};
+  std::size_t parent{0};
+  std::size_t first_argument{0};
+  std::size_t argument_count{0};
+  std::size_t first_property{0};
+  std::size_t property_count{0};
+  std::size_t first_child{0};
+  std::size_t child_count{0};
+};
+
+struct property_entry {
+  string_ref key{};
+  raw_value val{};
+};
+
+/// The size of the tables of a static document. The root counts as a node.
+struct counts {
+  std::size_t nodes{1};
+  std::size_t arguments{0};
+  std::size_t properties{0};
+  std::size_t chars{0};
+};
+
+/**
+ * @brief The tables of a static document, in pre-order: node 0 is the
+ *        root, whose children are the top-level nodes.
+ */
+template <std::size_t node_count, std::size_t argument_count, std::size_t property_count,
+          std::size_t char_count>
+struct tables {
+  std::array<node_entry, node_count> nodes{};
+  std::array<std::size_t, node_count> children{};
+  std::array<raw_value, argument_count> arguments{};
+  std::array<property_entry, property_count> properties{};
+  std::array<char, char_count> chars{};
+};
+
+/// Pointers into the tables, shared by the views of a static document.
+struct table_view {
+  const node_entry* nodes{nullptr};
+  const std::size_t* children{nullptr};
+  const raw_value* arguments{nullptr};
+  const property_entry* properties{nullptr};
+  const char* chars{nullptr};
+
+  [[nodiscard]] constexpr std::string_view text(string_ref ref) const noexcept {
+    return std::string_view{chars + ref.offset, ref.length};
+  }
+};
+
+/**
+ * @brief An unsigned integer wide enough to convert any decimal exactly.
+ *
+ * The decimals converted keep at most max_digits significant digits and
+ * lie between 10^-325 and 10^310, so their numerators and denominators,
+ * scaled to give a 54-bit quotient, stay below 2^4096.
+ */
+struct big_integer {
+  static constexpr std::size_t capacity = 128;
+  static constexpr std::size_t max_digits = 780;
+
+  std::uint32_t limbs[capacity]{};  // Least significant first.
+  std::size_t size{0};              // Limbs in use; the top one is not zero.
+
+  constexpr void multiply_add(std::uint32_t factor, std::uint32_t addend) noexcept {
+    std::uint64_t carry = addend;
+    for (std::size_t i = 0; i < size; ++i) {
+      carry += std::uint64_t{limbs[i]} * factor;
+      limbs[i] = static_cast<std::uint32_t>(carry);
+      carry >>= 32;
+    }
+    if (carry != 0) {
+      limbs[size++] = static_cast<std::uint32_t>(carry);
+    }
+  }
+
+  constexpr void multiply_power_of_ten(std::size_t exponent) noexcept {
+    for (; exponent >= 9; exponent -= 9) {
+      multiply_add(1000000000u, 0);
+    }
+    std::uint32_t factor = 1;
+    for (; exponent > 0; --exponent) {
+      factor *= 10;
+    }
+    multiply_add(factor, 0);
+  }
+
+  constexpr void shift_left(std::size_t bits) noexcept {
+    if (size == 0) {
+      return;
+    }
+    const std::size_t whole = bits / 32;
+    const std::size_t part = bits % 32;
+    std::size_t top = size + whole;
+    limbs[top] = 0;
+    for (std::size_t i = size; i-- > 0;) {
+      const std::uint64_t wide = std::uint64_t{limbs[i]} << part;
+      limbs[i + whole + 1] |= static_cast<std::uint32_t>(wide >> 32);
+      limbs[i + whole] = static_cast<std::uint32_t>(wide);
+    }
+    for (std::size_t i = 0; i < whole; ++i) {
+      limbs[i] = 0;
+    }
+    size = limbs[top] != 0 ? top + 1 : top;
+  }
+
+  [[nodiscard]] constexpr std::size_t bit_length() const noexcept {
+    if (size == 0) {
+      return 0;
+    }
+    std::size_t bits = (size - 1) * 32;
+    for (std::uint32_t top = limbs[size - 1]; top != 0; top >>= 1) {
+      ++bits;
+    }
+    return bits;
+  }
+
+  [[nodiscard]] constexpr int compare(const big_integer& other) const noexcept {
+    if (size != other.size) {
+      return size < other.size ? -1 : 1;
+    }
+    for (std::size_t i = size; i-- > 0;) {
+      if (limbs[i] != other.limbs[i]) {
+        return limbs[i] < other.limbs[i] ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  /// Subtracts a number no greater than this one.
+  constexpr void subtract(const big_integer& other) noexcept {
+    std::uint64_t borrow = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+      const std::uint64_t taken = (i < other.size ? other.limbs[i] : 0) + borrow;
+      borrow = limbs[i] < taken;
+      limbs[i] = static_cast<std::uint32_t>(limbs[i] - taken);
+    }
+    while (size > 0 && limbs[size - 1] == 0) {
+      --size;
+    }
+  }
+
+  /// Divides by a number at most 2^63 times smaller, leaving the remainder.
+  constexpr std::uint64_t divide(const big_integer& divisor) noexcept {
+    const std::size_t bits = bit_length();
+    const std::size_t divisor_bits = divisor.bit_length();
+    std::uint64_t quotient = 0;
+    for (std::size_t shift = bits < divisor_bits ? 0 : bits - divisor_bits + 1; shift-- > 0;) {
+      big_integer shifted = divisor;
+      shifted.shift_left(shift);
+      if (compare(shifted) >= 0) {
+        subtract(shifted);
+        quotient |= std::uint64_t{1} << shift;
+      }
+    }
+    return quotient;
+  }
+};
+
+/**
+ * @brief A KDL parser that runs in constant expressions.
+ *
+ * It accepts the grammar of parse::parser and reports to a sink:
+ * ```
+ * constexpr std::size_t size() const;          // characters written so far
+ * constexpr void put(char c);                  // appends a character
+ * constexpr void truncate(std::size_t size);   // drops the characters past size
+ * constexpr void begin_node(string_ref name);
+ * constexpr void argument(const raw_value& val);
+ * constexpr void property(string_ref key, const raw_value& val);
+ * constexpr void end_node();
+ * ```
+ * Every string is written to the sink as it is decoded, and dropped again
+ * when it belongs to a type annotation or to slashdashed content.
+ *
+ * A syntax error throws kdlcpp::parse_error, which in a constant
+ * expression makes the program ill-formed: the compiler reports the throw
+ * along with the message and offset passed to fail_at().
+ *
+ * Decimals are rounded to the nearest double, ties to even, as the
+ * runtime parser does; those rounding to zero or infinity are rejected.
+ *
+ * @tparam sink_type The sink receiving the strings and the events.
+ */
+template <typename sink_type>
+class parser {
+public:
+  constexpr parser(std::string_view input, sink_type& sink) noexcept
+    : m_input(input), m_sink(sink) {
+    if (m_input.substr(0, 3) == "\xEF\xBB\xBF") {
+      m_pos = 3;
+    }
+  }
+
+  /// Parses every node until the end of the input.
+  constexpr void parse_document() {
+    for (;;) {
+      skip_line_space();
+      if (at_end()) {
+        return;
+      }
+      if (peek() == '}') {
+        fail("unexpected '}'");
+      }
+      parse_node();
+    }
+  }
+
+private:
+  constexpr void fail(const char* message) const {
+    fail_at(message, m_pos);
+  }
+
+  /// Throws a parse_error, which cannot be a constant expression.
+  constexpr void fail_at(const char* message, std::size_t offset) const {
+    if (message != nullptr) {
+      std::size_t line = 1;
+      std::size_t line_start = 0;
+      for (std::size_t i = 0; i < offset && i < m_input.size(); ++i) {
+        if (m_input[i] == '\n') {
+          ++line;
+          line_start = i + 1;
+        }
+      }
+      throw parse_error{message, offset, line, offset - line_start + 1};
+    }
+  }
+
+  [[nodiscard]] constexpr bool at_end() const noexcept {
+    return m_pos >= m_input.size();
+  }
+
+  [[nodiscard]] constexpr char peek_at(std::size_t pos) const noexcept {
+    return pos < m_input.size() ? m_input[pos] : '\0';
+  }
+
+  [[nodiscard]] constexpr char peek(std::size_t ahead = 0) const noexcept {
+    return peek_at(m_pos + ahead);
+  }
+
+  [[nodiscard]] constexpr bool starts_with(std::string_view prefix) const noexcept {
+    return m_input.substr(m_pos < m_input.size() ? m_pos : m_input.size(), prefix.size()) == prefix;
+  }
+
+  /// Whether `quotes` quotes followed by `hashes` hashes start at a position.
+  [[nodiscard]] constexpr bool closes_at(std::size_t pos, std::size_t quotes, std::size_t hashes) const noexcept {
+    for (std::size_t i = 0; i < quotes + hashes; ++i) {
+      if (peek_at(pos + i) != (i < quotes ? '"' : '#')) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr char32_t code_point_at(std::size_t pos, std::size_t& length) const {
+    const char32_t cp = parse::decode_utf8(m_input, pos, length);
+    if (length == 0) {
+      fail_at("invalid UTF-8", pos);
+    }
+    return cp;
+  }
+
+  constexpr std::size_t newline_length(std::size_t pos) const {
+    if (pos >= m_input.size()) {
+      return 0;
+    }
+    const char c = m_input[pos];
+    if (c == '\r') {
+      return peek_at(pos + 1) == '\n' ? 2 : 1;
+    }
+    if (c == '\n' || c == '\x0B' || c == '\x0C') {
+      return 1;
+    }
+    if (static_cast<unsigned char>(c) < 0x80) {
+      return 0;
+    }
+    std::size_t length = 0;
+    return parse::is_newline(code_point_at(pos, length)) ? length : 0;
+  }
+
+  constexpr std::size_t whitespace_length(std::size_t pos) const {
+    if (pos >= m_input.size()) {
+      return 0;
+    }
+    const char c = m_input[pos];
+    if (c == ' ' || c == '\t') {
+      return 1;
+    }
+    if (static_cast<unsigned char>(c) < 0x80) {
+      return 0;
+    }
+    std::size_t length = 0;
+    return parse::is_whitespace(code_point_at(pos, length)) ? length : 0;
+  }
+
+  constexpr void skip_single_line_comment() {
+    m_pos += 2;
+    while (!at_end()) {
+      if (const auto length = newline_length(m_pos)) {
+        m_pos += length;
+        return;
+      }
+      std::size_t length = 0;
+      if (parse::is_disallowed(code_point_at(m_pos, length))) {
+        fail("disallowed code point in comment");
+      }
+      m_pos += length;
+    }
+  }
+
+  constexpr void skip_multi_line_comment() {
+    const std::size_t start = m_pos;
+    std::size_t depth = 0;
+    while (!at_end()) {
+      if (starts_with("/*")) {
+        ++depth;
+        m_pos += 2;
+      } else if (starts_with("*/")) {
+        m_pos += 2;
+        if (--depth == 0) {
+          return;
+        }
+      } else {
+        ++m_pos;
+      }
+    }
+    fail_at("unterminated block comment", start);
+  }
+
+  constexpr void skip_line_space() {
+    for (;;) {
+      if (const auto length = whitespace_length(m_pos)) {
+        m_pos += length;
+      } else if (const auto length = newline_length(m_pos)) {
+        m_pos += length;
+      } else if (starts_with("//")) {
+        skip_single_line_comment();
+      } else if (starts_with("/*")) {
+        skip_multi_line_comment();
+      } else {
+        return;
+      }
+    }
+  }
+
+  constexpr bool skip_node_space() {
+    const std::size_t start = m_pos;
+    for (;;) {
+      if (const auto length = whitespace_length(m_pos)) {
+        m_pos += length;
+      } else if (starts_with("/*")) {
+        skip_multi_line_comment();
+      } else if (peek() == '\\') {
+        ++m_pos;
+        while (const auto length = whitespace_length(m_pos)) {
+          m_pos += length;
+        }
+        if (starts_with("//")) {
+          skip_single_line_comment();
+        } else if (const auto length = newline_length(m_pos)) {
+          m_pos += length;
+        } else if (!at_end()) {
+          fail("expected newline after line continuation");
+        }
+      } else {
+        return m_pos != start;
+      }
+    }
+  }
+
+  constexpr bool at_node_terminator() const {
+    return at_end() || peek() == ';' || peek() == '}' ||
+           starts_with("//") || newline_length(m_pos) != 0;
+  }
+
+  constexpr void parse_node() {
+    const std::size_t mark = m_sink.size();
+    const bool disabled = starts_with("/-");
+    if (disabled) {
+      m_pos += 2;
+      skip_line_space();
+      ++m_suppressed;
+    }
+
+    if (parse_type_annotation()) {
+      skip_node_space();
+    }
+    if (!starts_string()) {
+      fail("expected a node name");
+    }
+    const string_ref name = parse_string();
+    if (!m_suppressed) {
+      m_sink.begin_node(name);
+    }
+
+    bool seen_children = false;
+    for (;;) {
+      const bool spaced = skip_node_space();
+      if (at_node_terminator()) {
+        break;
+      }
+
+      bool slashdash = false;
+      if (starts_with("/-")) {
+        if (!spaced) {
+          fail("expected white space before slashdash");
+        }
+        m_pos += 2;
+        skip_line_space();
+        slashdash = true;
+      }
+
+      if (peek() == '{') {
+        if (seen_children && !slashdash) {
+          fail("a node can only have one children block");
+        }
+        parse_children(slashdash);
+        seen_children = seen_children || !slashdash;
+        continue;
+      }
+      if (!spaced && !slashdash) {
+        fail("expected white space");
+      }
+      if (seen_children) {
+        fail("arguments and properties must come before children");
+      }
+      parse_property_or_argument(slashdash);
+    }
+
+    if (peek() == ';') {
+      ++m_pos;
+    } else if (starts_with("//")) {
+      skip_single_line_comment();
+    } else if (const auto length = newline_length(m_pos)) {
+      m_pos += length;
+    }
+
+    if (!m_suppressed) {
+      m_sink.end_node();
+    } else {
+      m_sink.truncate(mark);
+    }
+    if (disabled) {
+      --m_suppressed;
+    }
+  }
+
+  constexpr void parse_children(bool disabled) {
+    m_suppressed += disabled;
+    ++m_pos;
+    for (;;) {
+      skip_line_space();
+      if (at_end()) {
+        fail("expected '}'");
+      }
+      if (peek() == '}') {
+        ++m_pos;
+        break;
+      }
+      parse_node();
+    }
+    m_suppressed -= disabled;
+  }
+
+  constexpr void parse_property_or_argument(bool disabled) {
+    const std::size_t mark = m_sink.size();
+    m_suppressed += disabled;
+    if (parse_type_annotation()) {
+      skip_node_space();
+      const raw_value val = parse_value();
+      if (!m_suppressed) {
+        m_sink.argument(val);
+      }
+    } else if (starts_string()) {
+      const string_ref text = parse_string();
+      if (peek() == '=') {
+        ++m_pos;
+        if (parse_type_annotation()) {
+          skip_node_space();
+        }
+        const raw_value val = parse_value();
+        if (!m_suppressed) {
+          m_sink.property(text, val);
+        }
+      } else if (!m_suppressed) {
+        raw_value val{};
+        val.kind = value::type::string;
+        val.text = text;
+        m_sink.argument(val);
+      }
+    } else {
+      const raw_value val = parse_value();
+      if (!m_suppressed) {
+        m_sink.argument(val);
+      }
+    }
+    if (m_suppressed) {
+      m_sink.truncate(mark);
+    }
+    m_suppressed -= disabled;
+  }
+
+  /**
+   * Parses `(type)` if present and drops it, as parse::dom_handler does.
+   * @return Whether a non-empty type was found.
+   */
+  constexpr bool parse_type_annotation() {
+    if (peek() != '(') {
+      return false;
+    }
+    const std::size_t mark = m_sink.size();
+    ++m_pos;
+    skip_node_space();
+    if (!starts_string()) {
+      fail("expected a type name");
+    }
+    const string_ref type = parse_string();
+    skip_node_space();
+    if (peek() != ')') {
+      fail("expected ')'");
+    }
+    ++m_pos;
+    m_sink.truncate(mark);
+    return type.length > 0;
+  }
+
+  constexpr bool starts_number() const noexcept {
+    const char c = peek();
+    if (c >= '0' && c <= '9') {
+      return true;
+    }
+    if (c == '+' || c == '-') {
+      const char next = peek(1);
+      return (next >= '0' && next <= '9') || (next == '.' && peek(2) >= '0' && peek(2) <= '9');
+    }
+    if (c == '.') {
+      return peek(1) >= '0' && peek(1) <= '9';
+    }
+    return false;
+  }
+
+  constexpr bool starts_string() const {
+    if (at_end() || starts_number()) {
+      return false;
+    }
+    if (peek() == '"') {
+      return true;
+    }
+    if (peek() == '#') {
+      std::size_t i = 0;
+      while (peek(i) == '#') {
+        ++i;
+      }
+      return peek(i) == '"';
+    }
+    std::size_t length = 0;
+    return parse::is_identifier_char(code_point_at(m_pos, length));
+  }
+
+  constexpr raw_value parse_value() {
+    if (at_end()) {
+      fail("expected a value");
+    }
+    if (starts_number()) {
+      return parse_number();
+    }
+    if (peek() == '#' && peek(1) != '#' && peek(1) != '"') {
+      return parse_keyword();
+    }
+    if (!starts_string()) {
+      fail("expected a value");
+    }
+    raw_value val{};
+    val.kind = value::type::string;
+    val.text = parse_string();
+    return val;
+  }
+
+  constexpr raw_value parse_keyword() {
+    const std::size_t start = m_pos;
+    ++m_pos;
+    while (!at_end()) {
+      std::size_t length = 0;
+      if (!parse::is_identifier_char(code_point_at(m_pos, length))) {
+        break;
+      }
+      m_pos += length;
+    }
+    const auto keyword = m_input.substr(start, m_pos - start);
+    raw_value val{};
+    if (keyword == "#true" || keyword == "#false") {
+      val.kind = value::type::boolean;
+      val.boolean = keyword == "#true";
+    } else if (keyword == "#null") {
+      val.kind = value::type::null;
+    } else if (keyword == "#inf" || keyword == "#-inf") {
+      val.kind = value::type::decimal;
+      val.decimal = keyword == "#inf" ? std::numeric_limits<value::decimal>::infinity()
+                                      : -std::numeric_limits<value::decimal>::infinity();
+    } else if (keyword == "#nan") {
+      val.kind = value::type::decimal;
+      val.decimal = std::numeric_limits<value::decimal>::quiet_NaN();
+    } else {
+      fail_at("unknown keyword", start);
+    }
+    return val;
+  }
+
+  constexpr raw_value parse_number() {
+    const std::size_t start = m_pos;
+    const bool negative = peek() == '-';
+    if (peek() == '+' || peek() == '-') {
+      ++m_pos;
+    }
+
+    raw_value val{};
+    if (peek() == '0' && (peek(1) == 'x' || peek(1) == 'o' || peek(1) == 'b')) {
+      const int base = peek(1) == 'x' ? 16 : peek(1) == 'o' ? 8 : 2;
+      m_pos += 2;
+      const std::size_t digits_start = m_pos;
+      if (!scan_digits(base)) {
+        fail_at("expected digits after radix prefix", start);
+      }
+      check_number_end(start);
+      val.kind = value::type::integral;
+      val.integral = to_integral(start, digits_start, base, negative);
+      return val;
+    }
+
+    const std::size_t digits_start = m_pos;
+    bool decimal = false;
+    if (!scan_digits(10)) {
+      fail_at("invalid number", start);
+    }
+    if (peek() == '.') {
+      ++m_pos;
+      decimal = true;
+      if (!scan_digits(10)) {
+        fail_at("expected digits after '.'", start);
+      }
+    }
+    if (peek() == 'e' || peek() == 'E') {
+      ++m_pos;
+      decimal = true;
+      if (peek() == '+' || peek() == '-') {
+        ++m_pos;
+      }
+      if (!scan_digits(10)) {
+        fail_at("expected exponent digits", start);
+      }
+    }
+    check_number_end(start);
+
+    if (!decimal) {
+      val.kind = value::type::integral;
+      val.integral = to_integral(start, digits_start, 10, negative);
+      return val;
+    }
+    val.kind = value::type::decimal;
+    val.decimal = to_decimal(start, digits_start, negative);
+    return val;
+  }
+
+  static constexpr int digit_value(char c) noexcept {
+    return (c >= '0' && c <= '9') ? c - '0'
+         : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+         : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : 99;
+  }
+
+  constexpr bool scan_digits(int base) noexcept {
+    if (digit_value(peek()) >= base) {
+      return false;
+    }
+    ++m_pos;
+    while (digit_value(peek()) < base || peek() == '_') {
+      ++m_pos;
+    }
+    return true;
+  }
+
+  constexpr void check_number_end(std::size_t start) const {
+    if (!at_end() && parse::is_identifier_char(static_cast<unsigned char>(peek()))) {
+      fail_at("invalid number", start);
+    }
+  }
+
+  /// Converts the digits from digits_start to the current position.
+  constexpr value::integral to_integral(std::size_t start, std::size_t digits_start, int base, bool negative) const {
+    const std::uint64_t limit = negative ? std::uint64_t{1} << 63 : (std::uint64_t{1} << 63) - 1;
+    std::uint64_t magnitude = 0;
+    for (std::size_t i = digits_start; i < m_pos; ++i) {
+      if (m_input[i] == '_') {
+        continue;
+      }
+      const auto digit = static_cast<std::uint64_t>(digit_value(m_input[i]));
+      if (magnitude > (limit - digit) / static_cast<std::uint64_t>(base)) {
+        fail_at("integer out of range", start);
+      }
+      magnitude = magnitude * static_cast<std::uint64_t>(base) + digit;
+    }
+    return negative ? static_cast<value::integral>(0 - magnitude) : static_cast<value::integral>(magnitude);
+  }
+
+  /// Converts the decimal from digits_start to the current position.
+  constexpr value::decimal to_decimal(std::size_t start, std::size_t digits_start, bool negative) const {
+    // The significant digits, the first max_digits of them exactly: a
+    // nonzero rest only needs to show up as one more nonzero digit for
+    // the rounding to come out the same.
+    big_integer digits;
+    std::size_t significant = 0;
+    bool dropped = false;
+    long exponent = 0;
+    bool fraction = false;
+    std::size_t i = digits_start;
+    for (; i < m_pos && m_input[i] != 'e' && m_input[i] != 'E'; ++i) {
+      const char c = m_input[i];
+      if (c == '_') {
+        continue;
+      }
+      if (c == '.') {
+        fraction = true;
+        continue;
+      }
+      if (significant < big_integer::max_digits) {
+        digits.multiply_add(10, static_cast<std::uint32_t>(c - '0'));
+        significant += digits.size != 0;
+        exponent -= fraction;
+      } else {
+        dropped = dropped || c != '0';
+        exponent += !fraction;
+      }
+    }
+    if (dropped) {
+      digits.multiply_add(10, 1);
+      ++significant;
+      --exponent;
+    }
+    if (i < m_pos) {
+      ++i;
+      const bool negative_exponent = m_input[i] == '-';
+      i += m_input[i] == '+' || m_input[i] == '-';
+      long written = 0;
+      for (; i < m_pos; ++i) {
+        if (m_input[i] != '_' && written < 100000) {
+          written = written * 10 + (m_input[i] - '0');
+        }
+      }
+      exponent += negative_exponent ? -written : written;
+    }
+
+    if (digits.size == 0) {
+      return negative ? -value::decimal{0} : value::decimal{0};
+    }
+    // The value lies in [10^(significant + exponent - 1), 10^(significant + exponent)).
+    const long magnitude = static_cast<long>(significant) + exponent;
+    if (magnitude > 310 || magnitude < -324) {
+      fail_at("decimal out of range", start);
+    }
+
+    // value = numerator / denominator, rounded as quotient * 2^binary.
+    big_integer numerator = digits;
+    big_integer denominator;
+    denominator.multiply_add(1, 1);
+    if (exponent >= 0) {
+      numerator.multiply_power_of_ten(static_cast<std::size_t>(exponent));
+    } else {
+      denominator.multiply_power_of_ten(static_cast<std::size_t>(-exponent));
+    }
+    long binary = static_cast<long>(numerator.bit_length()) - static_cast<long>(denominator.bit_length()) - 53;
+    std::uint64_t quotient = 0;
+    for (;;) {
+      binary = binary < -1074 ? -1074 : binary;
+      big_integer remainder = numerator;
+      big_integer divisor = denominator;
+      if (binary >= 0) {
+        divisor.shift_left(static_cast<std::size_t>(binary));
+      } else {
+        remainder.shift_left(static_cast<std::size_t>(-binary));
+      }
+      quotient = remainder.divide(divisor);
+      if (quotient >= std::uint64_t{1} << 53) {
+        ++binary;
+        continue;
+      }
+      remainder.shift_left(1);
+      const int half = remainder.compare(divisor);
+      quotient += half > 0 || (half == 0 && (quotient & 1) != 0);
+      if (quotient == std::uint64_t{1} << 53) {
+        quotient >>= 1;
+        ++binary;
+      }
+      break;
+    }
+    if (quotient == 0 || binary > 1023 - 52) {
+      fail_at("decimal out of range", start);
+    }
+
+    // Scaling by powers of two is exact down to the result.
+    value::decimal result = static_cast<value::decimal>(quotient);
+    for (; binary >= 32; binary -= 32) {
+      result *= 0x1p32;
+    }
+    for (; binary <= -32; binary += 32) {
+      result *= 0x1p-32;
+    }
+    for (; binary > 0; --binary) {
+      result *= 2;
+    }
+    for (; binary < 0; ++binary) {
+      result *= 0.5;
+    }
+    return negative ? -result : result;
+  }
+
+  constexpr string_ref parse_string() {
+    const std::size_t offset = m_sink.size();
+    if (peek() == '"') {
+      if (starts_with("\"\"\"")) {
+        parse_multi_line_string(0);
+      } else {
+        parse_quoted_string();
+      }
+    } else if (peek() == '#') {
+      parse_raw_string();
+    } else {
+      parse_identifier();
+    }
+    return string_ref{offset, m_sink.size() - offset};
+  }
+
+  constexpr void put(std::string_view text) {
+    for (const char c : text) {
+      m_sink.put(c);
+    }
+  }
+
+  constexpr void put_utf8(char32_t cp) {
+    if (cp < 0x80) {
+      m_sink.put(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+      m_sink.put(static_cast<char>(0xC0 | (cp >> 6)));
+      m_sink.put(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      m_sink.put(static_cast<char>(0xE0 | (cp >> 12)));
+      m_sink.put(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      m_sink.put(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+      m_sink.put(static_cast<char>(0xF0 | (cp >> 18)));
+      m_sink.put(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+      m_sink.put(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      m_sink.put(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+  }
+
+  constexpr void parse_identifier() {
+    const std::size_t start = m_pos;
+    while (!at_end()) {
+      std::size_t length = 0;
+      if (!parse::is_identifier_char(code_point_at(m_pos, length))) {
+        break;
+      }
+      m_pos += length;
+    }
+    const auto text = m_input.substr(start, m_pos - start);
+    if (text == "true" || text == "false" || text == "null" ||
+        text == "inf" || text == "-inf" || text == "nan") {
+      fail_at("keywords must be written with a leading '#'", start);
+    }
+    put(text);
+  }
+
+  /**
+   * Writes the escape sequence at the current position (after the '\').
+   * A whitespace escape skips white space and newlines up to limit.
+   */
+  constexpr void parse_escape(std::size_t limit) {
+    const char c = peek();
+    switch (c) {
+      case 'n': m_sink.put('\n'); ++m_pos; return;
+      case 'r': m_sink.put('\r'); ++m_pos; return;
+      case 't': m_sink.put('\t'); ++m_pos; return;
+      case 'b': m_sink.put('\b'); ++m_pos; return;
+      case 'f': m_sink.put('\f'); ++m_pos; return;
+      case 's': m_sink.put(' '); ++m_pos; return;
+      case '"': m_sink.put('"'); ++m_pos; return;
+      case '\\': m_sink.put('\\'); ++m_pos; return;
+      case 'u': {
+        if (peek(1) != '{') {
+          fail("expected '{' in unicode escape");
+        }
+        m_pos += 2;
+        char32_t cp = 0;
+        std::size_t count = 0;
+        for (; count < 7 && peek() != '}'; ++count, ++m_pos) {
+          const int digit = digit_value(peek());
+          if (digit > 15) {
+            fail("invalid unicode escape");
+          }
+          cp = cp * 16 + static_cast<char32_t>(digit);
+        }
+        if (count == 0 || count > 6 || peek() != '}' || cp > 0x10FFFF ||
+            (cp >= 0xD800 && cp <= 0xDFFF)) {
+          fail("invalid unicode escape");
+        }
+        ++m_pos;
+        put_utf8(cp);
+        return;
+      }
+      default: {
+        bool skipped = false;
+        while (m_pos < limit) {
+          if (const auto length = whitespace_length(m_pos)) {
+            m_pos += length;
+          } else if (const auto length = newline_length(m_pos)) {
+            m_pos += length;
+          } else {
+            break;
+          }
+          skipped = true;
+        }
+        if (!skipped) {
+          fail("invalid escape sequence");
+        }
+      }
+    }
+  }
+
+  constexpr void parse_quoted_string() {
+    const std::size_t start = m_pos++;
+    for (;;) {
+      if (at_end()) {
+        fail_at("unterminated string", start);
+      }
+      const char c = peek();
+      if (c == '"') {
+        ++m_pos;
+        return;
+      }
+      if (c == '\\') {
+        ++m_pos;
+        parse_escape(m_input.size());
+        continue;
+      }
+      if (newline_length(m_pos)) {
+        fail("newline in single-line string");
+      }
+      std::size_t length = 0;
+      if (parse::is_disallowed(code_point_at(m_pos, length))) {
+        fail("disallowed code point in string");
+      }
+      put(m_input.substr(m_pos, length));
+      m_pos += length;
+    }
+  }
+
+  constexpr void parse_raw_string() {
+    const std::size_t start = m_pos;
+    std::size_t hashes = 0;
+    while (peek() == '#') {
+      ++hashes;
+      ++m_pos;
+    }
+    if (starts_with("\"\"\"")) {
+      parse_multi_line_string(hashes);
+      return;
+    }
+    ++m_pos;
+
+    std::size_t end = m_pos;
+    while (end < m_input.size() && !closes_at(end, 1, hashes)) {
+      ++end;
+    }
+    if (end >= m_input.size()) {
+      fail_at("unterminated raw string", start);
+    }
+    const std::size_t content_start = m_pos;
+    while (m_pos < end) {
+      if (newline_length(m_pos)) {
+        fail("newline in single-line raw string");
+      }
+      std::size_t length = 0;
+      if (parse::is_disallowed(code_point_at(m_pos, length))) {
+        fail("disallowed code point in string");
+      }
+      m_pos += length;
+    }
+    put(m_input.substr(content_start, end - content_start));
+    m_pos = end + 1 + hashes;
+  }
+
+  /// The offset of the newline ending the line that contains pos.
+  constexpr std::size_t line_end(std::size_t pos) const {
+    while (pos < m_input.size() && !newline_length(pos)) {
+      std::size_t length = 0;
+      code_point_at(pos, length);
+      pos += length;
+    }
+    return pos;
+  }
+
+  /**
+   * Parses a `"""` string (raw when hashes > 0). Without a buffer to
+   * dedent into, the lines are first validated and the closing
+   * indentation found, then written without it in a second pass that
+   * interprets escapes on the way, which gives the same text as
+   * escaping after dedenting.
+   */
+  constexpr void parse_multi_line_string(std::size_t hashes) {
+    const std::size_t start = m_pos;
+    m_pos += 3;
+    const auto first_newline = newline_length(m_pos);
+    if (!first_newline) {
+      fail("expected newline after '\"\"\"'");
+    }
+    m_pos += first_newline;
+
+    const std::size_t content_start = m_pos;
+    std::size_t content_end = m_pos;
+    std::size_t indent_start = 0;
+    std::size_t indent_length = 0;
+    for (;;) {
+      const std::size_t line_start = m_pos;
+      while (const auto length = whitespace_length(m_pos)) {
+        m_pos += length;
+      }
+      if (closes_at(m_pos, 3, hashes)) {
+        indent_start = line_start;
+        indent_length = m_pos - line_start;
+        m_pos += 3 + hashes;
+        break;
+      }
+      while (!at_end() && !newline_length(m_pos)) {
+        if (hashes == 0 && peek() == '\\' && !newline_length(m_pos + 1)) {
+          m_pos += 2;
+          continue;
+        }
+        if (closes_at(m_pos, 3, hashes)) {
+          fail("multi-line string delimiter must be on its own line");
+        }
+        std::size_t length = 0;
+        if (parse::is_disallowed(code_point_at(m_pos, length))) {
+          fail("disallowed code point in string");
+        }
+        m_pos += length;
+      }
+      if (at_end()) {
+        fail_at("unterminated multi-line string", start);
+      }
+      content_end = m_pos;
+      m_pos += newline_length(m_pos);
+    }
+    if (indent_start == content_start) {
+      return;
+    }
+
+    const std::size_t end = m_pos;
+    const auto indent = m_input.substr(indent_start, indent_length);
+    const auto dedent = [&](std::size_t line_start) {
+      const std::size_t next = line_end(line_start);
+      if (m_input.substr(line_start, indent.size()) == indent) {
+        return line_start + indent.size();
+      }
+      for (std::size_t i = line_start; i < next; ++i) {
+        if (m_input[i] != ' ' && m_input[i] != '\t') {
+          fail_at("multi-line string line does not match the closing indentation", start);
+        }
+      }
+      return next;
+    };
+
+    std::size_t pos = dedent(content_start);
+    std::size_t next_newline = line_end(pos);
+    for (;;) {
+      if (pos >= next_newline) {
+        if (next_newline >= content_end) {
+          break;
+        }
+        m_sink.put('\n');
+        pos = dedent(next_newline + newline_length(next_newline));
+        next_newline = line_end(pos);
+        continue;
+      }
+      if (hashes == 0 && m_input[pos] == '\\') {
+        m_pos = pos + 1;
+        parse_escape(content_end);
+        pos = m_pos;
+        next_newline = line_end(pos);
+        continue;
+      }
+      m_sink.put(m_input[pos]);
+      ++pos;
+    }
+    m_pos = end;
+  }
+
+  std::string_view m_input;
+  sink_type& m_sink;
+  std::size_t m_pos{0};
+  std::size_t m_suppressed{0};
+};
+
+/// Counts what a document needs, without storing anything.
+class measure_sink {
+public:
+  [[nodiscard]] constexpr std::size_t size() const noexcept {
+    return m_size;
+  }
+
+  constexpr void put(char) noexcept {
+    ++m_size;
+    if (m_size > m_counts.chars) {
+      m_counts.chars = m_size;
+    }
+  }
+
+  constexpr void truncate(std::size_t size) noexcept {
+    m_size = size;
+  }
+
+  constexpr void begin_node(string_ref) noexcept {
+    ++m_counts.nodes;
+  }
+
+  constexpr void argument(const raw_value&) noexcept {
+    ++m_counts.arguments;
+  }
+
+  constexpr void property(string_ref, const raw_value&) noexcept {
+    ++m_counts.properties;
+  }
+
+  constexpr void end_node() noexcept {}
+
+  [[nodiscard]] constexpr counts result() const noexcept {
+    return m_counts;
+  }
+
+private:
+  counts m_counts{};
+  std::size_t m_size{0};
+};
+
+/// Fills the tables of a document measured by measure_sink.
+template <std::size_t node_count, std::size_t argument_count, std::size_t property_count,
+          std::size_t char_count>
+class build_sink {
+public:
+  using tables_type = tables<node_count, argument_count, property_count, char_count>;
+
+  constexpr explicit build_sink(tables_type& target) noexcept : m_tables(target) {}
+
+  [[nodiscard]] constexpr std::size_t size() const noexcept {
+    return m_size;
+  }
+
+  constexpr void put(char c) noexcept {
+    m_tables.chars[m_size++] = c;
+  }
+
+  constexpr void truncate(std::size_t size) noexcept {
+    m_size = size;
+  }
+
+  constexpr void begin_node(string_ref name) noexcept {
+    ++m_tables.nodes[m_current].child_count;
+    node_entry& entry = m_tables.nodes[m_nodes];
+    entry.name = name;
+    entry.parent = m_current;
+    entry.first_argument = m_arguments;
+    entry.first_property = m_properties;
+    m_current = m_nodes++;
+  }
+
+  constexpr void argument(const raw_value& val) noexcept {
+    m_tables.arguments[m_arguments++] = val;
+    ++m_tables.nodes[m_current].argument_count;
+  }
+
+  /// Adds a property, or replaces the value of a property with the same key.
+  constexpr void property(string_ref key, const raw_value& val) noexcept {
+    node_entry& entry = m_tables.nodes[m_current];
+    const std::string_view text{m_tables.chars.data() + key.offset, key.length};
+    for (std::size_t i = entry.first_property; i < entry.first_property + entry.property_count; ++i) {
+      const string_ref other = m_tables.properties[i].key;
+      if (std::string_view{m_tables.chars.data() + other.offset, other.length} == text) {
+        m_tables.properties[i].val = val;
+        return;
+      }
+    }
+    m_tables.properties[m_properties++] = property_entry{key, val};
+    ++entry.property_count;
+  }
+
+  constexpr void end_node() noexcept {
+    m_current = m_tables.nodes[m_current].parent;
+  }
+
+  /// Lays out the child index table, once every node has been added.
+  constexpr void finish() noexcept {
+    std::size_t first = 0;
+    for (std::size_t i = 0; i < m_nodes; ++i) {
+      m_tables.nodes[i].first_child = first;
+      first += m_tables.nodes[i].child_count;
+      m_tables.nodes[i].child_count = 0;
+    }
+    for (std::size_t i = 1; i < m_nodes; ++i) {
+      node_entry& parent = m_tables.nodes[m_tables.nodes[i].parent];
+      m_tables.children[parent.first_child + parent.child_count++] = i;
+    }
+  }
+
+private:
+  tables_type& m_tables;
+  std::size_t m_size{0};
+  std::size_t m_nodes{1};
+  std::size_t m_arguments{0};
+  std::size_t m_properties{0};
+  std::size_t m_current{0};
+};
+
+/**
+ * @brief Validates a document and measures its tables.
+ * @throws kdlcpp::parse_error If the input is not valid KDL.
+ */
+constexpr counts measure(std::string_view input) {
+  measure_sink sink;
+  parser<measure_sink> p{input, sink};
+  p.parse_document();
+  return sink.result();
+}
+
+/// Parses a document measured by measure() into its tables.
+template <std::size_t node_count, std::size_t argument_count, std::size_t property_count,
+          std::size_t char_count>
+constexpr tables<node_count, argument_count, property_count, char_count> build(std::string_view input) {
+  tables<node_count, argument_count, property_count, char_count> result{};
+  build_sink<node_count, argument_count, property_count, char_count> sink{result};
+  parser<decltype(sink)> p{input, sink};
+  p.parse_document();
+  sink.finish();
+  return result;
+}
+
+} // namespace kdlcpp::detail::static_kdl
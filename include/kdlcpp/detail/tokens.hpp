@@ -7,6 +7,9 @@ namespace kdlcpp::detail::tokens {
 constexpr const char* $true  = "#true";
 constexpr const char* $false = "#false";
 constexpr const char* $null  = "#null";
+constexpr const char* $inf   = "#inf";
+constexpr const char* $ninf  = "#-inf";
+constexpr const char* $nan   = "#nan";
 constexpr const char $quote  = '\"';
 constexpr const char $equal  = '=';
 constexpr const char $space  = ' ';
@@ -14,6 +17,9 @@ constexpr const char $lbrace = '{';
 constexpr const char $rbrace = '}';
 constexpr const char $newln  = '\n';
 constexpr const char $slash  = '/';
+constexpr const char $semi   = ';';
+constexpr const char $lparen = '(';
+constexpr const char $rparen = ')';
 
 // clang format on
 
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "kdlcpp/document.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace kdlcpp {
+
+/// A SHA-256 digest.
+using digest_type = std::array<std::uint8_t, 32>;
+
+/**
+ * Computes the SHA-256 digest of the canonical serialization of a node.
+ * The canonical bytes are hashed as they are produced, never stored.
+ * Equal nodes get equal digests, whatever the order their properties
+ * were inserted in, across runs and platforms.
+ * @param node_ The node to hash, with its whole subtree.
+ * @return The digest.
+ */
+[[nodiscard]] digest_type canonical_digest(const node& node_);
+
+/**
+ * Computes the SHA-256 digest of the canonical serialization of a document.
+ * The document name is not part of the canonical bytes.
+ * @param doc The document to hash.
+ * @return The digest.
+ */
+[[nodiscard]] digest_type canonical_digest(const document& doc);
+
+/**
+ * Formats a digest as lowercase hexadecimal.
+ * @param digest The digest to format.
+ * @return A string of 64 hexadecimal digits.
+ */
+[[nodiscard]] string_type to_hex(const digest_type& digest);
+
+} // namespace kdlcpp
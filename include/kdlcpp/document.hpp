@@ -1,6 +1,7 @@
 #pragma once
 
 #include "kdlcpp/node.hpp"
+#include "kdlcpp/serialize_options.hpp"
 
 namespace kdlcpp {
 
@@ -46,12 +47,16 @@ public:
 
   /**
    * Serializes and writes the KDL document to a file.
+   * Subtrees left untouched since the previous write are not formatted
+   * again: their cached bytes are written as they are.
    * @param aPath The path where the document should be written.
+   * @param options The output layout.
+   * @throws std::ios_base::failure If the file cannot be written.
    */
-  void write_to_file(const string_type& filepath);
+  void write_to_file(const string_type& filepath, const serialize_options& options = {});
 
 private:
-  node m_root;
+  node m_root{string_type{}};
   string_type m_document_name;
 };
 
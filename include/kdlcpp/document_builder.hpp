@@ -0,0 +1,94 @@
+#pragma once
+
+#include "kdlcpp/document.hpp"
+
+#include <vector>
+
+namespace kdlcpp {
+
+/**
+ * Builds a document node by node, constructing every node in place in the
+ * children of its parent instead of copying it there:
+ * ```
+ * document_builder builder{1};
+ * builder.begin_node("server", {2, 1, 1}).arg(value{8080}).prop("secure", value{true});
+ * builder.begin_node("route").arg(value{"/"}).end_node();
+ * builder.begin_node("route").arg(value{"/api"}).end_node();
+ * builder.end_node();
+ * document doc = builder.finish();
+ * ```
+ * Size hints reserve the children, arguments and properties of a node up
+ * front, so that adding them does not reallocate and move whole subtrees.
+ * Calls out of order, such as end_node() without an open node, are caught
+ * by assertions in debug builds.
+ */
+class document_builder {
+public:
+  /**
+   * The expected size of the parts of a node. Exceeding a hint is
+   * allowed, at the cost of a reallocation.
+   */
+  struct size_hint {
+    std::size_t children{0};
+    std::size_t arguments{0};
+    std::size_t properties{0};
+  };
+
+  /**
+   * @param top_level_nodes The expected number of top-level nodes.
+   */
+  explicit document_builder(std::size_t top_level_nodes = 0);
+
+  /**
+   * Starts a node, at the top level or as the next child of the current node.
+   * @param name The name of the node.
+   */
+  document_builder& begin_node(string_type name);
+
+  /**
+   * Starts a node, at the top level or as the next child of the current
+   * node, reserving room for its parts.
+   * @param name The name of the node.
+   * @param hint The expected size of its parts.
+   */
+  document_builder& begin_node(string_type name, const size_hint& hint);
+
+  /**
+   * Adds an argument to the current node.
+   * @param val The argument.
+   */
+  document_builder& arg(value val);
+
+  /**
+   * Adds a property to the current node.
+   * @param key The property key.
+   * @param val The property value.
+   */
+  document_builder& prop(string_type key, value val);
+
+  /**
+   * Ends the current node.
+   */
+  document_builder& end_node();
+
+  /**
+   * Gets the number of nodes begun and not ended yet.
+   */
+  [[nodiscard]] std::size_t depth() const noexcept {
+    return m_open.size();
+  }
+
+  /**
+   * Releases the room reserved beyond what every node holds and moves
+   * the nodes out into a document. The builder starts over empty.
+   * Every node must have been ended.
+   * @return The built document.
+   */
+  [[nodiscard]] document finish();
+
+private:
+  document m_document;
+  std::vector<node*> m_open;  // The nodes begun and not ended yet.
+};
+
+} // namespace kdlcpp
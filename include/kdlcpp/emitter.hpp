@@ -0,0 +1,190 @@
+#pragma once
+
+#include "kdlcpp/serialize_options.hpp"
+#include "kdlcpp/stream.hpp"
+#include "kdlcpp/value.hpp"
+#include "kdlcpp/detail/buffered_sink.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+#include "kdlcpp/detail/tokens.hpp"
+
+#include <cassert>
+#include <string_view>
+#include <vector>
+
+namespace kdlcpp {
+
+/**
+ * @brief Writes KDL node by node, without building a document first.
+ *
+ * Calls describe the nodes in document order; each node is written as soon
+ * as its parts are known, so memory stays constant however many nodes are
+ * written, apart from two flags per open node. The output is the same as
+ * detail::serialize::serialize_node() for the equivalent tree and options:
+ * ```
+ * stream<std::ofstream> file{std::ofstream{"out.kdl"}};
+ * emitter<std::ofstream> out{file};
+ * out.begin_node("server").arg(value{8080}).prop("secure", value{true});
+ * out.begin_children();
+ * out.begin_node("route").arg(value{"/"}).end_node();
+ * out.end_node();
+ * out.flush();
+ * ```
+ * Calls out of order, such as an argument after begin_children(), are
+ * caught by assertions in debug builds. Properties are written in call
+ * order, even in the canonical style or with sort_properties set.
+ *
+ * @tparam stream_type The type of the stream wrapped by the destination.
+ */
+template <typename stream_type>
+class emitter {
+public:
+  /**
+   * @param out_stream The destination stream.
+   * @param options The output layout.
+   * @param buffer_size The number of bytes gathered before writing them
+   *        to the destination.
+   */
+  explicit emitter(
+    stream<stream_type>& out_stream, const serialize_options& options = {},
+    std::size_t buffer_size = 64 * 1024)
+    : m_out(detail::buffered_sink<stream_type>{out_stream, buffer_size}), m_options(options) {}
+
+  emitter(const emitter&) = delete;
+  emitter& operator=(const emitter&) = delete;
+
+  /**
+   * Writes what is still buffered. Errors are only reported by flush().
+   */
+  ~emitter() {
+    try {
+      flush();
+    } catch (...) {
+    }
+  }
+
+  /**
+   * @brief Starts a node, at the top level or inside the children
+   *        of the current node.
+   * @param name The name of the node.
+   */
+  emitter& begin_node(std::string_view name) {
+    return begin_node(name, {});
+  }
+
+  /**
+   * @brief Starts a node with a type annotation, at the top level or
+   *        inside the children of the current node.
+   * @param name The name of the node.
+   * @param type The type annotation, written as `(type)` unless empty.
+   */
+  emitter& begin_node(std::string_view name, std::string_view type) {
+    assert(m_open.empty() || m_open.back().children);
+    if (!m_open.empty()) {
+      detail::serialize::serialize_sibling_separator(m_out, m_options, depth(), !m_open.back().has_child);
+      m_open.back().has_child = true;
+    }
+    if (m_options.output_style == serialize_options::style::pretty) {
+      detail::serialize::serialize_indent(m_out, m_options, depth());
+    }
+    if (!type.empty()) {
+      m_out << detail::tokens::$lparen;
+      detail::serialize::serialize_string(m_out, type, true);
+      m_out << detail::tokens::$rparen;
+    }
+    detail::serialize::serialize_string(m_out, name, true);
+    if (m_options.output_style == serialize_options::style::standard) {
+      m_out << detail::tokens::$space;
+    }
+    m_open.push_back(frame{});
+    return *this;
+  }
+
+  /**
+   * @brief Adds an argument to the current node.
+   * @param val The argument.
+   */
+  emitter& arg(const value& val) {
+    assert(!m_open.empty() && !m_open.back().children);
+    item_prefix();
+    detail::serialize::serialize_value(m_out, val, detail::serialize::writes_bare_strings(m_options));
+    item_suffix();
+    return *this;
+  }
+
+  /**
+   * @brief Adds a property to the current node.
+   * @param key The property key.
+   * @param val The property value.
+   */
+  emitter& prop(std::string_view key, const value& val) {
+    assert(!m_open.empty() && !m_open.back().children);
+    item_prefix();
+    detail::serialize::serialize_property(m_out, key, val, detail::serialize::writes_bare_strings(m_options));
+    item_suffix();
+    return *this;
+  }
+
+  /**
+   * @brief Starts the children of the current node: the nodes begun
+   *        next are nested in it until it ends.
+   */
+  emitter& begin_children() {
+    assert(!m_open.empty() && !m_open.back().children);
+    detail::serialize::serialize_children_open(m_out, m_options);
+    m_open.back().children = true;
+    return *this;
+  }
+
+  /**
+   * @brief Ends the current node.
+   */
+  emitter& end_node() {
+    assert(!m_open.empty());
+    const bool children_block = detail::serialize::has_children_block(m_options, m_open.back().children);
+    if (children_block && !m_open.back().children) {
+      detail::serialize::serialize_children_open(m_out, m_options);
+    }
+    m_open.pop_back();
+    detail::serialize::serialize_node_close(m_out, children_block, m_options, depth());
+    return *this;
+  }
+
+  /**
+   * @brief Gets the number of nodes begun and not ended yet.
+   */
+  [[nodiscard]] std::size_t depth() const noexcept {
+    return m_open.size();
+  }
+
+  /**
+   * @brief Writes the buffered bytes to the destination stream.
+   */
+  void flush() {
+    m_out.get().flush();
+  }
+
+private:
+  /// The state of a node begun and not ended yet.
+  struct frame {
+    bool children{false};   // Whether begin_children() was called.
+    bool has_child{false};  // Whether a child node was begun.
+  };
+
+  void item_prefix() {
+    if (m_options.output_style != serialize_options::style::standard) {
+      m_out << detail::tokens::$space;
+    }
+  }
+
+  void item_suffix() {
+    if (m_options.output_style == serialize_options::style::standard) {
+      m_out << detail::tokens::$space;
+    }
+  }
+
+  stream<detail::buffered_sink<stream_type>> m_out;
+  serialize_options m_options;
+  std::vector<frame> m_open;
+};
+
+} // namespace kdlcpp
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "kdlcpp/incremental_document.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace kdlcpp {
+
+/**
+ * A file_watcher monitors KDL files through inotify (Linux only) and
+ * reloads them when they change.
+ *
+ * The parent directory of every file is watched, so that editors that
+ * save by renaming a temporary file are handled as well. Bursts of
+ * events on a file are debounced: the file is reloaded once no event
+ * has been seen for the debounce interval. Reloads go through an
+ * incremental_document, so only the top-level nodes that changed are
+ * parsed again. If the inotify queue overflows and events are lost,
+ * every file is reloaded.
+ *
+ * The watcher is driven by poll() or run(); callbacks are invoked on
+ * the calling thread.
+ */
+class file_watcher {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /// Invoked with the path, the updated document and a change summary.
+  using reload_callback =
+    std::function<void(const string_type&, const document&, const reload_summary&)>;
+
+  /// Invoked with the path when its new content is not valid KDL.
+  /// The previous document is kept.
+  using error_callback = std::function<void(const string_type&, const parse_error&)>;
+
+  /**
+   * Creates the inotify instance.
+   * @param on_reload Callback receiving every reloaded document.
+   * @param debounce Quiet period required before a file is reloaded.
+   * @throws std::system_error If inotify cannot be initialized.
+   */
+  explicit file_watcher(
+    reload_callback on_reload,
+    std::chrono::milliseconds debounce = std::chrono::milliseconds{50});
+
+  file_watcher(const file_watcher&) = delete;
+  file_watcher& operator=(const file_watcher&) = delete;
+  ~file_watcher();
+
+  /**
+   * Sets the callback receiving parse errors.
+   * @param on_error The callback.
+   */
+  void set_error_callback(error_callback on_error);
+
+  /**
+   * Starts watching a file, parsing its current content.
+   * @param path The path of the KDL file.
+   * @return The parsed document.
+   * @throws std::system_error If the file cannot be read or watched.
+   * @throws kdlcpp::parse_error If the file is not valid KDL.
+   */
+  const document& watch(const string_type& path);
+
+  /**
+   * Waits for file changes and reloads the files whose debounce interval
+   * has elapsed. Returns as soon as at least one file was reloaded,
+   * when the timeout expires, or when stop() is called.
+   * @param timeout Maximum time to wait.
+   * @return The number of reloaded files.
+   */
+  std::size_t poll(std::chrono::milliseconds timeout);
+
+  /**
+   * Calls poll() until stop() is called.
+   */
+  void run();
+
+  /**
+   * Makes run() and a pending poll() return. Safe to call from any thread.
+   */
+  void stop() noexcept;
+
+private:
+  struct watched_file {
+    string_type path;
+    incremental_document content;
+    bool pending{false};
+    clock::time_point due{};
+  };
+
+  void read_events(clock::time_point now);
+  bool reload(watched_file& file);
+
+  int m_inotify_fd{-1};
+  int m_wakeup_fd{-1};
+  reload_callback m_on_reload;
+  error_callback m_on_error;
+  std::chrono::milliseconds m_debounce;
+  std::atomic<bool> m_stopping{false};
+
+  /// Watched files, keyed by (directory watch descriptor, file name).
+  std::map<std::pair<int, string_type>, std::unique_ptr<watched_file>> m_files;
+};
+
+} // namespace kdlcpp
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "kdlcpp/document.hpp"
+
+#include <vector>
+
+namespace kdlcpp {
+
+/**
+ * Describes what changed when an incremental_document was updated.
+ * Re-parsed nodes are the top-level nodes in the range
+ * [first_node, first_node + inserted_nodes) of the updated document.
+ */
+struct reload_summary {
+  /// Number of bytes that went through the parser.
+  std::size_t reparsed_bytes{0};
+
+  /// Size of the new text.
+  std::size_t total_bytes{0};
+
+  /// Index of the first re-parsed top-level node.
+  std::size_t first_node{0};
+
+  /// Number of top-level nodes of the previous version that were replaced.
+  std::size_t removed_nodes{0};
+
+  /// Number of top-level nodes that were parsed from the new text.
+  std::size_t inserted_nodes{0};
+
+  /**
+   * @return true if the update changed the document.
+   */
+  [[nodiscard]] bool changed() const noexcept {
+    return removed_nodes != 0 || inserted_nodes != 0;
+  }
+};
+
+/**
+ * An incremental_document keeps a KDL text together with the document
+ * parsed from it, and the byte range each top-level node came from.
+ *
+ * When the text is replaced, only the top-level nodes overlapping the
+ * bytes that differ are parsed again; parsing stops as soon as it is
+ * back in sync with a node boundary of the previous version, and every
+ * other node is kept as is.
+ */
+class incremental_document {
+public:
+  /**
+   * Parses the initial text.
+   * @param text The KDL text.
+   * @throws kdlcpp::parse_error If the text is not valid KDL.
+   */
+  explicit incremental_document(string_type text = {});
+
+  /**
+   * Gets the document parsed from the current text.
+   * @return A const reference to the document.
+   */
+  [[nodiscard]] const document& get() const noexcept;
+
+  /**
+   * Gets the current text.
+   * @return A const reference to the text.
+   */
+  [[nodiscard]] const string_type& text() const noexcept;
+
+  /**
+   * Replaces the text, re-parsing only what changed.
+   * On error the previous text and document are left untouched.
+   * @param text The new KDL text.
+   * @return A summary of the changes.
+   * @throws kdlcpp::parse_error If the new text is not valid KDL.
+   */
+  reload_summary update(string_type text);
+
+private:
+  string_type m_text;
+  document m_document;
+
+  /// End offset of the bytes each top-level node was parsed from,
+  /// leading trivia and terminator included.
+  std::vector<std::size_t> m_node_ends;
+};
+
+} // namespace kdlcpp
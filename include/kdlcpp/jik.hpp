@@ -0,0 +1,349 @@
+#pragma once
+
+#include "kdlcpp/common.hpp"
+#include "kdlcpp/emitter.hpp"
+#include "kdlcpp/serialize_options.hpp"
+#include "kdlcpp/stream.hpp"
+#include "kdlcpp/value.hpp"
+#include "kdlcpp/detail/buffered_sink.hpp"
+#include "kdlcpp/detail/json.hpp"
+#include "kdlcpp/detail/parse.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace kdlcpp {
+
+/**
+ * @brief Thrown when a KDL document is valid KDL but not valid JSON-in-KDL,
+ *        or holds a value JSON cannot represent.
+ */
+class jik_error : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+namespace detail::jik {
+
+/**
+ * @brief Parser event handler that writes the JSON value described by
+ *        a JSON-in-KDL document.
+ *
+ * Whether a node is a literal, an array or an object is only known from
+ * its content, so each open node keeps at most its first argument until
+ * the next event settles it. Memory does not depend on the number of
+ * nodes, arguments or properties.
+ *
+ * @tparam stream_type The type of the stream wrapped by the destination.
+ */
+template <typename stream_type>
+class json_handler {
+public:
+  explicit json_handler(stream<stream_type>& out_stream) noexcept : m_out(out_stream) {}
+
+  void begin_node(string_type name, string_type type) {
+    if (m_open.empty()) {
+      if (m_done) {
+        throw jik_error{"a JSON-in-KDL document has a single top-level node"};
+      }
+    } else {
+      frame& parent = m_open.back();
+      if (parent.current == shape::undecided) {
+        const bool array = parent.annotation == shape::array ||
+          (parent.annotation != shape::object && (parent.pending || name == "-"));
+        open(parent, array ? shape::array : shape::object);
+      }
+      if (parent.current == shape::array) {
+        if (name != "-") {
+          throw jik_error{"array elements must be nodes named '-', found '" + name + "'"};
+        }
+        separator(parent);
+      } else {
+        separator(parent);
+        json::serialize_string(m_out, name);
+        m_out << ':';
+      }
+    }
+    m_open.push_back(frame{annotation_of(type), shape::undecided, false, false, value{}});
+  }
+
+  void argument(value val, string_type /*type*/) {
+    frame& current = m_open.back();
+    if (current.current == shape::undecided) {
+      if (current.annotation == shape::undecided && !current.pending) {
+        current.first = std::move(val);
+        current.pending = true;
+        return;
+      }
+      open(current, shape::array);
+    }
+    if (current.current == shape::object) {
+      throw jik_error{"object nodes cannot have arguments"};
+    }
+    separator(current);
+    write_value(val);
+  }
+
+  void property(string_type key, value val, string_type /*type*/) {
+    frame& current = m_open.back();
+    if (current.current == shape::undecided) {
+      open(current, shape::object);
+    }
+    if (current.current == shape::array) {
+      throw jik_error{"array nodes cannot have properties"};
+    }
+    separator(current);
+    json::serialize_string(m_out, key);
+    m_out << ':';
+    write_value(val);
+  }
+
+  void begin_children() {}
+
+  void end_children() {}
+
+  void end_node() {
+    frame& current = m_open.back();
+    if (current.current == shape::undecided) {
+      if (current.pending) {
+        write_value(current.first);
+      } else if (current.annotation == shape::undecided) {
+        throw jik_error{"empty nodes are ambiguous; annotate them with (array) or (object)"};
+      } else {
+        open(current, current.annotation);
+      }
+    }
+    if (current.current == shape::array) {
+      m_out << ']';
+    } else if (current.current == shape::object) {
+      m_out << '}';
+    }
+    m_open.pop_back();
+    m_done = m_open.empty();
+  }
+
+  /**
+   * @brief Checks that the document described a value.
+   */
+  void finish() const {
+    if (!m_done) {
+      throw jik_error{"a JSON-in-KDL document needs a top-level node"};
+    }
+  }
+
+private:
+  enum class shape { undecided, array, object };
+
+  /// The state of a node begun and not ended yet.
+  struct frame {
+    shape annotation{shape::undecided};  // From an (array) or (object) annotation.
+    shape current{shape::undecided};     // What was written for the node so far.
+    bool pending{false};                 // Whether `first` holds an unwritten argument.
+    bool has_item{false};                // Whether an element or member was written.
+    value first;
+  };
+
+  static shape annotation_of(const string_type& type) noexcept {
+    if (type == "array") {
+      return shape::array;
+    }
+    if (type == "object") {
+      return shape::object;
+    }
+    return shape::undecided;
+  }
+
+  /// Writes the opening of a node settled as an array or an object,
+  /// followed by the argument it kept, if any.
+  void open(frame& node_frame, shape kind) {
+    if (node_frame.annotation != shape::undecided && node_frame.annotation != kind) {
+      throw jik_error{kind == shape::array
+        ? "(object) nodes cannot have arguments or elements"
+        : "(array) nodes cannot have properties or members"};
+    }
+    if (kind == shape::object && node_frame.pending) {
+      throw jik_error{"nodes cannot have both arguments and properties or members"};
+    }
+    node_frame.current = kind;
+    m_out << (kind == shape::array ? '[' : '{');
+    if (node_frame.pending) {
+      write_value(node_frame.first);
+      node_frame.pending = false;
+      node_frame.has_item = true;
+    }
+  }
+
+  void separator(frame& node_frame) {
+    if (node_frame.has_item) {
+      m_out << ',';
+    }
+    node_frame.has_item = true;
+  }
+
+  void write_value(const value& val) {
+    if (const auto text = val.get<value::string>()) {
+      json::serialize_string(m_out, *text);
+      return;
+    }
+    if (const auto number = val.get<value::decimal>(); number && !std::isfinite(*number)) {
+      throw jik_error{"JSON cannot represent #inf, #-inf or #nan"};
+    }
+    switch (val.get_type()) {
+      case value::type::null:
+        m_out << "null";
+        break;
+      case value::type::boolean:
+        m_out << (*val.get<value::boolean>() ? "true" : "false");
+        break;
+      default:
+        serialize::serialize_value(m_out, val);
+        break;
+    }
+  }
+
+  stream<stream_type>& m_out;
+  std::vector<frame> m_open;
+  bool m_done{false};
+};
+
+/**
+ * @brief JSON reader event handler that writes the equivalent JSON-in-KDL
+ *        document through an emitter.
+ *
+ * Arrays and objects are always annotated with `(array)` and `(object)`,
+ * since whether the annotation is needed, for single-element arrays or
+ * empty containers, is not known when the node starts. Scalar elements
+ * of an array are written as arguments until its first nested container;
+ * the elements after it are written as `-` children.
+ *
+ * @tparam stream_type The type of the stream wrapped by the destination.
+ */
+template <typename stream_type>
+class kdl_handler {
+public:
+  explicit kdl_handler(emitter<stream_type>& out) noexcept : m_out(out) {}
+
+  void begin_object() {
+    begin_child("object");
+    m_open.push_back(frame{false});
+  }
+
+  void key(string_type key) {
+    m_key = std::move(key);
+  }
+
+  void end_object() {
+    end_container();
+  }
+
+  void begin_array() {
+    begin_child("array");
+    m_open.push_back(frame{true});
+  }
+
+  void end_array() {
+    end_container();
+  }
+
+  void scalar(value val) {
+    if (!m_open.empty() && m_open.back().array && !m_open.back().children) {
+      m_out.arg(val);
+      return;
+    }
+    begin_child({});
+    m_out.arg(val);
+    m_out.end_node();
+  }
+
+private:
+  /// The state of an array or object begun and not ended yet.
+  struct frame {
+    bool array;
+    bool children{false};  // Whether the children block of its node was begun.
+  };
+
+  void begin_child(std::string_view type) {
+    if (m_open.empty()) {
+      m_out.begin_node("-", type);
+      return;
+    }
+    frame& parent = m_open.back();
+    if (!parent.children) {
+      m_out.begin_children();
+      parent.children = true;
+    }
+    m_out.begin_node(parent.array ? std::string_view{"-"} : std::string_view{m_key}, type);
+  }
+
+  void end_container() {
+    m_open.pop_back();
+    m_out.end_node();
+  }
+
+  emitter<stream_type>& m_out;
+  std::vector<frame> m_open;
+  string_type m_key;
+};
+
+} // namespace detail::jik
+
+/**
+ * @brief Converts a JSON-in-KDL document to JSON.
+ *
+ * The KDL text is parsed event by event and the JSON is written as the
+ * events arrive, through a buffer of the given size: no tree is built,
+ * and besides the input the memory used only grows with the nesting
+ * depth. The input itself must be in memory as a whole; map large files
+ * rather than reading them into a string. The output is JSON without
+ * insignificant white space.
+ *
+ * @param input The KDL text, holding a single top-level node.
+ * @param out_stream The destination stream.
+ * @param buffer_size The number of bytes gathered before writing them
+ *        to the destination.
+ * @throws kdlcpp::parse_error If the input is not valid KDL.
+ * @throws kdlcpp::jik_error If the input is not valid JSON-in-KDL.
+ */
+template <typename stream_type>
+void kdl_to_json(std::string_view input, stream<stream_type>& out_stream,
+                 std::size_t buffer_size = 64 * 1024) {
+  using sink_type = detail::buffered_sink<stream_type>;
+  stream<sink_type> sink{sink_type{out_stream, buffer_size}};
+  detail::jik::json_handler<sink_type> handler{sink};
+  detail::parse::parser<detail::jik::json_handler<sink_type>> p{input, handler};
+  p.parse_document();
+  handler.finish();
+  sink.get().flush();
+}
+
+/**
+ * @brief Converts JSON to a JSON-in-KDL document.
+ *
+ * The JSON text is read event by event and written through an emitter:
+ * no tree is built, and besides the input the memory used only grows
+ * with the nesting depth. The input must be in memory as a whole; map
+ * large files rather than reading them into a string. kdl_to_json()
+ * reads the output back to the same JSON value.
+ *
+ * @param input The JSON text.
+ * @param out_stream The destination stream.
+ * @param options The layout of the KDL output.
+ * @param buffer_size The number of bytes gathered before writing them
+ *        to the destination.
+ * @throws kdlcpp::parse_error If the input is not valid JSON.
+ */
+template <typename stream_type>
+void json_to_kdl(std::string_view input, stream<stream_type>& out_stream,
+                 const serialize_options& options = {serialize_options::style::pretty},
+                 std::size_t buffer_size = 64 * 1024) {
+  emitter<stream_type> out{out_stream, options, buffer_size};
+  detail::jik::kdl_handler<stream_type> handler{out};
+  detail::json::reader<detail::jik::kdl_handler<stream_type>> r{input, handler};
+  r.parse();
+  out.flush();
+}
+
+} // namespace kdlcpp
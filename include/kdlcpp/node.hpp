@@ -3,11 +3,18 @@
 #include "kdlcpp/arguments.hpp"
 #include "kdlcpp/properties.hpp"
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace kdlcpp {
 
+namespace detail::parse {
+class dom_handler;
+} // namespace detail::parse
+
 class node;
+class document_builder;
 using node_list = std::vector<node>;
 
 /**
@@ -24,13 +31,33 @@ public:
   /**
    * A node must at least have a name.
    */
-  node(const string_type& name) : m_name(name) {}
+  node(const string_type& name);
+
+  /**
+   * A node must at least have a name, which is moved in.
+   */
+  node(string_type&& name);
+
+  /**
+   * Copies a node. The copy is detached from any parent.
+   */
+  node(const node& other);
+
+  /**
+   * Moves a node. The new node is detached from any parent.
+   */
+  node(node&& other) noexcept;
+
+  node& operator=(const node& other);
+  node& operator=(node&& other) noexcept;
+
+  ~node();
 
   /**
    * Gets the name of the node.
-   * @return A string representing the node's name.
+   * @return A const reference to the node's name.
    */
-  [[nodiscard]] string_type get_name() const noexcept;
+  [[nodiscard]] const string_type& get_name() const noexcept;
 
   /**
    * Gets the list of arguments passed to this node.
@@ -45,34 +72,135 @@ public:
   [[nodiscard]] const properties& get_properties() const noexcept;
 
   /**
-   * Gets the child nodes of this node.
+   * Gets the child nodes of this node, parsing them first if they were
+   * deferred. Concurrent calls parse them only once.
    * @return A const reference to the list of child nodes.
+   * @throws kdlcpp::parse_error If deferred children are not valid KDL.
    */
-  [[nodiscard]] const node_list& get_children() const noexcept;
+  [[nodiscard]] const node_list& get_children() const;
 
   /**
-   * Gets a modifiable reference to the node's arguments.
+   * Gets a modifiable reference to the node's arguments, copying
+   * the content of a shared node first.
    * @return A reference to the kdlcpp::Arguments object.
    */
-  [[nodiscard]] arguments& get_arguments() noexcept;
+  [[nodiscard]] arguments& get_arguments();
 
   /**
-   * Gets a modifiable reference to the node's properties.
+   * Gets a modifiable reference to the node's properties, copying
+   * the content of a shared node first.
    * @return A reference to the kdlcpp::Properties object.
    */
-  [[nodiscard]] properties& get_properties() noexcept;
+  [[nodiscard]] properties& get_properties();
 
   /**
-   * Gets a modifiable reference to the list of child nodes.
+   * Gets a modifiable reference to the list of child nodes,
+   * parsing them first if they were deferred. The list may be moved
+   * out or swapped: the children are attached to this node again
+   * only when it is next cached.
    * @return A reference to the list of child nodes.
+   * @throws kdlcpp::parse_error If deferred children are not valid KDL.
+   */
+  [[nodiscard]] node_list& get_children();
+
+  /**
+   * Checks whether the node, or any node below it, may have been modified
+   * since its serialized bytes were last cached. Every mutable accessor
+   * marks the node and all of its ancestors dirty.
+   * @return true if the cached bytes are stale.
+   */
+  [[nodiscard]] bool is_dirty() const noexcept;
+
+  /**
+   * Gets the bytes cached by the last set_serialized() call.
+   * Only meaningful while the node is not dirty.
+   * @return A const reference to the cached bytes.
+   */
+  [[nodiscard]] const string_type& get_serialized() const noexcept;
+
+  /**
+   * Gets the format tag given to the last set_serialized() call.
+   * @return The tag identifying the layout of the cached bytes.
+   */
+  [[nodiscard]] std::uint64_t get_serialized_format() const noexcept;
+
+  /**
+   * Caches the serialized bytes of the whole subtree and marks the node clean.
+   * Children are expected to be clean already.
+   * @param bytes The serialized bytes.
+   * @param format A tag identifying the layout the bytes were written with.
    */
-  [[nodiscard]] node_list& get_children() noexcept;
+  void set_serialized(string_type bytes, std::uint64_t format = 0) noexcept;
+
+  /**
+   * Defers parsing the children of this node until they are first accessed.
+   * Used by the lazy parser; any current children are replaced.
+   * @param source The whole KDL text, shared by the nodes deferred from it.
+   * @param offset The offset right after the `{` of the children block.
+   */
+  void defer_children(std::shared_ptr<const string_type> source, std::size_t offset) noexcept;
+
+  /**
+   * Checks whether the children of this node have not been parsed yet.
+   * @return true if the children are still deferred.
+   */
+  [[nodiscard]] bool has_deferred_children() const noexcept;
+
+  /**
+   * Turns this node into a reference to an immutable node with the same
+   * content, so that identical subtrees are stored once. Const accessors
+   * read the shared node; the first mutable access copies it back.
+   * @param target The shared node.
+   */
+  void share(std::shared_ptr<const node> target) noexcept;
+
+  /**
+   * Gets the immutable node this node refers to.
+   * @return The shared node, or nullptr if the node owns its content.
+   */
+  [[nodiscard]] const std::shared_ptr<const node>& get_shared() const noexcept;
 
 private:
+  friend class detail::parse::dom_handler;
+  friend class kdlcpp::document_builder;
+
+  struct deferred_block;
+
+  /**
+   * Appends a child to a node being built, which is neither shared nor
+   * deferred, without handing out the list.
+   * @param child The child to append.
+   * @return A reference to the appended child.
+   */
+  node& append_child(node&& child);
+
+  /// Parses the deferred children, once.
+  void materialize_children() const;
+
+  /// Copies the shared content back into this node, if it refers to one.
+  void unshare();
+
+  /// Marks this node and its ancestors dirty.
+  void mark_dirty() noexcept;
+
+  /// Makes the children report modifications to this node.
+  void adopt_children() const noexcept;
+
+  /// Stops the children from reporting modifications to this node.
+  void release_children() noexcept;
+
   string_type m_name;
   arguments m_arguments;
   properties m_properties;
-  node_list m_children;
+  mutable node_list m_children;              // Filled on first access when deferred.
+  std::unique_ptr<deferred_block> m_deferred;  // Children block not parsed yet.
+  std::shared_ptr<const node> m_shared;        // Content, when shared with other nodes.
+
+  node* m_parent{nullptr};     // Parent to notify, set while the parent is cached.
+  mutable bool m_linked{false};  // Whether the children report to this node.
+  bool m_dirty{true};          // Whether m_serialized is stale.
+  string_type m_serialized;    // Cached bytes of the whole subtree.
+  std::uint64_t m_format{0};   // Layout of the cached bytes.
 };
 
 } // namespace kdlcpp
\ No newline at end of file
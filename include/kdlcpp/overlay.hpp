@@ -0,0 +1,145 @@
+#pragma once
+
+#include "kdlcpp/document.hpp"
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace kdlcpp {
+
+/**
+ * A node of an overlay: the nodes of every layer that sit at the same
+ * place in the tree, seen as one node. Lookups are resolved on the layer
+ * nodes when asked, without copying them:
+ * - Properties are merged, the highest layer setting a key winning.
+ * - Arguments come whole from the highest layer giving any; a layer node
+ *   without arguments keeps those of the layers below.
+ * - Children are merged by name: the n-th child with a given name of a
+ *   layer node merges with the n-th child with that name of the others.
+ *
+ * An overlay node refers to the layer nodes: it is invalidated by any
+ * change to the children of their parents.
+ */
+class overlay_node {
+public:
+  /**
+   * Builds a node out of layer nodes.
+   * @param layers The layer nodes, from the lowest to the highest layer.
+   */
+  explicit overlay_node(std::vector<const node*> layers) noexcept;
+
+  /**
+   * Gets the name of the node, the same in every layer.
+   * @return A const reference to the node's name.
+   */
+  [[nodiscard]] const string_type& get_name() const noexcept;
+
+  /**
+   * Gets the arguments of the highest layer node that has any.
+   * @return A const reference to the arguments, empty if no layer has any.
+   */
+  [[nodiscard]] const arguments& get_arguments() const noexcept;
+
+  /**
+   * Checks whether any layer node has a property with a certain key.
+   * @param key The key of the property.
+   * @return true if the property exists in some layer.
+   */
+  [[nodiscard]] bool has_property(const string_type& key) const noexcept;
+
+  /**
+   * Gets the value of a property from the highest layer node setting it.
+   * @param key The key of the property.
+   * @return The value, if some layer sets the key.
+   */
+  [[nodiscard]] std::optional<value> get_property(const string_type& key) const noexcept;
+
+  /**
+   * Merges the properties of every layer node into a copy.
+   * @return The effective properties of the node.
+   */
+  [[nodiscard]] properties get_properties() const;
+
+  /**
+   * Finds a child by name, merging it across the layers.
+   * @param name The name of the child.
+   * @param occurrence Which of the children with this name, from 0.
+   * @return The child, if some layer node has it.
+   * @throws kdlcpp::parse_error If deferred children are not valid KDL.
+   */
+  [[nodiscard]] std::optional<overlay_node> get_child(std::string_view name, std::size_t occurrence = 0) const;
+
+  /**
+   * Gets every child, merged across the layers. Children come in the order
+   * of the lowest layer having them, then those only higher layers have.
+   * @return The children.
+   * @throws kdlcpp::parse_error If deferred children are not valid KDL.
+   */
+  [[nodiscard]] std::vector<overlay_node> get_children() const;
+
+  /**
+   * Gets the layer nodes making up this node.
+   * @return The nodes, from the lowest to the highest layer.
+   */
+  [[nodiscard]] const std::vector<const node*>& get_layers() const noexcept;
+
+  /**
+   * Copies the effective content of the node and its descendants into a
+   * standalone node.
+   * @return The merged node.
+   * @throws kdlcpp::parse_error If deferred children are not valid KDL.
+   */
+  [[nodiscard]] node materialize() const;
+
+private:
+  std::vector<const node*> m_layers;  // The nodes merged, lowest layer first.
+};
+
+/**
+ * Several documents seen as one, the higher layers overriding the lower
+ * ones as described in kdlcpp::overlay_node. Nothing is merged up front:
+ * adding or replacing a layer costs nothing, and lookups go through the
+ * layers as they are, so the documents must outlive the overlay. Use
+ * materialize() to get the merged document once.
+ */
+class overlay {
+public:
+  /**
+   * Adds a document above the current layers.
+   * @param layer The document, which must outlive the overlay.
+   */
+  void push_layer(const document& layer);
+
+  /**
+   * Replaces a layer, for example with a document just reloaded.
+   * @param index The layer to replace, 0 being the lowest.
+   * @param layer The document, which must outlive the overlay.
+   * @throws std::out_of_range If there is no such layer.
+   */
+  void replace_layer(std::size_t index, const document& layer);
+
+  /**
+   * Gets the number of layers.
+   * @return The number of documents in the overlay.
+   */
+  [[nodiscard]] std::size_t layer_count() const noexcept;
+
+  /**
+   * Gets the root node of the overlay, merging the roots of the layers.
+   * @return The root node, with no layers if the overlay is empty.
+   */
+  [[nodiscard]] overlay_node root() const;
+
+  /**
+   * Copies the effective content of the layers into a standalone document.
+   * @return The merged document, named after the highest layer.
+   * @throws kdlcpp::parse_error If deferred children are not valid KDL.
+   */
+  [[nodiscard]] document materialize() const;
+
+private:
+  std::vector<const document*> m_layers;  // Lowest layer first.
+};
+
+} // namespace kdlcpp
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "kdlcpp/document.hpp"
+#include "kdlcpp/node.hpp"
+#include "kdlcpp/thread_pool.hpp"
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace kdlcpp {
+
+namespace detail::parallel {
+
+/**
+ * @brief Appends the number of nodes of every subtree, in pre-order.
+ *
+ * Lazily parsed children are parsed on the way.
+ *
+ * @return The number of nodes of the subtree of root.
+ */
+inline std::size_t count_subtrees(const node& root, std::vector<std::size_t>& sizes) {
+  const std::size_t index = sizes.size();
+  sizes.push_back(0);
+  std::size_t total = 1;
+  for (const auto& child : root.get_children()) {
+    total += count_subtrees(child, sizes);
+  }
+  sizes[index] = total;
+  return total;
+}
+
+/// The result of visitors that only have side effects.
+struct no_result {};
+
+/**
+ * @brief Maps every node of a tree and folds the results, splitting the
+ *        tree into tasks of about `grain` nodes.
+ *
+ * A subtree larger than the grain gets its own task, which splits it
+ * again; consecutive smaller siblings are gathered into tasks until they
+ * add up to the grain. Whatever the split, the results are folded as the
+ * sequential recursion would:
+ * `fold(n) = reduce(...reduce(map(n), fold(c1))..., fold(ck))`.
+ *
+ * A node is mapped before its children are scheduled. With mutable
+ * nodes, taking their children marks them dirty first, so that the
+ * children, marked from other threads, never walk past their parent.
+ *
+ * @tparam node_type node or const node.
+ */
+template <typename node_type, typename map_type, typename reduce_type>
+class tree_reduction {
+public:
+  using result_type = std::decay_t<std::invoke_result_t<map_type&, node_type&>>;
+
+  tree_reduction(
+    thread_pool& pool, map_type& map, reduce_type& reduce, const node& root, std::size_t grain)
+    : m_pool(pool), m_map(map), m_reduce(reduce), m_grain(grain > 0 ? grain : 1) {
+    count_subtrees(root, m_sizes);
+  }
+
+  /// Folds the whole tree, root included.
+  result_type fold(node_type& root) {
+    return visit(root, 0);
+  }
+
+  /// Folds the subtrees of the children of root into a first value.
+  result_type fold_children(node_type& root, result_type first) {
+    return visit_children(root, 0, std::move(first));
+  }
+
+private:
+  result_type visit(node_type& current, std::size_t index) {
+    return visit_children(current, index, m_map(current));
+  }
+
+  result_type visit_children(node_type& current, std::size_t index, result_type result) {
+    auto& children = current.get_children();
+    if (m_sizes[index] <= m_grain || m_pool.size() < 2) {
+      for (auto& child : children) {
+        result = m_reduce(std::move(result), visit_sequential(child));
+      }
+      return result;
+    }
+
+    std::vector<std::optional<result_type>> slots(children.size());
+    {
+      task_group group{m_pool};
+      std::size_t child = 0;
+      std::size_t child_index = index + 1;
+      while (child < children.size()) {
+        const std::size_t first = child;
+        const std::size_t first_index = child_index;
+        std::size_t total = 0;
+        do {
+          total += m_sizes[child_index];
+          child_index += m_sizes[child_index];
+          ++child;
+        } while (child < children.size() && total < m_grain && m_sizes[child_index] < m_grain);
+
+        group.run([this, &children, &slots, first, last = child, first_index] {
+          std::size_t range_index = first_index;
+          for (std::size_t i = first; i < last; ++i) {
+            slots[i].emplace(visit(children[i], range_index));
+            range_index += m_sizes[range_index];
+          }
+        });
+      }
+      group.wait();
+    }
+
+    for (auto& slot : slots) {
+      result = m_reduce(std::move(result), std::move(*slot));
+    }
+    return result;
+  }
+
+  result_type visit_sequential(node_type& current) {
+    result_type result = m_map(current);
+    for (auto& child : current.get_children()) {
+      result = m_reduce(std::move(result), visit_sequential(child));
+    }
+    return result;
+  }
+
+  thread_pool& m_pool;
+  map_type& m_map;
+  reduce_type& m_reduce;
+  std::size_t m_grain;
+  std::vector<std::size_t> m_sizes;
+};
+
+template <typename node_type, typename function_type>
+void for_each(thread_pool& pool, node_type& root, function_type& function, std::size_t grain, bool with_root) {
+  auto map = [&function](node_type& current) {
+    function(current);
+    return no_result{};
+  };
+  auto reduce = [](no_result, no_result) { return no_result{}; };
+  tree_reduction<node_type, decltype(map), decltype(reduce)> reduction{pool, map, reduce, root, grain};
+  if (with_root) {
+    reduction.fold(root);
+  } else {
+    reduction.fold_children(root, no_result{});
+  }
+}
+
+} // namespace detail::parallel
+
+/**
+ * Calls a function on every node of a subtree, root included, from the
+ * threads of a pool. The tree is split into tasks of about `grain` nodes
+ * by subtree size, so wide and deep trees are both spread over the pool.
+ * A node is visited before its children; the order of other visits is
+ * unspecified.
+ * @param pool The pool running the visits.
+ * @param root The root of the subtree.
+ * @param function Called with each `const node&`, possibly concurrently.
+ * @param grain The number of nodes below which a subtree is visited by a
+ *        single task.
+ * @throws The first exception thrown by the function, once the visits
+ *         already started have finished.
+ */
+template <typename function_type>
+void parallel_for_each_node(thread_pool& pool, const node& root, function_type function,
+                            std::size_t grain = 1024) {
+  detail::parallel::for_each(pool, root, function, grain, true);
+}
+
+/**
+ * Calls a function on every node of a document from the threads of a pool.
+ * @see parallel_for_each_node(thread_pool&, const node&, function_type, std::size_t)
+ */
+template <typename function_type>
+void parallel_for_each_node(thread_pool& pool, const document& doc, function_type function,
+                            std::size_t grain = 1024) {
+  detail::parallel::for_each(pool, doc.root(), function, grain, false);
+}
+
+/**
+ * Modifies every node of a subtree, root included, from the threads of a
+ * pool, split as parallel_for_each_node() does. The function may change
+ * the name, arguments and properties of the node it is given, but must
+ * not add or remove nodes. Every node of the subtree is marked dirty.
+ * @param pool The pool running the visits.
+ * @param root The root of the subtree.
+ * @param function Called with each `node&`, possibly concurrently.
+ * @param grain The number of nodes below which a subtree is visited by a
+ *        single task.
+ * @throws The first exception thrown by the function, once the visits
+ *         already started have finished.
+ */
+template <typename function_type>
+void parallel_transform(thread_pool& pool, node& root, function_type function,
+                        std::size_t grain = 1024) {
+  detail::parallel::for_each(pool, root, function, grain, true);
+}
+
+/**
+ * Modifies every node of a document from the threads of a pool.
+ * @see parallel_transform(thread_pool&, node&, function_type, std::size_t)
+ */
+template <typename function_type>
+void parallel_transform(thread_pool& pool, document& doc, function_type function,
+                        std::size_t grain = 1024) {
+  detail::parallel::for_each(pool, doc.root(), function, grain, false);
+}
+
+/**
+ * Maps every node of a subtree, root included, from the threads of a
+ * pool, and folds the results. The fold is deterministic: whatever the
+ * number of threads, the grain or the scheduling, it is the one of the
+ * sequential recursion
+ * `fold(n) = reduce(...reduce(transform(n), fold(c1))..., fold(ck))`,
+ * and the result is `reduce(init, fold(root))`. The reduction therefore
+ * needs to be neither associative nor commutative.
+ * @param pool The pool running the visits.
+ * @param root The root of the subtree.
+ * @param init The value the result of the tree is folded into.
+ * @param transform Maps each `const node&` to a result_type, possibly concurrently.
+ * @param reduce Folds two result_type values, possibly concurrently.
+ * @param grain The number of nodes below which a subtree is visited by a
+ *        single task.
+ * @return The folded result.
+ */
+template <typename result_type, typename transform_type, typename reduce_type>
+[[nodiscard]] result_type parallel_transform_reduce(
+  thread_pool& pool, const node& root, result_type init, transform_type transform,
+  reduce_type reduce, std::size_t grain = 1024) {
+  auto map = [&transform](const node& current) -> result_type { return transform(current); };
+  detail::parallel::tree_reduction<const node, decltype(map), reduce_type> reduction{
+    pool, map, reduce, root, grain};
+  return reduce(std::move(init), reduction.fold(root));
+}
+
+/**
+ * Maps every node of a document from the threads of a pool and folds the
+ * results, top-level nodes in order: the result is
+ * `reduce(...reduce(init, fold(n1))..., fold(nk))`.
+ * @see parallel_transform_reduce(thread_pool&, const node&, result_type, transform_type, reduce_type, std::size_t)
+ */
+template <typename result_type, typename transform_type, typename reduce_type>
+[[nodiscard]] result_type parallel_transform_reduce(
+  thread_pool& pool, const document& doc, result_type init, transform_type transform,
+  reduce_type reduce, std::size_t grain = 1024) {
+  auto map = [&transform](const node& current) -> result_type { return transform(current); };
+  detail::parallel::tree_reduction<const node, decltype(map), reduce_type> reduction{
+    pool, map, reduce, doc.root(), grain};
+  return reduction.fold_children(doc.root(), std::move(init));
+}
+
+} // namespace kdlcpp
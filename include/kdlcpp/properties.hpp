@@ -72,6 +72,26 @@ public:
    */
   void insert(const string_type& key, const value& val) noexcept;
 
+  /**
+   * Sets a certain key with a specific kdlcpp::Value, moving both in.
+   * Overwrites the existing property with the same key, if present.
+   * @param key The key of the property to set.
+   * @param val The value of the property to be set.
+   */
+  void insert(string_type&& key, value&& val) noexcept;
+
+  /**
+   * Reserves room for a number of properties, so that inserting them
+   * does not rehash.
+   * @param count The number of properties to make room for.
+   */
+  void reserve(std::size_t count);
+
+  /**
+   * Releases the buckets not needed by the current properties.
+   */
+  void shrink_to_fit();
+
   /**
    * Removes a property with a certain key.
    * @param key The key of the property to remove.
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kdlcpp {
+
+/**
+ * Options controlling the layout of serialized KDL.
+ * Every style is read back to the same nodes.
+ */
+struct serialize_options {
+  /**
+   * The layout of the output.
+   */
+  enum class style {
+    standard,  // Every node gets a children block; items are followed by a space.
+    compact,   // No empty blocks or extra white space; children separated by `;`.
+    pretty,    // One node per line, children indented, no empty blocks.
+    canonical  // The compact layout with sorted properties and bare identifier
+               // strings: equal documents are written to the same bytes.
+  };
+
+  style output_style{style::standard};
+
+  /// Number of indent_char written per nesting level in the pretty style.
+  std::size_t indent{4};
+
+  /// The indentation character, either ' ' or '\t'.
+  char indent_char{' '};
+
+  /// Whether properties are written sorted by key in every style, rather
+  /// than in the order of the map. The canonical style always sorts them.
+  bool sort_properties{false};
+};
+
+} // namespace kdlcpp
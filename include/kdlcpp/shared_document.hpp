@@ -0,0 +1,141 @@
+#pragma once
+
+#include "kdlcpp/document.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace kdlcpp {
+
+/**
+ * A shared_document publishes immutable versions of a kdlcpp::document
+ * to many concurrent readers while writers occasionally replace it.
+ *
+ * Readers call acquire() and obtain a snapshot that pins the version
+ * that was current at that moment. Acquiring and releasing a snapshot
+ * takes no locks and performs no allocation: each reader claims one of
+ * a fixed number of hazard slots, announces the version it is about to
+ * read and validates it against the current pointer.
+ *
+ * Writers call publish(), which atomically swaps in the new version and
+ * reclaims every retired version that is no longer announced by a reader
+ * (deferred reclamation). Writers are serialized among themselves.
+ */
+class shared_document {
+  struct version_block;
+  struct hazard_slot;
+
+public:
+  /**
+   * A read-only handle to one published version of the document.
+   * The version stays alive as long as the snapshot does.
+   * Snapshots are movable but not copyable.
+   */
+  class snapshot {
+  public:
+    snapshot(snapshot&& other) noexcept;
+    snapshot& operator=(snapshot&& other) noexcept;
+    snapshot(const snapshot&) = delete;
+    snapshot& operator=(const snapshot&) = delete;
+    ~snapshot();
+
+    /**
+     * Gets the pinned document.
+     * @return A const reference to the document.
+     */
+    [[nodiscard]] const document& get() const noexcept;
+
+    /**
+     * Gets the version number of the pinned document.
+     * @return The version, starting from 0 for the initial document.
+     */
+    [[nodiscard]] std::uint64_t version() const noexcept;
+
+    [[nodiscard]] const document& operator*() const noexcept {
+      return get();
+    }
+
+    [[nodiscard]] const document* operator->() const noexcept {
+      return &get();
+    }
+
+  private:
+    friend class shared_document;
+
+    snapshot(hazard_slot* slot, const version_block* block) noexcept
+      : m_slot(slot), m_block(block) {}
+
+    void release() noexcept;
+
+    hazard_slot* m_slot{nullptr};
+    const version_block* m_block{nullptr};
+  };
+
+  /// Default number of snapshots that can be held at the same time.
+  static constexpr std::size_t default_max_readers = 64;
+
+  /**
+   * Builds a shared_document publishing an initial version.
+   * @param initial The initial document, version 0.
+   * @param max_readers Maximum number of snapshots held at the same time.
+   *        Further acquire() calls spin until a snapshot is released.
+   */
+  explicit shared_document(
+    document initial = {}, std::size_t max_readers = default_max_readers);
+
+  shared_document(const shared_document&) = delete;
+  shared_document& operator=(const shared_document&) = delete;
+
+  /**
+   * Destroys every version. No snapshot may outlive the shared_document.
+   */
+  ~shared_document();
+
+  /**
+   * Pins the current version. Lock-free and allocation-free: the only
+   * retries happen when a writer publishes concurrently, or when all
+   * max_readers slots are in use.
+   * @return A snapshot of the current document.
+   */
+  [[nodiscard]] snapshot acquire() const noexcept;
+
+  /**
+   * Publishes a new version of the document. Versions retired by
+   * earlier calls are reclaimed once no snapshot refers to them.
+   * @param doc The document to publish.
+   * @return The version number assigned to the published document.
+   */
+  std::uint64_t publish(document&& doc);
+
+  /**
+   * Gets the number of retired versions still pinned by some snapshot.
+   * @return The number of versions awaiting reclamation.
+   */
+  [[nodiscard]] std::size_t pending_reclamation() const;
+
+private:
+  struct version_block {
+    document doc;
+    std::uint64_t version;
+  };
+
+  /// One reader announcement, padded to its own cache line.
+  struct alignas(64) hazard_slot {
+    std::atomic<bool> in_use{false};
+    std::atomic<const version_block*> hazard{nullptr};
+  };
+
+  void reclaim();
+
+  std::atomic<const version_block*> m_current;
+  std::unique_ptr<hazard_slot[]> m_slots;
+  std::size_t m_slot_count;
+
+  mutable std::mutex m_writer_mutex;
+  std::vector<const version_block*> m_retired;
+};
+
+} // namespace kdlcpp
@@ -0,0 +1,423 @@
+#pragma once
+
+#include "kdlcpp/document.hpp"
+#include "kdlcpp/node.hpp"
+#include "kdlcpp/value.hpp"
+#include "kdlcpp/detail/static_parse.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace kdlcpp {
+
+namespace detail::static_kdl {
+
+/// Iterates over a view by index, producing elements by value.
+template <typename container_type>
+class index_iterator {
+public:
+  constexpr index_iterator(const container_type* container, std::size_t index) noexcept
+    : m_container(container), m_index(index) {}
+
+  [[nodiscard]] constexpr auto operator*() const noexcept {
+    return m_container->element(m_index);
+  }
+
+  constexpr index_iterator& operator++() noexcept {
+    ++m_index;
+    return *this;
+  }
+
+  constexpr index_iterator operator++(int) noexcept {
+    index_iterator previous = *this;
+    ++m_index;
+    return previous;
+  }
+
+  [[nodiscard]] constexpr bool operator==(const index_iterator& other) const noexcept {
+    return m_index == other.m_index;
+  }
+
+  [[nodiscard]] constexpr bool operator!=(const index_iterator& other) const noexcept {
+    return m_index != other.m_index;
+  }
+
+private:
+  const container_type* m_container;
+  std::size_t m_index;
+};
+
+} // namespace detail::static_kdl
+
+/**
+ * @brief A value of a static document.
+ *
+ * Reads like kdlcpp::value, in constant expressions too; strings are
+ * views of the document's character table.
+ */
+class static_value {
+public:
+  constexpr static_value(detail::static_kdl::table_view tables, const detail::static_kdl::raw_value* raw) noexcept
+    : m_tables(tables), m_raw(raw) {}
+
+  /**
+   * @brief Returns the type of the value.
+   */
+  [[nodiscard]] constexpr value::type get_type() const noexcept {
+    return m_raw->kind;
+  }
+
+  /**
+   * @brief Retrieves the value as the requested type.
+   *
+   * @tparam T value::boolean, value::integral, value::decimal,
+   *         std::string_view, or value::string, which copies the string
+   *         and cannot be used in constant expressions.
+   * @return The value if it has the requested type, or std::nullopt.
+   */
+  template <typename T>
+  [[nodiscard]] constexpr std::optional<T> get() const noexcept {
+    if constexpr (std::is_same_v<T, value::boolean>) {
+      return m_raw->kind == value::type::boolean ? std::optional<T>{m_raw->boolean} : std::nullopt;
+    } else if constexpr (std::is_same_v<T, value::integral>) {
+      return m_raw->kind == value::type::integral ? std::optional<T>{m_raw->integral} : std::nullopt;
+    } else if constexpr (std::is_same_v<T, value::decimal>) {
+      return m_raw->kind == value::type::decimal ? std::optional<T>{m_raw->decimal} : std::nullopt;
+    } else if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, value::string>) {
+      return m_raw->kind == value::type::string ? std::optional<T>{T{m_tables.text(m_raw->text)}}
+                                                : std::nullopt;
+    } else {
+      static_assert(!std::is_same_v<T, T>, "unsupported value type");
+    }
+  }
+
+  /**
+   * @brief Copies the value into a kdlcpp::value.
+   */
+  [[nodiscard]] value to_value() const {
+    switch (m_raw->kind) {
+      case value::type::boolean: return value{m_raw->boolean};
+      case value::type::integral: return value{m_raw->integral};
+      case value::type::decimal: return value{m_raw->decimal};
+      case value::type::string: return value{value::string{m_tables.text(m_raw->text)}};
+      default: return value{};
+    }
+  }
+
+private:
+  detail::static_kdl::table_view m_tables;
+  const detail::static_kdl::raw_value* m_raw;
+};
+
+/**
+ * @brief The arguments of a static node, read like kdlcpp::arguments.
+ */
+class static_arguments {
+public:
+  using const_iterator = detail::static_kdl::index_iterator<static_arguments>;
+
+  constexpr static_arguments(detail::static_kdl::table_view tables, const detail::static_kdl::node_entry* entry) noexcept
+    : m_tables(tables), m_entry(entry) {}
+
+  [[nodiscard]] constexpr const_iterator begin() const noexcept {
+    return const_iterator{this, 0};
+  }
+
+  [[nodiscard]] constexpr const_iterator end() const noexcept {
+    return const_iterator{this, size()};
+  }
+
+  /**
+   * @brief Returns the number of arguments.
+   */
+  [[nodiscard]] constexpr std::size_t size() const noexcept {
+    return m_entry->argument_count;
+  }
+
+  /**
+   * @brief Retrieves the argument at a given index.
+   * @return The argument, or std::nullopt if the index is out of range.
+   */
+  [[nodiscard]] constexpr std::optional<static_value> at(std::size_t index) const noexcept {
+    return index < size() ? std::optional<static_value>{element(index)} : std::nullopt;
+  }
+
+private:
+  friend const_iterator;
+
+  [[nodiscard]] constexpr static_value element(std::size_t index) const noexcept {
+    return static_value{m_tables, m_tables.arguments + m_entry->first_argument + index};
+  }
+
+  detail::static_kdl::table_view m_tables;
+  const detail::static_kdl::node_entry* m_entry;
+};
+
+/**
+ * @brief The properties of a static node, read like kdlcpp::properties.
+ *
+ * Iteration yields `std::pair<std::string_view, static_value>` in
+ * document order; a repeated key keeps its first position and last value.
+ */
+class static_properties {
+public:
+  using const_iterator = detail::static_kdl::index_iterator<static_properties>;
+
+  constexpr static_properties(detail::static_kdl::table_view tables, const detail::static_kdl::node_entry* entry) noexcept
+    : m_tables(tables), m_entry(entry) {}
+
+  [[nodiscard]] constexpr const_iterator begin() const noexcept {
+    return const_iterator{this, 0};
+  }
+
+  [[nodiscard]] constexpr const_iterator end() const noexcept {
+    return const_iterator{this, size()};
+  }
+
+  /**
+   * @brief Returns the number of properties.
+   */
+  [[nodiscard]] constexpr std::size_t size() const noexcept {
+    return m_entry->property_count;
+  }
+
+  /**
+   * @brief Checks whether a property exists.
+   */
+  [[nodiscard]] constexpr bool contains(std::string_view key) const noexcept {
+    return find(key) < size();
+  }
+
+  /**
+   * @brief Retrieves the value of a property.
+   * @return The value, or std::nullopt if there is no such property.
+   */
+  [[nodiscard]] constexpr std::optional<static_value> at(std::string_view key) const noexcept {
+    const std::size_t index = find(key);
+    return index < size() ? std::optional<static_value>{element(index).second} : std::nullopt;
+  }
+
+private:
+  friend const_iterator;
+
+  [[nodiscard]] constexpr std::size_t find(std::string_view key) const noexcept {
+    for (std::size_t i = 0; i < size(); ++i) {
+      if (element(i).first == key) {
+        return i;
+      }
+    }
+    return size();
+  }
+
+  [[nodiscard]] constexpr std::pair<std::string_view, static_value> element(std::size_t index) const noexcept {
+    const auto& entry = m_tables.properties[m_entry->first_property + index];
+    return {m_tables.text(entry.key), static_value{m_tables, &entry.val}};
+  }
+
+  detail::static_kdl::table_view m_tables;
+  const detail::static_kdl::node_entry* m_entry;
+};
+
+class static_node_list;
+
+/**
+ * @brief A node of a static document, read like kdlcpp::node.
+ */
+class static_node {
+public:
+  constexpr static_node(detail::static_kdl::table_view tables, std::size_t index) noexcept
+    : m_tables(tables), m_entry(tables.nodes + index) {}
+
+  /**
+   * @brief Returns the name of the node.
+   */
+  [[nodiscard]] constexpr std::string_view get_name() const noexcept {
+    return m_tables.text(m_entry->name);
+  }
+
+  /**
+   * @brief Returns the arguments of the node.
+   */
+  [[nodiscard]] constexpr static_arguments get_arguments() const noexcept {
+    return static_arguments{m_tables, m_entry};
+  }
+
+  /**
+   * @brief Returns the properties of the node.
+   */
+  [[nodiscard]] constexpr static_properties get_properties() const noexcept {
+    return static_properties{m_tables, m_entry};
+  }
+
+  /**
+   * @brief Returns the children of the node.
+   */
+  [[nodiscard]] constexpr static_node_list get_children() const noexcept;
+
+  /**
+   * @brief Copies the node and its subtree into a kdlcpp::node.
+   */
+  [[nodiscard]] node to_node() const;
+
+private:
+  detail::static_kdl::table_view m_tables;
+  const detail::static_kdl::node_entry* m_entry;
+};
+
+/**
+ * @brief The children of a static node, read like kdlcpp::node_list.
+ */
+class static_node_list {
+public:
+  using const_iterator = detail::static_kdl::index_iterator<static_node_list>;
+
+  constexpr static_node_list(detail::static_kdl::table_view tables, const detail::static_kdl::node_entry* entry) noexcept
+    : m_tables(tables), m_entry(entry) {}
+
+  [[nodiscard]] constexpr const_iterator begin() const noexcept {
+    return const_iterator{this, 0};
+  }
+
+  [[nodiscard]] constexpr const_iterator end() const noexcept {
+    return const_iterator{this, size()};
+  }
+
+  [[nodiscard]] constexpr std::size_t size() const noexcept {
+    return m_entry->child_count;
+  }
+
+  [[nodiscard]] constexpr bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  /**
+   * @brief Returns the child at a given index, which must be in range.
+   */
+  [[nodiscard]] constexpr static_node operator[](std::size_t index) const noexcept {
+    return element(index);
+  }
+
+  [[nodiscard]] constexpr static_node front() const noexcept {
+    return element(0);
+  }
+
+  [[nodiscard]] constexpr static_node back() const noexcept {
+    return element(size() - 1);
+  }
+
+private:
+  friend const_iterator;
+
+  [[nodiscard]] constexpr static_node element(std::size_t index) const noexcept {
+    return static_node{m_tables, m_tables.children[m_entry->first_child + index]};
+  }
+
+  detail::static_kdl::table_view m_tables;
+  const detail::static_kdl::node_entry* m_entry;
+};
+
+constexpr static_node_list static_node::get_children() const noexcept {
+  return static_node_list{m_tables, m_entry};
+}
+
+inline node static_node::to_node() const {
+  node copy{string_type{get_name()}};
+  auto& args = copy.get_arguments();
+  args.reserve(get_arguments().size());
+  for (const auto arg : get_arguments()) {
+    args.push_back(arg.to_value());
+  }
+  auto& props = copy.get_properties();
+  props.reserve(get_properties().size());
+  for (const auto& [key, val] : get_properties()) {
+    props.insert(string_type{key}, val.to_value());
+  }
+  auto& children = copy.get_children();
+  children.reserve(get_children().size());
+  for (const auto child : get_children()) {
+    children.push_back(child.to_node());
+  }
+  return copy;
+}
+
+/**
+ * A document parsed at compile time into read-only tables. It is built by
+ * parse_static() and meant to be stored in a `constexpr` variable, which
+ * lives in read-only data: nothing is allocated or initialized at startup.
+ *
+ * @tparam node_count The number of nodes, root included.
+ * @tparam argument_count The number of arguments.
+ * @tparam property_count The number of properties, repeated keys included.
+ * @tparam char_count The size of the character table holding every string.
+ */
+template <std::size_t node_count, std::size_t argument_count, std::size_t property_count,
+          std::size_t char_count>
+class static_document {
+public:
+  using tables_type = detail::static_kdl::tables<node_count, argument_count, property_count, char_count>;
+
+  constexpr explicit static_document(const tables_type& tables) noexcept : m_tables(tables) {}
+
+  /**
+   * @brief Returns the root node, whose children are the top-level nodes.
+   */
+  [[nodiscard]] constexpr static_node root() const noexcept {
+    return static_node{view(), 0};
+  }
+
+  /**
+   * @brief Copies the nodes into a kdlcpp::document.
+   */
+  [[nodiscard]] document to_document() const {
+    document doc;
+    auto& top_level = doc.root().get_children();
+    top_level.reserve(root().get_children().size());
+    for (const auto child : root().get_children()) {
+      top_level.push_back(child.to_node());
+    }
+    return doc;
+  }
+
+private:
+  [[nodiscard]] constexpr detail::static_kdl::table_view view() const noexcept {
+    return detail::static_kdl::table_view{
+      m_tables.nodes.data(), m_tables.children.data(), m_tables.arguments.data(),
+      m_tables.properties.data(), m_tables.chars.data()};
+  }
+
+  tables_type m_tables;
+};
+
+/**
+ * Parses KDL text at compile time:
+ * ```
+ * constexpr std::string_view defaults = R"(server 8080 { route "/" })";
+ * constexpr auto config = kdlcpp::parse_static<defaults>();
+ * static_assert(config.root().get_children()[0].get_name() == "server");
+ * ```
+ * The text is named by a reference to a `constexpr std::string_view` with
+ * static storage, at namespace scope or as a static member, since C++17
+ * takes neither string literals nor string_view values as template
+ * arguments. Invalid KDL does not compile: the compiler points at the
+ * parse_error thrown with the message and offset of the first error.
+ * The grammar is the one of the runtime parser and type annotations are
+ * dropped as well.
+ *
+ * Large texts may need a higher constant evaluation limit
+ * (`-fconstexpr-ops-limit` on GCC, `-fconstexpr-steps` on Clang).
+ *
+ * @tparam text The KDL text.
+ * @return The document, sized exactly for its content.
+ */
+template <const std::string_view& text>
+[[nodiscard]] constexpr auto parse_static() {
+  constexpr detail::static_kdl::counts sizes = detail::static_kdl::measure(text);
+  using document_type = static_document<sizes.nodes, sizes.arguments, sizes.properties, sizes.chars>;
+  return document_type{
+    detail::static_kdl::build<sizes.nodes, sizes.arguments, sizes.properties, sizes.chars>(text)};
+}
+
+} // namespace kdlcpp
@@ -35,6 +35,15 @@ public:
     return m_internal_stream;
   }
 
+  /**
+   * @brief Provides access to the underlying stream object.
+   * 
+   * @return A reference to the wrapped stream.
+   */
+  [[nodiscard]] stream_type& get() noexcept {
+    return m_internal_stream;
+  }
+
   /**
    * @brief Writes a value to the stream using the << operator.
    * 
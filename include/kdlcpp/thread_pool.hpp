@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kdlcpp {
+
+/**
+ * A fixed set of worker threads running submitted tasks, with work stealing.
+ *
+ * Every worker owns a queue. A task submitted from a worker goes to the
+ * back of that worker's queue, which the worker pops from the back, so
+ * that tasks spawned by a task run soon, on warm caches. Tasks submitted
+ * from other threads are spread over the queues in turn. An idle worker
+ * steals from the front of the other queues, where the oldest and usually
+ * largest tasks are.
+ *
+ * A thread waiting in wait() runs pending tasks instead of blocking.
+ */
+class thread_pool {
+public:
+  using task = std::function<void()>;
+
+  /**
+   * Starts the workers.
+   * @param threads The number of workers, or 0 for one per hardware thread.
+   */
+  explicit thread_pool(std::size_t threads = 0);
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  /**
+   * Runs the tasks still queued, then stops the workers.
+   */
+  ~thread_pool();
+
+  /**
+   * Queues a task.
+   * @param work The task. Exceptions it throws are reported by wait().
+   */
+  void submit(task work);
+
+  /**
+   * Runs queued tasks on the calling thread until every submitted
+   * task has finished.
+   * @throws The first exception thrown by a task since the last wait().
+   */
+  void wait();
+
+  /**
+   * Runs one queued task on the calling thread, if there is any.
+   * @return true if a task was run.
+   */
+  bool run_one();
+
+  /**
+   * Gets the number of workers.
+   */
+  [[nodiscard]] std::size_t size() const noexcept {
+    return m_threads.size();
+  }
+
+private:
+  struct worker_queue {
+    std::mutex mutex;
+    std::deque<task> tasks;
+  };
+
+  void worker_loop(std::size_t index);
+
+  /// Takes a task, from the given queue first, then from the others.
+  bool take(std::size_t first, task& work);
+
+  void execute(task& work) noexcept;
+
+  std::vector<std::unique_ptr<worker_queue>> m_queues;
+  std::vector<std::thread> m_threads;
+  std::atomic<std::size_t> m_next{0};
+  std::atomic<std::size_t> m_queued{0};
+  std::atomic<std::size_t> m_pending{0};
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_idle;
+  bool m_stop{false};
+  std::exception_ptr m_error;
+};
+
+/**
+ * A set of tasks run on a thread_pool that can be waited for on their own,
+ * including from inside a task of the same pool: wait() runs queued tasks
+ * of the pool until those of the group are done, so nested fork-join
+ * never blocks a worker.
+ */
+class task_group {
+public:
+  /**
+   * @param pool The pool running the tasks.
+   */
+  explicit task_group(thread_pool& pool) noexcept : m_pool(pool) {}
+
+  task_group(const task_group&) = delete;
+  task_group& operator=(const task_group&) = delete;
+
+  /**
+   * Waits for the tasks still running. Their exceptions are dropped.
+   */
+  ~task_group();
+
+  /**
+   * Queues a task of the group.
+   * @param work The task. Exceptions it throws are reported by wait().
+   */
+  void run(thread_pool::task work);
+
+  /**
+   * Runs queued tasks of the pool on the calling thread until every task
+   * of the group has finished.
+   * @throws The first exception thrown by a task of the group.
+   */
+  void wait();
+
+private:
+  thread_pool& m_pool;
+  std::atomic<std::size_t> m_pending{0};
+  std::mutex m_mutex;
+  std::exception_ptr m_error;
+};
+
+} // namespace kdlcpp
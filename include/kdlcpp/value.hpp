@@ -2,6 +2,8 @@
 
 #include "kdlcpp/common.hpp"
 
+#include <cmath>
+#include <cstdint>
 #include <variant>
 #include <optional>
 
@@ -111,7 +113,7 @@ public:
    * Can be used to explicitly set the value to null:
    *     value.Set(Value::Null);
    */
-  static constexpr nulltype null;
+  static constexpr nulltype null{};
 
 private:
   using content_type = std::variant<nulltype, boolean, integral, decimal, string>;
@@ -3,34 +3,134 @@
 namespace kdlcpp {
 
 std::size_t arguments::size() const noexcept {
-  return m_arguments_list.size();
+  return std::visit([](const auto& list) { return list.size(); }, m_arguments_list);
 }
 
 std::optional<value> arguments::at(const std::size_t index) const noexcept {
-  if (index >= m_arguments_list.size())
+  if (index >= size())
     return std::nullopt;
 
-  return m_arguments_list.at(index);
+  return get(index);
 }
 
 void arguments::insert_at(const std::size_t index, const value& val) noexcept {
-  if (index >= m_arguments_list.size()) {
-    m_arguments_list.resize(index + 1);
+  // Assigning within a packed list of the same type keeps it packed;
+  // growing past the end pads with null values, which never pack.
+  if (index < size()) {
+    if (auto* integrals = packed_integrals(); integrals && val.get_type() == value::type::integral) {
+      (*integrals)[index] = *val.get<value::integral>();
+      return;
+    }
+    if (auto* decimals = packed_decimals(); decimals && val.get_type() == value::type::decimal) {
+      (*decimals)[index] = *val.get<value::decimal>();
+      return;
+    }
   }
-  m_arguments_list[index] = val;
+
+  auto& list = generic();
+  if (index >= list.size()) {
+    list.resize(index + 1);
+  }
+  list[index] = val;
 }
 
 void arguments::push_back(const value& val) noexcept {
-  m_arguments_list.push_back(val);
+  push_back(value{val});
+}
+
+void arguments::push_back(value&& val) noexcept {
+  if (size() == 0) {
+    // The first argument decides whether the list starts out packed.
+    const auto capacity = std::visit([](const auto& list) { return list.capacity(); }, m_arguments_list);
+    if (val.get_type() == value::type::integral) {
+      if (!packed_integrals()) {
+        m_arguments_list.emplace<integral_list>().reserve(capacity);
+      }
+    } else if (val.get_type() == value::type::decimal) {
+      if (!packed_decimals()) {
+        m_arguments_list.emplace<decimal_list>().reserve(capacity);
+      }
+    } else if (get_storage() != storage::generic) {
+      m_arguments_list.emplace<generic_list>().reserve(capacity);
+    }
+  }
+
+  if (auto* integrals = packed_integrals(); integrals && val.get_type() == value::type::integral) {
+    integrals->push_back(*val.get<value::integral>());
+  } else if (auto* decimals = packed_decimals(); decimals && val.get_type() == value::type::decimal) {
+    decimals->push_back(*val.get<value::decimal>());
+  } else {
+    generic().push_back(std::move(val));
+  }
+}
+
+void arguments::reserve(std::size_t count) {
+  std::visit([count](auto& list) { list.reserve(count); }, m_arguments_list);
+}
+
+void arguments::shrink_to_fit() {
+  std::visit([](auto& list) { list.shrink_to_fit(); }, m_arguments_list);
 }
 
 bool arguments::erase(const std::size_t index) noexcept {
-  if (index >= m_arguments_list.size()) {
+  if (index >= size()) {
     return false;
   }
 
-  m_arguments_list.erase(m_arguments_list.begin() + index);
+  std::visit([index](auto& list) { list.erase(list.begin() + index); }, m_arguments_list);
   return true;
 }
 
+arguments::storage arguments::get_storage() const noexcept {
+  return static_cast<storage>(m_arguments_list.index());
+}
+
+const std::vector<value::integral>* arguments::packed_integrals() const noexcept {
+  return std::get_if<integral_list>(&m_arguments_list);
+}
+
+std::vector<value::integral>* arguments::packed_integrals() noexcept {
+  return std::get_if<integral_list>(&m_arguments_list);
+}
+
+const std::vector<value::decimal>* arguments::packed_decimals() const noexcept {
+  return std::get_if<decimal_list>(&m_arguments_list);
+}
+
+std::vector<value::decimal>* arguments::packed_decimals() noexcept {
+  return std::get_if<decimal_list>(&m_arguments_list);
+}
+
+value arguments::get(std::size_t index) const noexcept {
+  return std::visit([index](const auto& list) { return value{list[index]}; }, m_arguments_list);
+}
+
+value::type arguments::get_type(std::size_t index) const noexcept {
+  switch (get_storage()) {
+    case storage::integral:
+      return value::type::integral;
+    case storage::decimal:
+      return value::type::decimal;
+    default:
+      return std::get<generic_list>(m_arguments_list)[index].get_type();
+  }
+}
+
+arguments::generic_list& arguments::generic() {
+  if (auto* list = std::get_if<generic_list>(&m_arguments_list)) {
+    return *list;
+  }
+
+  generic_list unpacked;
+  std::visit(
+    [&unpacked](const auto& packed) {
+      unpacked.reserve(packed.size());
+      for (const auto& element : packed) {
+        unpacked.emplace_back(element);
+      }
+    },
+    m_arguments_list);
+  return m_arguments_list.emplace<generic_list>(std::move(unpacked));
+}
+
 } // namespace kdlcpp
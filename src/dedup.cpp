@@ -0,0 +1,267 @@
+#include "kdlcpp/dedup.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kdlcpp {
+
+namespace {
+
+constexpr std::uint64_t mix(std::uint64_t hash, std::uint64_t data) noexcept {
+  // splitmix64 finalizer over the running hash.
+  std::uint64_t x = hash ^ (data + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+std::uint64_t hash_bytes(std::string_view text) noexcept {
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char c : text) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+  }
+  return mix(hash, text.size());
+}
+
+/// Decimals are compared and hashed by their bits, so that
+/// NaN matches NaN and -0.0 does not match 0.0.
+std::uint64_t decimal_bits(value::decimal number) noexcept {
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &number, sizeof(bits));
+  return bits;
+}
+
+std::uint64_t hash_value(const value& val) noexcept {
+  const auto type = static_cast<std::uint64_t>(val.get_type());
+  switch (val.get_type()) {
+    case value::type::null:
+      return mix(type, 0);
+    case value::type::boolean:
+      return mix(type, *val.get<value::boolean>());
+    case value::type::integral:
+      return mix(type, static_cast<std::uint64_t>(*val.get<value::integral>()));
+    case value::type::decimal:
+      return mix(type, decimal_bits(*val.get<value::decimal>()));
+    case value::type::string:
+      return mix(type, hash_bytes(*val.get<value::string>()));
+  }
+  return type;
+}
+
+bool equal_values(const value& lhs, const value& rhs) noexcept {
+  if (lhs.get_type() != rhs.get_type()) {
+    return false;
+  }
+  switch (lhs.get_type()) {
+    case value::type::null:
+      return true;
+    case value::type::boolean:
+      return lhs.get<value::boolean>() == rhs.get<value::boolean>();
+    case value::type::integral:
+      return lhs.get<value::integral>() == rhs.get<value::integral>();
+    case value::type::decimal:
+      return decimal_bits(*lhs.get<value::decimal>()) == decimal_bits(*rhs.get<value::decimal>());
+    case value::type::string:
+      return lhs.get<value::string>() == rhs.get<value::string>();
+  }
+  return false;
+}
+
+/// Hashes the name, arguments and properties of a node.
+std::uint64_t hash_head(const node& node_) {
+  std::uint64_t hash = hash_bytes(node_.get_name());
+  for (const auto& arg : node_.get_arguments()) {
+    hash = mix(hash, hash_value(arg));
+  }
+  // Properties are unordered, so their hashes are summed.
+  std::uint64_t properties_hash = 0;
+  for (const auto& [key, val] : node_.get_properties()) {
+    properties_hash += mix(hash_bytes(key), hash_value(val));
+  }
+  return mix(mix(hash, properties_hash), node_.get_properties().size());
+}
+
+std::uint64_t hash_subtree(const node& node_, std::unordered_map<std::uint64_t, std::size_t>& counts) {
+  std::uint64_t hash = hash_head(node_);
+  for (const auto& child : node_.get_children()) {
+    hash = mix(hash, hash_subtree(child, counts));
+  }
+  hash = mix(hash, node_.get_children().size());
+  ++counts[hash];
+  return hash;
+}
+
+bool equal_subtrees(const node& lhs, const node& rhs) {
+  if (lhs.get_shared() && lhs.get_shared() == rhs.get_shared()) {
+    return true;
+  }
+  if (lhs.get_name() != rhs.get_name()) {
+    return false;
+  }
+
+  const auto& lhs_args = lhs.get_arguments();
+  const auto& rhs_args = rhs.get_arguments();
+  if (lhs_args.size() != rhs_args.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < lhs_args.size(); ++i) {
+    if (!equal_values(*lhs_args.at(i), *rhs_args.at(i))) {
+      return false;
+    }
+  }
+
+  const auto& lhs_props = lhs.get_properties();
+  const auto& rhs_props = rhs.get_properties();
+  if (lhs_props.size() != rhs_props.size()) {
+    return false;
+  }
+  for (const auto& [key, val] : lhs_props) {
+    const auto other = rhs_props.at(key);
+    if (!other || !equal_values(val, *other)) {
+      return false;
+    }
+  }
+
+  const auto& lhs_children = lhs.get_children();
+  const auto& rhs_children = rhs.get_children();
+  if (lhs_children.size() != rhs_children.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < lhs_children.size(); ++i) {
+    if (!equal_subtrees(lhs_children[i], rhs_children[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Heap bytes of a string, or 0 when it fits in the string object.
+std::size_t string_bytes(const string_type& text) noexcept {
+  return text.capacity() > string_type{}.capacity() ? text.capacity() + 1 : 0;
+}
+
+std::size_t value_bytes(const value& val) noexcept {
+  const auto text = val.get<value::string>();
+  return text ? string_bytes(*text) : 0;
+}
+
+/// Estimates the heap bytes owned by a node, not counting the node object.
+std::size_t owned_bytes(const node& node_) {
+  if (node_.get_shared()) {
+    return 0;
+  }
+
+  std::size_t bytes = string_bytes(node_.get_name());
+  const auto& args = node_.get_arguments();
+  if (const auto* integrals = args.packed_integrals()) {
+    bytes += integrals->capacity() * sizeof(value::integral);
+  } else if (const auto* decimals = args.packed_decimals()) {
+    bytes += decimals->capacity() * sizeof(value::decimal);
+  } else {
+    for (const auto& arg : args) {
+      bytes += sizeof(value) + value_bytes(arg);
+    }
+  }
+  // Each map entry is a separate allocation holding the pair and a link.
+  for (const auto& [key, val] : node_.get_properties()) {
+    bytes += sizeof(std::pair<const string_type, value>) + 2 * sizeof(void*) +
+             string_bytes(key) + value_bytes(val);
+  }
+  const auto& children = node_.get_children();
+  bytes += children.capacity() * sizeof(node);
+  for (const auto& child : children) {
+    bytes += owned_bytes(child);
+  }
+  return bytes;
+}
+
+/// The state of a deduplication pass.
+class deduplicator {
+public:
+  dedup_summary run(node& root) {
+    for (const auto& child : root.get_children()) {
+      hash_subtree(child, m_counts);
+    }
+    for (auto& child : root.get_children()) {
+      visit(child);
+    }
+    m_summary.bytes_saved = m_released > m_overhead ? m_released - m_overhead : 0;
+    return m_summary;
+  }
+
+private:
+  std::uint64_t visit(node& node_) {
+    std::uint64_t hash = hash_head(node_);
+    if (node_.get_shared()) {
+      // Already shared by a previous pass: the references are kept as they
+      // are, and the shared node is offered to the duplicates found now.
+      const auto& children = std::as_const(node_).get_children();
+      for (const auto& child : children) {
+        hash = mix(hash, hash_subtree(child, m_scratch));
+      }
+      hash = mix(hash, children.size());
+      auto& group = m_pool[hash];
+      if (group.empty()) {
+        group.push_back(node_.get_shared());
+      }
+      return hash;
+    }
+
+    for (auto& child : node_.get_children()) {
+      hash = mix(hash, visit(child));
+    }
+    hash = mix(hash, node_.get_children().size());
+
+    const auto count = m_counts.find(hash);
+    if (count == m_counts.end() || count->second < 2) {
+      return hash;
+    }
+    // A shared node costs about a node and a control block, which
+    // subtrees owning less than that would not pay back.
+    const std::size_t bytes = owned_bytes(node_);
+    if (bytes <= sizeof(node)) {
+      return hash;
+    }
+
+    auto& group = m_pool[hash];
+    for (const auto& candidate : group) {
+      if (equal_subtrees(*candidate, node_)) {
+        node_.share(candidate);
+        m_released += bytes;
+        ++m_summary.references;
+        return hash;
+      }
+    }
+
+    // First occurrence: its content moves into the shared node.
+    auto shared = std::make_shared<const node>(std::move(node_));
+    node_.share(shared);
+    group.push_back(std::move(shared));
+    m_overhead += sizeof(node) + 2 * sizeof(void*);
+    ++m_summary.shared_subtrees;
+    ++m_summary.references;
+    return hash;
+  }
+
+  std::unordered_map<std::uint64_t, std::size_t> m_counts;
+  std::unordered_map<std::uint64_t, std::size_t> m_scratch;
+  std::unordered_map<std::uint64_t, std::vector<std::shared_ptr<const node>>> m_pool;
+  dedup_summary m_summary;
+  std::size_t m_released{0};
+  std::size_t m_overhead{0};
+};
+
+} // namespace
+
+dedup_summary deduplicate(node& root) {
+  return deduplicator{}.run(root);
+}
+
+dedup_summary deduplicate(document& doc) {
+  return deduplicate(doc.root());
+}
+
+} // namespace kdlcpp
@@ -0,0 +1,40 @@
+#include "kdlcpp/digest.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+#include "kdlcpp/detail/sha256.hpp"
+
+namespace kdlcpp {
+
+namespace {
+
+serialize_options canonical_options() noexcept {
+  serialize_options options;
+  options.output_style = serialize_options::style::canonical;
+  return options;
+}
+
+} // namespace
+
+digest_type canonical_digest(const node& node_) {
+  stream<detail::digest_sink> out{detail::digest_sink{}};
+  detail::serialize::serialize_node(out, node_, canonical_options());
+  return out.get().finish();
+}
+
+digest_type canonical_digest(const document& doc) {
+  stream<detail::digest_sink> out{detail::digest_sink{}};
+  detail::serialize::serialize_document(out, doc, canonical_options());
+  return out.get().finish();
+}
+
+string_type to_hex(const digest_type& digest) {
+  constexpr const char* hex = "0123456789abcdef";
+  string_type text;
+  text.reserve(digest.size() * 2);
+  for (const auto byte : digest) {
+    text.push_back(hex[byte >> 4]);
+    text.push_back(hex[byte & 0xF]);
+  }
+  return text;
+}
+
+} // namespace kdlcpp
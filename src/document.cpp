@@ -1,4 +1,7 @@
 #include "kdlcpp/document.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+
+#include <fstream>
 
 namespace kdlcpp {
 
@@ -22,7 +25,13 @@ void document::set_root(node&& root) noexcept {
   m_root = std::move(root);
 }
 
-void document::write_to_file(const string_type& file_path) {
+void document::write_to_file(const string_type& file_path, const serialize_options& options) {
+  std::ofstream file;
+  file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+  file.open(file_path, std::ios::binary | std::ios::trunc);
+
+  stream<std::ofstream> out{std::move(file)};
+  detail::serialize::serialize_document_cached(out, *this, options);
 }
 
 } // namespace kdlcpp
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "kdlcpp/document_builder.hpp"
+
+#include <cassert>
+
+namespace kdlcpp {
+
+namespace {
+
+/// Gives every container of a subtree exactly the room it uses.
+void shrink_subtree(node& current) {
+  auto& children = current.get_children();
+  children.shrink_to_fit();
+  current.get_arguments().shrink_to_fit();
+  current.get_properties().shrink_to_fit();
+  for (auto& child : children) {
+    shrink_subtree(child);
+  }
+}
+
+} // namespace
+
+document_builder::document_builder(std::size_t top_level_nodes) {
+  m_document.root().get_children().reserve(top_level_nodes);
+}
+
+document_builder& document_builder::begin_node(string_type name) {
+  return begin_node(std::move(name), size_hint{});
+}
+
+document_builder& document_builder::begin_node(string_type name, const size_hint& hint) {
+  // Open nodes are the last children of their parents, and only the
+  // children of the innermost one grow, so the open pointers stay valid.
+  node& parent = m_open.empty() ? m_document.root() : *m_open.back();
+  node& created = parent.append_child(node{std::move(name)});
+  if (hint.children > 0) {
+    created.get_children().reserve(hint.children);
+  }
+  if (hint.arguments > 0) {
+    created.get_arguments().reserve(hint.arguments);
+  }
+  if (hint.properties > 0) {
+    created.get_properties().reserve(hint.properties);
+  }
+  m_open.push_back(&created);
+  return *this;
+}
+
+document_builder& document_builder::arg(value val) {
+  assert(!m_open.empty());
+  m_open.back()->get_arguments().push_back(std::move(val));
+  return *this;
+}
+
+document_builder& document_builder::prop(string_type key, value val) {
+  assert(!m_open.empty());
+  m_open.back()->get_properties().insert(std::move(key), std::move(val));
+  return *this;
+}
+
+document_builder& document_builder::end_node() {
+  assert(!m_open.empty());
+  m_open.pop_back();
+  return *this;
+}
+
+document document_builder::finish() {
+  assert(m_open.empty());
+  auto& top_level = m_document.root().get_children();
+  top_level.shrink_to_fit();
+  for (auto& current : top_level) {
+    shrink_subtree(current);
+  }
+  document built = std::move(m_document);
+  m_document = document{};
+  return built;
+}
+
+} // namespace kdlcpp
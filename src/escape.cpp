@@ -0,0 +1,83 @@
+#include "kdlcpp/detail/escape.hpp"
+#include "kdlcpp/detail/parse.hpp"
+#include "kdlcpp/detail/scan.hpp"
+
+namespace kdlcpp::detail::escape {
+
+namespace {
+
+constexpr bool is_digit(char c) noexcept {
+  return c >= '0' && c <= '9';
+}
+
+/// Whether an identifier-only string may be written bare: it must not
+/// look like a number or be a keyword.
+bool is_bare_identifier(std::string_view text) noexcept {
+  if (text.empty() || is_digit(text[0])) {
+    return false;
+  }
+  if (text[0] == '+' || text[0] == '-' || text[0] == '.') {
+    const std::size_t next = (text[0] != '.' && text.size() > 1 && text[1] == '.') ? 2 : 1;
+    if (text.size() > next && is_digit(text[next])) {
+      return false;
+    }
+  }
+  return text != "true" && text != "false" && text != "null" &&
+         text != "inf" && text != "-inf" && text != "nan";
+}
+
+} // namespace
+
+string_class classify(std::string_view text) noexcept {
+  // Every byte that needs an escape also keeps a string from being bare,
+  // so the escape scan only starts where the bare scan stops.
+  const std::size_t bare = scan::find_first_of(text, scan::bare_stops);
+  if (bare == text.size()) {
+    return is_bare_identifier(text) ? string_class::identifier : string_class::plain;
+  }
+  const std::string_view rest = text.substr(bare);
+  return scan::find_first_of(rest, scan::escape_stops) == rest.size() ? string_class::plain : string_class::escaped;
+}
+
+std::size_t find_escape(std::string_view text) noexcept {
+  return scan::find_first_of(text, scan::escape_stops);
+}
+
+std::size_t escape_code_point(std::string_view text, string_type& out) {
+  out.clear();
+  switch (text[0]) {
+    case '"':  out = "\\\""; return 1;
+    case '\\': out = "\\\\"; return 1;
+    case '\n': out = "\\n"; return 1;
+    case '\r': out = "\\r"; return 1;
+    case '\t': out = "\\t"; return 1;
+    case '\b': out = "\\b"; return 1;
+    case '\f': out = "\\f"; return 1;
+    default: break;
+  }
+
+  std::size_t length = 0;
+  char32_t cp = parse::decode_utf8(text, 0, length);
+  if (length == 0) {
+    cp = 0xFFFD;
+    length = 1;
+  } else if (cp >= 0x80 && !parse::is_newline(cp) && !parse::is_disallowed(cp)) {
+    out.assign(text.substr(0, length));
+    return length;
+  }
+
+  constexpr const char* hex = "0123456789abcdef";
+  out = "\\u{";
+  bool leading = true;
+  for (int shift = 20; shift >= 0; shift -= 4) {
+    const auto digit = (cp >> shift) & 0xF;
+    if (digit != 0 || !leading || shift == 0) {
+      out.push_back(hex[digit]);
+      leading = false;
+    }
+  }
+  out.push_back('}');
+  return length;
+}
+
+} // namespace kdlcpp::detail::escape
@@ -0,0 +1,186 @@
+#include "kdlcpp/file_watcher.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace kdlcpp {
+
+namespace {
+
+constexpr std::uint32_t watch_mask =
+  IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE;
+
+[[noreturn]] void throw_errno(const char* what) {
+  throw std::system_error{errno, std::generic_category(), what};
+}
+
+/// Reads a whole file, returning false if it cannot be opened.
+bool read_file(const string_type& path, string_type& content) {
+  std::ifstream in{path, std::ios::binary};
+  if (!in) {
+    return false;
+  }
+  content.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+  return !in.bad();
+}
+
+} // namespace
+
+file_watcher::file_watcher(reload_callback on_reload, std::chrono::milliseconds debounce)
+  : m_on_reload(std::move(on_reload)), m_debounce(debounce) {
+  m_inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_inotify_fd < 0) {
+    throw_errno("inotify_init1");
+  }
+  m_wakeup_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeup_fd < 0) {
+    const int error = errno;
+    ::close(m_inotify_fd);
+    throw std::system_error{error, std::generic_category(), "eventfd"};
+  }
+}
+
+file_watcher::~file_watcher() {
+  ::close(m_wakeup_fd);
+  ::close(m_inotify_fd);
+}
+
+void file_watcher::set_error_callback(error_callback on_error) {
+  m_on_error = std::move(on_error);
+}
+
+const document& file_watcher::watch(const string_type& path) {
+  const std::filesystem::path absolute = std::filesystem::absolute(path);
+  const auto directory = absolute.parent_path().string();
+
+  string_type content;
+  if (!read_file(absolute.string(), content)) {
+    throw std::system_error{
+      std::make_error_code(std::errc::no_such_file_or_directory), absolute.string()};
+  }
+
+  const int wd = ::inotify_add_watch(m_inotify_fd, directory.c_str(), watch_mask);
+  if (wd < 0) {
+    throw_errno("inotify_add_watch");
+  }
+
+  auto file = std::make_unique<watched_file>(
+    watched_file{absolute.string(), incremental_document{std::move(content)}});
+  auto& slot = m_files[{wd, absolute.filename().string()}];
+  slot = std::move(file);
+  return slot->content.get();
+}
+
+std::size_t file_watcher::poll(std::chrono::milliseconds timeout) {
+  const auto deadline = clock::now() + timeout;
+  std::size_t reloads = 0;
+
+  for (;;) {
+    const auto now = clock::now();
+    auto wake = deadline;
+    for (auto& [key, file] : m_files) {
+      if (!file->pending) {
+        continue;
+      }
+      if (file->due <= now) {
+        file->pending = false;
+        reloads += reload(*file);
+      } else {
+        wake = std::min(wake, file->due);
+      }
+    }
+    if (reloads > 0 || now >= deadline || m_stopping.load()) {
+      return reloads;
+    }
+
+    pollfd fds[2] = {{m_inotify_fd, POLLIN, 0}, {m_wakeup_fd, POLLIN, 0}};
+    const auto wait = std::chrono::ceil<std::chrono::milliseconds>(wake - now);
+    if (::poll(fds, 2, static_cast<int>(wait.count())) < 0 && errno != EINTR) {
+      throw_errno("poll");
+    }
+    if (fds[1].revents & POLLIN) {
+      eventfd_t ignored;
+      ::eventfd_read(m_wakeup_fd, &ignored);
+    }
+    if (fds[0].revents & POLLIN) {
+      read_events(clock::now());
+    }
+  }
+}
+
+void file_watcher::run() {
+  while (!m_stopping.load()) {
+    poll(std::chrono::seconds{1});
+  }
+}
+
+void file_watcher::stop() noexcept {
+  m_stopping = true;
+  ::eventfd_write(m_wakeup_fd, 1);
+}
+
+void file_watcher::read_events(clock::time_point now) {
+  alignas(inotify_event) char buffer[16 * 1024];
+  for (;;) {
+    const ssize_t length = ::read(m_inotify_fd, buffer, sizeof(buffer));
+    if (length <= 0) {
+      return;
+    }
+    for (ssize_t offset = 0; offset < length;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+      if (event->mask & IN_Q_OVERFLOW) {
+        // Events were dropped: any file may have changed. Reloading an
+        // unchanged file reports nothing.
+        for (auto& [key, file] : m_files) {
+          file->pending = true;
+          file->due = now + m_debounce;
+        }
+        continue;
+      }
+      if (event->len == 0) {
+        continue;
+      }
+      const auto it = m_files.find({event->wd, string_type{event->name}});
+      if (it != m_files.end()) {
+        it->second->pending = true;
+        it->second->due = now + m_debounce;
+      }
+    }
+  }
+}
+
+bool file_watcher::reload(watched_file& file) {
+  string_type content;
+  if (!read_file(file.path, content)) {
+    // The file is being replaced; a later event reloads it.
+    return false;
+  }
+
+  try {
+    const auto summary = file.content.update(std::move(content));
+    if (!summary.changed()) {
+      return false;
+    }
+    if (m_on_reload) {
+      m_on_reload(file.path, file.content.get(), summary);
+    }
+    return true;
+  } catch (const parse_error& error) {
+    if (m_on_error) {
+      m_on_error(file.path, error);
+    }
+    return false;
+  }
+}
+
+} // namespace kdlcpp
@@ -0,0 +1,110 @@
+#include "kdlcpp/incremental_document.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace kdlcpp {
+
+namespace {
+
+/// Number of leading bytes shared by two strings.
+std::size_t common_prefix(std::string_view a, std::string_view b) noexcept {
+  const auto limit = std::min(a.size(), b.size());
+  return static_cast<std::size_t>(
+    std::mismatch(a.begin(), a.begin() + limit, b.begin()).first - a.begin());
+}
+
+/// Number of trailing bytes shared by two strings, at most limit.
+std::size_t common_suffix(std::string_view a, std::string_view b, std::size_t limit) noexcept {
+  std::size_t length = 0;
+  while (length < limit && a[a.size() - 1 - length] == b[b.size() - 1 - length]) {
+    ++length;
+  }
+  return length;
+}
+
+} // namespace
+
+incremental_document::incremental_document(string_type text)
+  : m_text(std::move(text)) {
+  detail::parse::dom_handler handler{m_document.root()};
+  detail::parse::parser<detail::parse::dom_handler> parser{m_text, handler};
+  while (parser.parse_top_level_node()) {
+    m_node_ends.push_back(parser.position());
+  }
+}
+
+const document& incremental_document::get() const noexcept {
+  return m_document;
+}
+
+const string_type& incremental_document::text() const noexcept {
+  return m_text;
+}
+
+reload_summary incremental_document::update(string_type text) {
+  reload_summary summary;
+  summary.total_bytes = text.size();
+  if (text == m_text) {
+    return summary;
+  }
+
+  const std::size_t prefix = common_prefix(m_text, text);
+  const std::size_t suffix = common_suffix(
+    m_text, text, std::min(m_text.size(), text.size()) - prefix);
+  const std::size_t new_changed_end = text.size() - suffix;
+  const auto delta = static_cast<std::ptrdiff_t>(text.size()) - static_cast<std::ptrdiff_t>(m_text.size());
+
+  // The first node that may have changed is the first one not ending
+  // strictly before the edit: its terminator may have been touched.
+  const std::size_t first = static_cast<std::size_t>(std::distance(
+    m_node_ends.begin(), std::lower_bound(m_node_ends.begin(), m_node_ends.end(), prefix)));
+  const std::size_t start = first == 0 ? 0 : m_node_ends[first - 1];
+
+  // Parse until a node ends on a boundary of the previous version past
+  // the edit: from there on both texts, and both parses, are identical.
+  node parsed{string_type{}};
+  detail::parse::dom_handler handler{parsed};
+  detail::parse::parser<detail::parse::dom_handler> parser{text, handler, start};
+  std::vector<std::size_t> parsed_ends;
+  std::size_t resync = m_node_ends.size();
+  while (parser.parse_top_level_node()) {
+    const std::size_t end = parser.position();
+    parsed_ends.push_back(end);
+    if (end < new_changed_end) {
+      continue;
+    }
+    const auto old_end = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(end) - delta);
+    const auto it = std::lower_bound(m_node_ends.begin() + first, m_node_ends.end(), old_end);
+    if (it != m_node_ends.end() && *it == old_end) {
+      resync = static_cast<std::size_t>(std::distance(m_node_ends.begin(), it)) + 1;
+      break;
+    }
+  }
+  summary.reparsed_bytes = parser.position() - start;
+
+  // Splice the re-parsed nodes in place of the ones they replace.
+  auto& nodes = m_document.root().get_children();
+  auto& inserted = parsed.get_children();
+  nodes.erase(nodes.begin() + first, nodes.begin() + resync);
+  nodes.insert(nodes.begin() + first,
+    std::make_move_iterator(inserted.begin()), std::make_move_iterator(inserted.end()));
+
+  std::vector<std::size_t> ends;
+  ends.reserve(first + parsed_ends.size() + (m_node_ends.size() - resync));
+  ends.insert(ends.end(), m_node_ends.begin(), m_node_ends.begin() + first);
+  ends.insert(ends.end(), parsed_ends.begin(), parsed_ends.end());
+  std::transform(m_node_ends.begin() + resync, m_node_ends.end(), std::back_inserter(ends),
+    [delta](std::size_t end) { return static_cast<std::size_t>(static_cast<std::ptrdiff_t>(end) + delta); });
+
+  summary.first_node = first;
+  summary.removed_nodes = resync - first;
+  summary.inserted_nodes = parsed_ends.size();
+
+  m_node_ends = std::move(ends);
+  m_text = std::move(text);
+  return summary;
+}
+
+} // namespace kdlcpp
@@ -1,33 +1,248 @@
 #include "kdlcpp/node.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <mutex>
 
 namespace kdlcpp {
 
-string_type node::get_name() const noexcept {
-  return m_name;
+/// A children block located by the lazy parser but not parsed yet.
+struct node::deferred_block {
+  deferred_block(std::shared_ptr<const string_type> source, std::size_t offset) noexcept
+    : source(std::move(source)), offset(offset) {}
+
+  std::shared_ptr<const string_type> source;
+  std::size_t offset;
+  std::once_flag parsed;
+  std::atomic<bool> done{false};
+};
+
+node::node(const string_type& name) : m_name(name) {}
+
+node::node(string_type&& name) : m_name(std::move(name)) {}
+
+node::node(const node& other)
+  : m_name(other.m_name),
+    m_arguments(other.m_arguments),
+    m_properties(other.m_properties),
+    m_shared(other.m_shared),
+    m_dirty(other.m_dirty),
+    m_serialized(other.m_serialized),
+    m_format(other.m_format) {
+  // Children still deferred stay deferred in the copy. A shared node has
+  // no block of its own: the copy reads through the same shared node.
+  if (other.m_deferred && !other.m_deferred->done.load(std::memory_order_acquire)) {
+    m_deferred = std::make_unique<deferred_block>(other.m_deferred->source, other.m_deferred->offset);
+  } else {
+    m_children = other.m_children;
+  }
+  adopt_children();
+}
+
+node::node(node&& other) noexcept
+  : m_name(std::move(other.m_name)),
+    m_arguments(std::move(other.m_arguments)),
+    m_properties(std::move(other.m_properties)),
+    m_children(std::move(other.m_children)),
+    m_deferred(std::move(other.m_deferred)),
+    m_shared(std::move(other.m_shared)),
+    m_dirty(other.m_dirty),
+    m_serialized(std::move(other.m_serialized)),
+    m_format(other.m_format) {
+  adopt_children();
+  other.m_dirty = true;
+}
+
+node& node::operator=(const node& other) {
+  if (this != &other) {
+    node copy{other};
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+node& node::operator=(node&& other) noexcept {
+  if (this != &other) {
+    const bool dirty = other.m_dirty;
+    m_name = std::move(other.m_name);
+    m_arguments = std::move(other.m_arguments);
+    m_properties = std::move(other.m_properties);
+    m_children = std::move(other.m_children);
+    m_deferred = std::move(other.m_deferred);
+    m_shared = std::move(other.m_shared);
+    m_serialized = std::move(other.m_serialized);
+    m_format = other.m_format;
+    adopt_children();
+    other.m_dirty = true;
+
+    // The node keeps its place in the tree, so its parent's bytes are stale.
+    m_dirty = dirty;
+    if (m_parent) {
+      m_parent->mark_dirty();
+    }
+  }
+  return *this;
+}
+
+node::~node() = default;
+
+const string_type& node::get_name() const noexcept {
+  return m_shared ? m_shared->m_name : m_name;
 }
 
 const arguments& node::get_arguments() const noexcept {
-  return m_arguments;
+  return m_shared ? m_shared->m_arguments : m_arguments;
 }
 
 const properties& node::get_properties() const noexcept {
-  return m_properties;
+  return m_shared ? m_shared->m_properties : m_properties;
 }
 
-const node_list& node::get_children() const noexcept {
+const node_list& node::get_children() const {
+  if (m_shared) {
+    return m_shared->get_children();
+  }
+  if (m_deferred) {
+    materialize_children();
+  }
   return m_children;
 }
 
-arguments& node::get_arguments() noexcept {
+arguments& node::get_arguments() {
+  unshare();
+  mark_dirty();
   return m_arguments;
 }
 
-properties& node::get_properties() noexcept {
+properties& node::get_properties() {
+  unshare();
+  mark_dirty();
   return m_properties;
 }
 
-node_list& node::get_children() noexcept {
+node_list& node::get_children() {
+  unshare();
+  if (m_deferred) {
+    // Nothing else can read this node now, so the text can be released.
+    materialize_children();
+    m_deferred.reset();
+  }
+  mark_dirty();
+  // The list may be moved out or swapped with another: the children
+  // report to this node again only once it is cached again.
+  release_children();
   return m_children;
 }
 
-} // namespace kdlcpp
\ No newline at end of file
+bool node::is_dirty() const noexcept {
+  return m_dirty;
+}
+
+const string_type& node::get_serialized() const noexcept {
+  return m_serialized;
+}
+
+std::uint64_t node::get_serialized_format() const noexcept {
+  return m_format;
+}
+
+void node::set_serialized(string_type bytes, std::uint64_t format) noexcept {
+  m_serialized = std::move(bytes);
+  m_format = format;
+  m_dirty = false;
+  adopt_children();
+}
+
+void node::defer_children(std::shared_ptr<const string_type> source, std::size_t offset) noexcept {
+  unshare();
+  m_children.clear();
+  m_deferred = std::make_unique<deferred_block>(std::move(source), offset);
+  mark_dirty();
+}
+
+bool node::has_deferred_children() const noexcept {
+  if (m_shared) {
+    return m_shared->has_deferred_children();
+  }
+  return m_deferred && !m_deferred->done.load(std::memory_order_acquire);
+}
+
+void node::share(std::shared_ptr<const node> target) noexcept {
+  // Release the own content, which the target duplicates: the serialized
+  // bytes stay valid.
+  m_name = string_type{};
+  m_arguments = arguments{};
+  m_properties = properties{};
+  m_children = node_list{};
+  m_deferred.reset();
+  m_shared = std::move(target);
+}
+
+const std::shared_ptr<const node>& node::get_shared() const noexcept {
+  return m_shared;
+}
+
+void node::unshare() {
+  if (!m_shared) {
+    return;
+  }
+  // Copying keeps children deferred if the shared node has not parsed them.
+  node copy{*m_shared};
+  m_shared.reset();
+  m_name = std::move(copy.m_name);
+  m_arguments = std::move(copy.m_arguments);
+  m_properties = std::move(copy.m_properties);
+  m_children = std::move(copy.m_children);
+  m_deferred = std::move(copy.m_deferred);
+  adopt_children();
+}
+
+void node::materialize_children() const {
+  std::call_once(m_deferred->parsed, [this] {
+    node scratch{string_type{}};
+    detail::parse::lazy_dom_handler handler{scratch, m_deferred->source};
+    detail::parse::parser<detail::parse::lazy_dom_handler> p{handler.source(), handler, m_deferred->offset};
+    p.parse_children_block();
+
+    m_children = std::move(scratch.m_children);
+    adopt_children();
+    m_deferred->done.store(true, std::memory_order_release);
+  });
+}
+
+void node::mark_dirty() noexcept {
+  // A dirty node always has dirty ancestors, so the walk stops early.
+  for (node* current = this; current && !current->m_dirty; current = current->m_parent) {
+    current->m_dirty = true;
+  }
+}
+
+node& node::append_child(node&& child) {
+  assert(!m_shared && !m_deferred);
+  mark_dirty();
+  return m_children.emplace_back(std::move(child));
+}
+
+void node::release_children() noexcept {
+  // Once released, the children stay so until adopted again: handing the
+  // list out repeatedly costs nothing.
+  if (!m_linked) {
+    return;
+  }
+  for (auto& child : m_children) {
+    child.m_parent = nullptr;
+  }
+  m_linked = false;
+}
+
+void node::adopt_children() const noexcept {
+  // Children only keep the address to report modifications made through
+  // mutable accessors, which a const node never hands out.
+  for (auto& child : m_children) {
+    child.m_parent = const_cast<node*>(this);
+  }
+  m_linked = true;
+}
+
+} // namespace kdlcpp
@@ -0,0 +1,174 @@
+#include "kdlcpp/overlay.hpp"
+
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace kdlcpp {
+
+namespace {
+
+/// Stands in for the layers of a node that has none.
+const node& empty_node() noexcept {
+  static const node empty{string_type{}};
+  return empty;
+}
+
+/// Finds the n-th child with a given name.
+const node* find_child(const node& parent, std::string_view name, std::size_t occurrence) {
+  for (const auto& child : parent.get_children()) {
+    if (child.get_name() == name && occurrence-- == 0) {
+      return &child;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+overlay_node::overlay_node(std::vector<const node*> layers) noexcept
+  : m_layers(std::move(layers)) {}
+
+const string_type& overlay_node::get_name() const noexcept {
+  return m_layers.empty() ? empty_node().get_name() : m_layers.front()->get_name();
+}
+
+const arguments& overlay_node::get_arguments() const noexcept {
+  for (auto layer = m_layers.rbegin(); layer != m_layers.rend(); ++layer) {
+    if ((*layer)->get_arguments().size() != 0) {
+      return (*layer)->get_arguments();
+    }
+  }
+  return empty_node().get_arguments();
+}
+
+bool overlay_node::has_property(const string_type& key) const noexcept {
+  for (const node* layer : m_layers) {
+    if (layer->get_properties().contains(key)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::optional<value> overlay_node::get_property(const string_type& key) const noexcept {
+  for (auto layer = m_layers.rbegin(); layer != m_layers.rend(); ++layer) {
+    if (auto found = (*layer)->get_properties().at(key)) {
+      return found;
+    }
+  }
+  return std::nullopt;
+}
+
+properties overlay_node::get_properties() const {
+  properties merged;
+  for (const node* layer : m_layers) {
+    for (const auto& [key, val] : layer->get_properties()) {
+      merged.insert(key, val);
+    }
+  }
+  return merged;
+}
+
+std::optional<overlay_node> overlay_node::get_child(std::string_view name, std::size_t occurrence) const {
+  std::vector<const node*> found;
+  for (const node* layer : m_layers) {
+    if (const node* child = find_child(*layer, name, occurrence)) {
+      found.push_back(child);
+    }
+  }
+  if (found.empty()) {
+    return std::nullopt;
+  }
+  return overlay_node{std::move(found)};
+}
+
+std::vector<overlay_node> overlay_node::get_children() const {
+  if (m_layers.size() == 1) {
+    std::vector<overlay_node> children;
+    children.reserve(m_layers.front()->get_children().size());
+    for (const auto& child : m_layers.front()->get_children()) {
+      children.emplace_back(std::vector<const node*>{&child});
+    }
+    return children;
+  }
+
+  // For each name, the merged children with that name, by occurrence.
+  std::vector<std::vector<const node*>> merged;
+  std::unordered_map<std::string_view, std::vector<std::size_t>> by_name;
+  for (const node* layer : m_layers) {
+    std::unordered_map<std::string_view, std::size_t> seen;
+    for (const auto& child : layer->get_children()) {
+      auto& slots = by_name[child.get_name()];
+      const std::size_t occurrence = seen[child.get_name()]++;
+      if (occurrence == slots.size()) {
+        slots.push_back(merged.size());
+        merged.emplace_back();
+      }
+      merged[slots[occurrence]].push_back(&child);
+    }
+  }
+
+  std::vector<overlay_node> children;
+  children.reserve(merged.size());
+  for (auto& layers : merged) {
+    children.emplace_back(std::move(layers));
+  }
+  return children;
+}
+
+const std::vector<const node*>& overlay_node::get_layers() const noexcept {
+  return m_layers;
+}
+
+node overlay_node::materialize() const {
+  node out{get_name()};
+  out.get_arguments() = get_arguments();
+  if (m_layers.size() == 1) {
+    out.get_properties() = m_layers.front()->get_properties();
+  } else {
+    out.get_properties() = get_properties();
+  }
+  const auto children = get_children();
+  auto& out_children = out.get_children();
+  out_children.reserve(children.size());
+  for (const auto& child : children) {
+    out_children.push_back(child.materialize());
+  }
+  return out;
+}
+
+void overlay::push_layer(const document& layer) {
+  m_layers.push_back(&layer);
+}
+
+void overlay::replace_layer(std::size_t index, const document& layer) {
+  if (index >= m_layers.size()) {
+    throw std::out_of_range("overlay layer " + std::to_string(index) + " does not exist");
+  }
+  m_layers[index] = &layer;
+}
+
+std::size_t overlay::layer_count() const noexcept {
+  return m_layers.size();
+}
+
+overlay_node overlay::root() const {
+  std::vector<const node*> roots;
+  roots.reserve(m_layers.size());
+  for (const document* layer : m_layers) {
+    roots.push_back(&layer->root());
+  }
+  return overlay_node{std::move(roots)};
+}
+
+document overlay::materialize() const {
+  document out;
+  out.set_root(root().materialize());
+  if (!m_layers.empty()) {
+    out.set_name(m_layers.back()->name());
+  }
+  return out;
+}
+
+} // namespace kdlcpp
@@ -20,6 +20,18 @@ void properties::insert(const string_type& key, const value& val) noexcept {
   m_properties_map.insert_or_assign(key, val);
 }
 
+void properties::insert(string_type&& key, value&& val) noexcept {
+  m_properties_map.insert_or_assign(std::move(key), std::move(val));
+}
+
+void properties::reserve(std::size_t count) {
+  m_properties_map.reserve(count);
+}
+
+void properties::shrink_to_fit() {
+  m_properties_map.rehash(0);
+}
+
 bool properties::erase(const string_type& key) noexcept {
   if (!contains(key))
     return false;
@@ -0,0 +1,410 @@
+#include "kdlcpp/detail/scan.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+#include <atomic>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define KDLCPP_SCAN_X86 1
+#define KDLCPP_TARGET(features) __attribute__((target(features)))
+#include <immintrin.h>
+#endif
+
+namespace kdlcpp::detail::scan {
+
+namespace {
+
+using find_function = std::size_t (*)(const unsigned char*, std::size_t, const byte_set&) noexcept;
+using validate_function = std::size_t (*)(const unsigned char*, std::size_t) noexcept;
+
+/// The scans of one instruction set.
+struct implementation {
+  isa kind;
+  find_function find_first_of;
+  validate_function validate_utf8;
+};
+
+std::size_t find_first_of_scalar(const unsigned char* data, std::size_t size, const byte_set& set) noexcept {
+  for (std::size_t i = 0; i < size; ++i) {
+    if (set.contains(data[i])) {
+      return i;
+    }
+  }
+  return size;
+}
+
+std::size_t validate_utf8_scalar(const unsigned char* data, std::size_t size) noexcept {
+  const std::string_view text{reinterpret_cast<const char*>(data), size};
+  std::size_t i = 0;
+  while (i < size) {
+    if (i + 8 <= size) {
+      std::uint64_t word = 0;
+      std::memcpy(&word, data + i, sizeof(word));
+      if ((word & 0x8080808080808080u) == 0) {
+        i += 8;
+        continue;
+      }
+    }
+    if (data[i] < 0x80) {
+      ++i;
+      continue;
+    }
+    std::size_t length = 0;
+    parse::decode_utf8(text, i, length);
+    if (length == 0) {
+      return i;
+    }
+    i += length;
+  }
+  return size;
+}
+
+/**
+ * Locates an error found in a vector block by validating again from the
+ * first sequence that may run into the block: sequences starting before
+ * the last three bytes of the previous block end before the block.
+ */
+std::size_t locate_invalid(const unsigned char* data, std::size_t size, std::size_t block) noexcept {
+  std::size_t start = block >= 3 ? block - 3 : 0;
+  while (start < block && (data[start] & 0xC0) == 0x80) {
+    ++start;
+  }
+  return start + validate_utf8_scalar(data + start, size - start);
+}
+
+#if defined(KDLCPP_SCAN_X86)
+
+// UTF-8 validation after Keiser and Lemire, "Validating UTF-8 In Less Than
+// One Instruction Per Byte": the high nibble of each byte, the low and high
+// nibbles of the byte before it are looked up in three tables whose AND
+// flags every invalid two-byte pattern, and the bytes two and three behind
+// tell where continuations are required.
+
+constexpr std::uint8_t too_short = 1 << 0;
+constexpr std::uint8_t too_long = 1 << 1;
+constexpr std::uint8_t overlong_3 = 1 << 2;
+constexpr std::uint8_t too_large = 1 << 3;
+constexpr std::uint8_t surrogate = 1 << 4;
+constexpr std::uint8_t overlong_2 = 1 << 5;
+constexpr std::uint8_t too_large_1000 = 1 << 6;
+constexpr std::uint8_t overlong_4 = 1 << 6;
+constexpr std::uint8_t two_conts = 1 << 7;
+constexpr std::uint8_t carry = too_short | too_long | two_conts;
+
+/// Indexed by the high nibble of the previous byte.
+alignas(16) constexpr std::uint8_t byte_1_high[16] = {
+  too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+  two_conts, two_conts, two_conts, two_conts,
+  too_short | overlong_2,
+  too_short,
+  too_short | overlong_3 | surrogate,
+  too_short | too_large | too_large_1000 | overlong_4};
+
+/// Indexed by the low nibble of the previous byte.
+alignas(16) constexpr std::uint8_t byte_1_low[16] = {
+  carry | overlong_3 | overlong_2 | overlong_4,
+  carry | overlong_2,
+  carry,
+  carry,
+  carry | too_large,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000 | surrogate,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000};
+
+/// Indexed by the high nibble of the current byte.
+alignas(16) constexpr std::uint8_t byte_2_high[16] = {
+  too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+  too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+  too_long | overlong_2 | two_conts | overlong_3 | too_large,
+  too_long | overlong_2 | two_conts | surrogate | too_large,
+  too_long | overlong_2 | two_conts | surrogate | too_large,
+  too_short, too_short, too_short, too_short};
+
+/// Bytes above these, in the last three positions of a block, start a
+/// sequence that continues in the next block.
+alignas(16) constexpr std::uint8_t incomplete_limits[16] = {
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xF0 - 1, 0xE0 - 1, 0xC0 - 1};
+
+/// Bit h in entry h for the high nibbles of rows[0], then of rows[1].
+alignas(16) constexpr std::uint8_t nibble_bits[2][16] = {
+  {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0, 0, 0, 0, 0, 0, 0, 0},
+  {0, 0, 0, 0, 0, 0, 0, 0, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80}};
+
+KDLCPP_TARGET("sse4.2") inline __m128i load_table_sse(const std::uint8_t* table) noexcept {
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(table));
+}
+
+/// The lookup tables of a byte_set.
+struct set_tables_sse {
+  __m128i low_rows[2];
+  __m128i high_bits[2];
+};
+
+KDLCPP_TARGET("sse4.2") inline set_tables_sse load_set_sse(const byte_set& set) noexcept {
+  return set_tables_sse{
+    {_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.rows[0])),
+     _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.rows[1]))},
+    {load_table_sse(nibble_bits[0]), load_table_sse(nibble_bits[1])}};
+}
+
+/// Flags the bytes of a chunk that belong to a set.
+KDLCPP_TARGET("sse4.2") inline int members_sse(__m128i chunk, const set_tables_sse& tables) noexcept {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i low = _mm_and_si128(chunk, nibble);
+  const __m128i high = _mm_and_si128(_mm_srli_epi16(chunk, 4), nibble);
+  const __m128i hits = _mm_or_si128(
+    _mm_and_si128(_mm_shuffle_epi8(tables.low_rows[0], low), _mm_shuffle_epi8(tables.high_bits[0], high)),
+    _mm_and_si128(_mm_shuffle_epi8(tables.low_rows[1], low), _mm_shuffle_epi8(tables.high_bits[1], high)));
+  return ~_mm_movemask_epi8(_mm_cmpeq_epi8(hits, _mm_setzero_si128())) & 0xFFFF;
+}
+
+KDLCPP_TARGET("sse4.2")
+std::size_t find_first_of_sse42(const unsigned char* data, std::size_t size, const byte_set& set) noexcept {
+  const set_tables_sse tables = load_set_sse(set);
+  std::size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    if (const int mask = members_sse(chunk, tables)) {
+      return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+  }
+  return i + find_first_of_scalar(data + i, size - i, set);
+}
+
+/// The error flags of a block, given the block before it.
+KDLCPP_TARGET("sse4.2") inline __m128i check_block_sse(__m128i input, __m128i previous) noexcept {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+  const __m128i special = _mm_and_si128(
+    _mm_and_si128(_mm_shuffle_epi8(load_table_sse(byte_1_high), _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                  _mm_shuffle_epi8(load_table_sse(byte_1_low), _mm_and_si128(prev1, nibble))),
+    _mm_shuffle_epi8(load_table_sse(byte_2_high), _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+  const __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+  const __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+  const __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+  const __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+  const __m128i continuations = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+  return _mm_xor_si128(continuations, special);
+}
+
+KDLCPP_TARGET("sse4.2")
+std::size_t validate_utf8_sse42(const unsigned char* data, std::size_t size) noexcept {
+  const __m128i limits = load_table_sse(incomplete_limits);
+  __m128i previous = _mm_setzero_si128();
+  __m128i incomplete = _mm_setzero_si128();
+  for (std::size_t i = 0; i < size; i += 16) {
+    __m128i input;
+    if (i + 16 <= size) {
+      input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    } else {
+      // The tail is padded with ASCII, which flags a sequence cut short.
+      alignas(16) unsigned char tail[16] = {};
+      std::memcpy(tail, data + i, size - i);
+      input = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+    }
+    // A sequence the previous block left incomplete is checked with the
+    // continuations by check_block, and is an error if the block is ASCII.
+    __m128i error = incomplete;
+    if (_mm_movemask_epi8(input) != 0) {
+      error = check_block_sse(input, previous);
+      incomplete = _mm_subs_epu8(input, limits);
+    } else {
+      incomplete = _mm_setzero_si128();
+    }
+    if (!_mm_testz_si128(error, error)) {
+      return locate_invalid(data, size, i);
+    }
+    previous = input;
+  }
+  if (!_mm_testz_si128(incomplete, incomplete)) {
+    return locate_invalid(data, size, (size - 1) / 16 * 16);
+  }
+  return size;
+}
+
+KDLCPP_TARGET("avx2") inline __m256i load_table_avx2(const std::uint8_t* table) noexcept {
+  return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+KDLCPP_TARGET("avx2") inline __m256i load_avx2(const unsigned char* data) noexcept {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+
+struct set_tables_avx2 {
+  __m256i low_rows[2];
+  __m256i high_bits[2];
+};
+
+KDLCPP_TARGET("avx2") inline set_tables_avx2 load_set_avx2(const byte_set& set) noexcept {
+  return set_tables_avx2{
+    {_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.rows[0]))),
+     _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.rows[1])))},
+    {load_table_avx2(nibble_bits[0]), load_table_avx2(nibble_bits[1])}};
+}
+
+/// Sets the bytes of a chunk that do not belong to a set to all ones.
+KDLCPP_TARGET("avx2") inline __m256i outside_mask_avx2(__m256i chunk, const set_tables_avx2& tables) noexcept {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i low = _mm256_and_si256(chunk, nibble);
+  const __m256i high = _mm256_and_si256(_mm256_srli_epi16(chunk, 4), nibble);
+  const __m256i hits = _mm256_or_si256(
+    _mm256_and_si256(_mm256_shuffle_epi8(tables.low_rows[0], low), _mm256_shuffle_epi8(tables.high_bits[0], high)),
+    _mm256_and_si256(_mm256_shuffle_epi8(tables.low_rows[1], low), _mm256_shuffle_epi8(tables.high_bits[1], high)));
+  return _mm256_cmpeq_epi8(hits, _mm256_setzero_si256());
+}
+
+KDLCPP_TARGET("avx2")
+std::size_t find_first_of_avx2(const unsigned char* data, std::size_t size, const byte_set& set) noexcept {
+  const set_tables_avx2 tables = load_set_avx2(set);
+  std::size_t i = 0;
+  // Two chunks at a time while nothing is found: the masks hold the bytes
+  // outside the set, so both are all ones.
+  for (; i + 64 <= size; i += 64) {
+    const __m256i outside = _mm256_and_si256(outside_mask_avx2(load_avx2(data + i), tables),
+                                             outside_mask_avx2(load_avx2(data + i + 32), tables));
+    if (static_cast<unsigned>(_mm256_movemask_epi8(outside)) != 0xFFFFFFFFu) {
+      break;
+    }
+  }
+  for (; i + 32 <= size; i += 32) {
+    const auto mask = ~static_cast<unsigned>(_mm256_movemask_epi8(outside_mask_avx2(load_avx2(data + i), tables)));
+    if (mask != 0) {
+      return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+  }
+  return i + find_first_of_scalar(data + i, size - i, set);
+}
+
+KDLCPP_TARGET("avx2") inline __m256i check_block_avx2(__m256i input, __m256i previous) noexcept {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i shifted = _mm256_permute2x128_si256(previous, input, 0x21);
+  const __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+  const __m256i special = _mm256_and_si256(
+    _mm256_and_si256(
+      _mm256_shuffle_epi8(load_table_avx2(byte_1_high), _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+      _mm256_shuffle_epi8(load_table_avx2(byte_1_low), _mm256_and_si256(prev1, nibble))),
+    _mm256_shuffle_epi8(load_table_avx2(byte_2_high), _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+  const __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+  const __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+  const __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+  const __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+  const __m256i continuations =
+    _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(continuations, special);
+}
+
+KDLCPP_TARGET("avx2")
+std::size_t validate_utf8_avx2(const unsigned char* data, std::size_t size) noexcept {
+  const __m256i limits = _mm256_inserti128_si256(
+    _mm256_set1_epi8(static_cast<char>(0xFF)), load_table_sse(incomplete_limits), 1);
+  __m256i previous = _mm256_setzero_si256();
+  __m256i incomplete = _mm256_setzero_si256();
+  for (std::size_t i = 0; i < size; i += 32) {
+    __m256i input;
+    if (i + 32 <= size) {
+      input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    } else {
+      alignas(32) unsigned char tail[32] = {};
+      std::memcpy(tail, data + i, size - i);
+      input = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+    }
+    __m256i error = incomplete;
+    if (_mm256_movemask_epi8(input) != 0) {
+      error = check_block_avx2(input, previous);
+      incomplete = _mm256_subs_epu8(input, limits);
+    } else {
+      incomplete = _mm256_setzero_si256();
+    }
+    if (!_mm256_testz_si256(error, error)) {
+      return locate_invalid(data, size, i);
+    }
+    previous = input;
+  }
+  if (!_mm256_testz_si256(incomplete, incomplete)) {
+    return locate_invalid(data, size, (size - 1) / 32 * 32);
+  }
+  return size;
+}
+
+constexpr implementation sse42_implementation{isa::sse42, find_first_of_sse42, validate_utf8_sse42};
+constexpr implementation avx2_implementation{isa::avx2, find_first_of_avx2, validate_utf8_avx2};
+
+#endif
+
+constexpr implementation scalar_implementation{isa::scalar, find_first_of_scalar, validate_utf8_scalar};
+
+const implementation* implementation_for(isa kind) noexcept {
+  switch (kind) {
+#if defined(KDLCPP_SCAN_X86)
+    case isa::avx2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") ? &avx2_implementation : nullptr;
+    case isa::sse42:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("ssse3") ? &sse42_implementation : nullptr;
+#endif
+    case isa::scalar:
+      return &scalar_implementation;
+    default:
+      return nullptr;
+  }
+}
+
+const implementation* best_implementation() noexcept {
+  for (const isa kind : {isa::avx2, isa::sse42}) {
+    if (const auto* found = implementation_for(kind)) {
+      return found;
+    }
+  }
+  return &scalar_implementation;
+}
+
+std::atomic<const implementation*> selected{nullptr};
+
+/// The selected implementation, detected on first use.
+const implementation& active() noexcept {
+  const implementation* current = selected.load(std::memory_order_relaxed);
+  if (current == nullptr) {
+    current = best_implementation();
+    selected.store(current, std::memory_order_relaxed);
+  }
+  return *current;
+}
+
+} // namespace
+
+isa active_isa() noexcept {
+  return active().kind;
+}
+
+bool is_supported(isa kind) noexcept {
+  return implementation_for(kind) != nullptr;
+}
+
+bool use_isa(isa kind) noexcept {
+  const implementation* found = implementation_for(kind);
+  if (found == nullptr) {
+    return false;
+  }
+  selected.store(found, std::memory_order_relaxed);
+  return true;
+}
+
+std::size_t find_first_of_bulk(std::string_view text, const byte_set& set) noexcept {
+  return active().find_first_of(reinterpret_cast<const unsigned char*>(text.data()), text.size(), set);
+}
+
+std::size_t validate_utf8(std::string_view text) noexcept {
+  return active().validate_utf8(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+}
+
+} // namespace kdlcpp::detail::scan
@@ -0,0 +1,144 @@
+#include "kdlcpp/shared_document.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace kdlcpp {
+
+namespace {
+
+/// Per-thread starting point for the slot scan, so that readers
+/// running on different threads rarely contend on the same slot.
+std::size_t slot_hint() noexcept {
+  static thread_local const std::size_t hint =
+    std::hash<std::thread::id>{}(std::this_thread::get_id());
+  return hint;
+}
+
+} // namespace
+
+shared_document::snapshot::snapshot(snapshot&& other) noexcept
+  : m_slot(other.m_slot), m_block(other.m_block) {
+  other.m_slot = nullptr;
+  other.m_block = nullptr;
+}
+
+shared_document::snapshot&
+shared_document::snapshot::operator=(snapshot&& other) noexcept {
+  if (this != &other) {
+    release();
+    m_slot = other.m_slot;
+    m_block = other.m_block;
+    other.m_slot = nullptr;
+    other.m_block = nullptr;
+  }
+  return *this;
+}
+
+shared_document::snapshot::~snapshot() {
+  release();
+}
+
+const document& shared_document::snapshot::get() const noexcept {
+  return m_block->doc;
+}
+
+std::uint64_t shared_document::snapshot::version() const noexcept {
+  return m_block->version;
+}
+
+void shared_document::snapshot::release() noexcept {
+  if (m_slot) {
+    m_slot->hazard.store(nullptr, std::memory_order_release);
+    m_slot->in_use.store(false, std::memory_order_release);
+    m_slot = nullptr;
+    m_block = nullptr;
+  }
+}
+
+shared_document::shared_document(document initial, std::size_t max_readers)
+  : m_current(new version_block{std::move(initial), 0}),
+    m_slots(new hazard_slot[std::max<std::size_t>(max_readers, 1)]),
+    m_slot_count(std::max<std::size_t>(max_readers, 1)) {}
+
+shared_document::~shared_document() {
+  delete m_current.load(std::memory_order_acquire);
+  for (const auto* block : m_retired) {
+    delete block;
+  }
+}
+
+shared_document::snapshot shared_document::acquire() const noexcept {
+  // Claim a free slot. Only spins when every slot is pinned.
+  hazard_slot* slot = nullptr;
+  const std::size_t start = slot_hint();
+  for (std::size_t i = 0;; ++i) {
+    auto& candidate = m_slots[(start + i) % m_slot_count];
+    if (!candidate.in_use.load(std::memory_order_relaxed) &&
+        !candidate.in_use.exchange(true, std::memory_order_acquire)) {
+      slot = &candidate;
+      break;
+    }
+    if ((i + 1) % m_slot_count == 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Announce the version, then make sure it was not retired in between.
+  const version_block* block = m_current.load(std::memory_order_seq_cst);
+  for (;;) {
+    slot->hazard.store(block, std::memory_order_seq_cst);
+    const version_block* current = m_current.load(std::memory_order_seq_cst);
+    if (current == block) {
+      break;
+    }
+    block = current;
+  }
+
+  return snapshot{slot, block};
+}
+
+std::uint64_t shared_document::publish(document&& doc) {
+  std::lock_guard<std::mutex> lock{m_writer_mutex};
+
+  const std::uint64_t version =
+    m_current.load(std::memory_order_relaxed)->version + 1;
+  const version_block* previous = m_current.exchange(
+    new version_block{std::move(doc), version}, std::memory_order_seq_cst);
+
+  m_retired.push_back(previous);
+  reclaim();
+  return version;
+}
+
+std::size_t shared_document::pending_reclamation() const {
+  std::lock_guard<std::mutex> lock{m_writer_mutex};
+  return m_retired.size();
+}
+
+void shared_document::reclaim() {
+  // Collect every announced version, then free the retired ones
+  // that nobody announced. Caller holds m_writer_mutex.
+  std::vector<const version_block*> announced;
+  announced.reserve(m_slot_count);
+  for (std::size_t i = 0; i < m_slot_count; ++i) {
+    if (const auto* block = m_slots[i].hazard.load(std::memory_order_seq_cst)) {
+      announced.push_back(block);
+    }
+  }
+  std::sort(announced.begin(), announced.end());
+
+  auto reclaimed = [&announced](const version_block* block) {
+    if (std::binary_search(announced.begin(), announced.end(), block)) {
+      return false;
+    }
+    delete block;
+    return true;
+  };
+  m_retired.erase(
+    std::remove_if(m_retired.begin(), m_retired.end(), reclaimed),
+    m_retired.end());
+}
+
+} // namespace kdlcpp
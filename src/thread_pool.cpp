@@ -0,0 +1,200 @@
+#include "kdlcpp/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace kdlcpp {
+
+namespace {
+
+/// The pool the current thread works for, and its queue in that pool.
+thread_local const thread_pool* current_pool = nullptr;
+thread_local std::size_t current_index = 0;
+
+} // namespace
+
+thread_pool::thread_pool(std::size_t threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  m_queues.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    m_queues.push_back(std::make_unique<worker_queue>());
+  }
+  m_threads.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    m_threads.emplace_back([this, i] { worker_loop(i); });
+  }
+}
+
+thread_pool::~thread_pool() {
+  {
+    std::lock_guard lock{m_mutex};
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+void thread_pool::submit(task work) {
+  const std::size_t index = current_pool == this
+    ? current_index
+    : m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+  m_pending.fetch_add(1, std::memory_order_relaxed);
+  {
+    std::lock_guard lock{m_queues[index]->mutex};
+    m_queues[index]->tasks.push_back(std::move(work));
+  }
+  {
+    // Taking the lock orders the increment with a worker about to sleep.
+    std::lock_guard lock{m_mutex};
+    m_queued.fetch_add(1, std::memory_order_release);
+  }
+  m_wake.notify_one();
+}
+
+void thread_pool::wait() {
+  for (;;) {
+    if (m_pending.load(std::memory_order_acquire) == 0) {
+      break;
+    }
+    if (run_one()) {
+      continue;
+    }
+    std::unique_lock lock{m_mutex};
+    m_idle.wait(lock, [this] {
+      return m_pending.load(std::memory_order_acquire) == 0 ||
+             m_queued.load(std::memory_order_acquire) > 0;
+    });
+  }
+
+  std::exception_ptr error;
+  {
+    std::lock_guard lock{m_mutex};
+    std::swap(error, m_error);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+bool thread_pool::run_one() {
+  const std::size_t first = current_pool == this ? current_index : 0;
+  task work;
+  if (!take(first, work)) {
+    return false;
+  }
+  execute(work);
+  return true;
+}
+
+void thread_pool::worker_loop(std::size_t index) {
+  current_pool = this;
+  current_index = index;
+
+  task work;
+  for (;;) {
+    if (take(index, work)) {
+      execute(work);
+      continue;
+    }
+    std::unique_lock lock{m_mutex};
+    m_wake.wait(lock, [this] {
+      return m_stop || m_queued.load(std::memory_order_acquire) > 0;
+    });
+    if (m_stop && m_queued.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+bool thread_pool::take(std::size_t first, task& work) {
+  if (m_queued.load(std::memory_order_acquire) == 0) {
+    return false;
+  }
+
+  {
+    // The owner works last in, first out.
+    auto& own = *m_queues[first];
+    std::lock_guard lock{own.mutex};
+    if (!own.tasks.empty()) {
+      work = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      m_queued.fetch_sub(1, std::memory_order_acq_rel);
+      return true;
+    }
+  }
+
+  // Thieves take the oldest task.
+  for (std::size_t offset = 1; offset < m_queues.size(); ++offset) {
+    auto& victim = *m_queues[(first + offset) % m_queues.size()];
+    std::lock_guard lock{victim.mutex};
+    if (!victim.tasks.empty()) {
+      work = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      m_queued.fetch_sub(1, std::memory_order_acq_rel);
+      return true;
+    }
+  }
+  return false;
+}
+
+void thread_pool::execute(task& work) noexcept {
+  try {
+    work();
+  } catch (...) {
+    std::lock_guard lock{m_mutex};
+    if (!m_error) {
+      m_error = std::current_exception();
+    }
+  }
+  work = nullptr;
+
+  if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    std::lock_guard lock{m_mutex};
+    m_idle.notify_all();
+  }
+}
+
+task_group::~task_group() {
+  try {
+    wait();
+  } catch (...) {
+  }
+}
+
+void task_group::run(thread_pool::task work) {
+  m_pending.fetch_add(1, std::memory_order_relaxed);
+  m_pool.submit([this, work = std::move(work)] {
+    try {
+      work();
+    } catch (...) {
+      std::lock_guard lock{m_mutex};
+      if (!m_error) {
+        m_error = std::current_exception();
+      }
+    }
+    m_pending.fetch_sub(1, std::memory_order_release);
+  });
+}
+
+void task_group::wait() {
+  while (m_pending.load(std::memory_order_acquire) > 0) {
+    if (!m_pool.run_one()) {
+      std::this_thread::yield();
+    }
+  }
+
+  std::exception_ptr error;
+  {
+    std::lock_guard lock{m_mutex};
+    std::swap(error, m_error);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace kdlcpp
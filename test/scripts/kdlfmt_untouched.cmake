@@ -0,0 +1,22 @@
+# Checks that kdlfmt leaves a file it cannot format without loss byte for
+# byte untouched: --write refuses it and --check skips it.
+#
+# Usage: cmake -DKDLFMT=<path> -DWORK_DIR=<dir> -DCONTENT=<text> -P kdlfmt_untouched.cmake
+
+set(input ${WORK_DIR}/input.kdl)
+file(MAKE_DIRECTORY ${WORK_DIR})
+file(WRITE ${input} "${CONTENT}\n")
+
+execute_process(COMMAND ${KDLFMT} --write -q ${input} RESULT_VARIABLE write_status ERROR_QUIET)
+file(READ ${input} written)
+if(NOT written STREQUAL "${CONTENT}\n")
+  message(FATAL_ERROR "kdlfmt --write changed the file to:\n${written}")
+endif()
+if(write_status EQUAL 0)
+  message(FATAL_ERROR "kdlfmt --write succeeded without rewriting the file")
+endif()
+
+execute_process(COMMAND ${KDLFMT} --check -q ${input} RESULT_VARIABLE check_status)
+if(NOT check_status EQUAL 0)
+  message(FATAL_ERROR "kdlfmt --check did not skip the file")
+endif()
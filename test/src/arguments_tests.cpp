@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <utility>
+
+#include "kdlcpp/arguments.hpp"
+#include "kdlcpp/detail/parse.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+
+using namespace kdlcpp;
+
+TEST(arguments, homogeneous_numbers_are_packed) {
+  arguments integrals;
+  arguments decimals;
+  for (int i = 0; i < 4; ++i) {
+    integrals.push_back(value{value::integral{i}});
+    decimals.push_back(value{i * 0.5});
+  }
+
+  EXPECT_EQ(integrals.get_storage(), arguments::storage::integral);
+  ASSERT_NE(integrals.packed_integrals(), nullptr);
+  EXPECT_EQ(*integrals.packed_integrals(), (std::vector<value::integral>{0, 1, 2, 3}));
+  EXPECT_EQ(integrals.packed_decimals(), nullptr);
+
+  EXPECT_EQ(decimals.get_storage(), arguments::storage::decimal);
+  ASSERT_NE(decimals.packed_decimals(), nullptr);
+  EXPECT_EQ(decimals.packed_decimals()->at(3), 1.5);
+  EXPECT_EQ(decimals.at(2)->get<value::decimal>(), 1.0);
+}
+
+TEST(arguments, heterogeneous_insert_falls_back_to_generic) {
+  arguments args;
+  args.push_back(value{value::integral{1}});
+  args.push_back(value{value::integral{2}});
+  args.push_back(value{2.5});
+
+  EXPECT_EQ(args.get_storage(), arguments::storage::generic);
+  EXPECT_EQ(args.packed_integrals(), nullptr);
+  ASSERT_EQ(args.size(), 3u);
+  EXPECT_EQ(args.at(1)->get<value::integral>(), 2);
+  EXPECT_EQ(args.at(2)->get<value::decimal>(), 2.5);
+
+  arguments padded;
+  padded.push_back(value{value::integral{1}});
+  padded.insert_at(2, value{value::integral{3}});
+  EXPECT_EQ(padded.get_storage(), arguments::storage::generic);
+  EXPECT_EQ(padded.at(1)->get_type(), value::type::null);
+}
+
+TEST(arguments, packed_storage_survives_same_type_edits) {
+  arguments args;
+  for (int i = 0; i < 3; ++i) {
+    args.push_back(value{value::integral{i}});
+  }
+  args.insert_at(1, value{value::integral{10}});
+  EXPECT_TRUE(args.erase(0));
+  EXPECT_FALSE(args.erase(5));
+
+  EXPECT_EQ(args.get_storage(), arguments::storage::integral);
+  EXPECT_EQ(*args.packed_integrals(), (std::vector<value::integral>{10, 2}));
+
+  std::vector<value::integral> seen;
+  for (const auto& arg : std::as_const(args)) {
+    seen.push_back(*arg.get<value::integral>());
+  }
+  EXPECT_EQ(seen, (std::vector<value::integral>{10, 2}));
+  EXPECT_EQ(args.get_storage(), arguments::storage::integral);
+
+  seen.clear();
+  for (const auto& arg : args) {
+    EXPECT_EQ(arg.get_type(), value::type::integral);
+    seen.push_back(*arg.get<value::integral>());
+  }
+  EXPECT_EQ(seen, (std::vector<value::integral>{10, 2}));
+  EXPECT_EQ(args.get_storage(), arguments::storage::integral);
+
+  for (auto&& arg : args) {
+    arg.set(value::integral{7});
+  }
+  EXPECT_EQ(args.get_storage(), arguments::storage::integral);
+  EXPECT_EQ(*args.packed_integrals(), (std::vector<value::integral>{7, 7}));
+
+  for (auto&& arg : args) {
+    arg = value{value::string{"x"}};
+  }
+  EXPECT_EQ(args.get_storage(), arguments::storage::generic);
+  EXPECT_EQ(args.at(1)->get<value::string>(), "x");
+  EXPECT_EQ((*args.begin()).get<value::string>(), "x");
+}
+
+TEST(arguments, packed_arguments_round_trip) {
+  node n{"samples"};
+  n.get_arguments().push_back(value{1.0});
+  n.get_arguments().push_back(value{2.5});
+  n.get_arguments().push_back(value{-3.75});
+
+  stream<std::stringstream> out{std::stringstream{}};
+  detail::serialize::serialize_node(out, n);
+  EXPECT_EQ(out.get().str(), "samples 1.0 2.5 -3.75 {\n\n}\n");
+
+  const auto doc = detail::parse::parse_document(out.get().str());
+  const auto& args = doc.root().get_children().front().get_arguments();
+  ASSERT_NE(args.packed_decimals(), nullptr);
+  EXPECT_EQ(*args.packed_decimals(), (std::vector<value::decimal>{1.0, 2.5, -3.75}));
+}
+
+TEST(arguments, reserve_survives_first_argument) {
+  arguments args;
+  args.reserve(16);
+  args.push_back(value{1.5});
+  ASSERT_NE(args.packed_decimals(), nullptr);
+  EXPECT_GE(args.packed_decimals()->capacity(), 16u);
+  args.shrink_to_fit();
+  EXPECT_EQ(args.packed_decimals()->capacity(), 1u);
+}
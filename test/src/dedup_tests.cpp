@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <sstream>
+
+#include "kdlcpp/dedup.hpp"
+#include "kdlcpp/detail/parse.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+
+using namespace kdlcpp;
+
+namespace {
+
+const char* const route_table =
+  "route \"/a\" {\n  retry-policy attempts=3 backoff=\"exponential-with-jitter\" { limit 30.5 }\n}\n"
+  "route \"/b\" {\n  retry-policy attempts=3 backoff=\"exponential-with-jitter\" { limit 30.5 }\n}\n"
+  "route \"/c\" {\n  retry-policy attempts=4 backoff=\"exponential-with-jitter\" { limit 30.5 }\n}\n";
+
+string_type to_text(const document& doc) {
+  stream<std::stringstream> out{std::stringstream{}};
+  detail::serialize::serialize_document(out, doc);
+  return out.get().str();
+}
+
+} // namespace
+
+TEST(dedup, shares_identical_subtrees) {
+  auto doc = detail::parse::parse_document(route_table);
+  const auto before = to_text(doc);
+
+  const auto summary = deduplicate(doc);
+  EXPECT_EQ(to_text(doc), before);
+  EXPECT_GE(summary.shared_subtrees, 1u);
+  EXPECT_GT(summary.bytes_saved, 0u);
+
+  const auto& routes = std::as_const(doc).root().get_children();
+  const auto& a = routes[0].get_children()[0];
+  const auto& b = routes[1].get_children()[0];
+  const auto& c = routes[2].get_children()[0];
+  ASSERT_NE(a.get_shared(), nullptr);
+  EXPECT_EQ(a.get_shared(), b.get_shared());
+  EXPECT_NE(c.get_shared(), a.get_shared());
+  EXPECT_EQ(a.get_properties().at("backoff")->get<value::string>(), "exponential-with-jitter");
+}
+
+TEST(dedup, copies_shared_subtree_on_write) {
+  auto doc = detail::parse::parse_document(route_table);
+  deduplicate(doc);
+
+  auto& policy = doc.root().get_children()[0].get_children()[0];
+  policy.get_children()[0].get_arguments().insert_at(0, value{1.0});
+  EXPECT_EQ(policy.get_shared(), nullptr);
+
+  const auto& other = std::as_const(doc).root().get_children()[1].get_children()[0];
+  EXPECT_NE(other.get_shared(), nullptr);
+  EXPECT_EQ(other.get_children()[0].get_arguments().at(0)->get<value::decimal>(), 30.5);
+  EXPECT_EQ(policy.get_children()[0].get_arguments().at(0)->get<value::decimal>(), 1.0);
+}
+
+TEST(dedup, later_passes_reuse_shared_subtrees) {
+  auto doc = detail::parse::parse_document(route_table);
+  deduplicate(doc);
+
+  const auto policy = std::as_const(doc).root().get_children()[0].get_children()[0].get_shared();
+  doc.root().get_children().push_back(detail::parse::parse_document(route_table).root().get_children()[2]);
+  const auto before = to_text(doc);
+
+  // The new route duplicates the third one, whose policy was not shared yet.
+  const auto summary = deduplicate(doc);
+  EXPECT_EQ(to_text(doc), before);
+  EXPECT_GE(summary.shared_subtrees, 1u);
+
+  const auto& routes = std::as_const(doc).root().get_children();
+  EXPECT_EQ(routes[0].get_children()[0].get_shared(), policy);
+  EXPECT_EQ(routes[1].get_children()[0].get_shared(), policy);
+  ASSERT_NE(routes[3].get_shared(), nullptr);
+  EXPECT_EQ(routes[3].get_shared(), routes[2].get_shared());
+}
+
+TEST(dedup, copies_reference_to_lazily_parsed_node) {
+  const auto doc = detail::parse::parse_document_lazy("policy attempts=3 { limit 30.5 }\n");
+  const auto target = std::make_shared<const node>(doc.root().get_children()[0]);
+  ASSERT_TRUE(target->has_deferred_children());
+
+  node reference{string_type{}};
+  reference.share(target);
+  const node copy{reference};
+  EXPECT_EQ(copy.get_shared(), target);
+  EXPECT_EQ(copy.get_name(), "policy");
+  ASSERT_EQ(copy.get_children().size(), 1u);
+  EXPECT_EQ(copy.get_children()[0].get_arguments().at(0)->get<value::decimal>(), 30.5);
+
+  node owned{reference};
+  owned.get_properties().insert("attempts", value{value::integral{4}});
+  EXPECT_EQ(owned.get_shared(), nullptr);
+  EXPECT_EQ(owned.get_children().size(), 1u);
+  EXPECT_EQ(target->get_properties().at("attempts")->get<value::integral>(), 3);
+}
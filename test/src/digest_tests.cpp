@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "kdlcpp/digest.hpp"
+#include "kdlcpp/detail/parse.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+#include "kdlcpp/detail/sha256.hpp"
+
+using namespace kdlcpp;
+
+namespace {
+
+string_type sha256_hex(std::string_view data, std::size_t piece) {
+  detail::sha256 hash;
+  for (std::size_t i = 0; i < data.size(); i += piece) {
+    hash.update(data.substr(i, piece));
+  }
+  return to_hex(hash.finish());
+}
+
+string_type canonical_text(const document& doc) {
+  serialize_options options;
+  options.output_style = serialize_options::style::canonical;
+  stream<std::stringstream> out{std::stringstream{}};
+  detail::serialize::serialize_document(out, doc, options);
+  return out.get().str();
+}
+
+} // namespace
+
+TEST(sha256, matches_reference_vectors) {
+  const string_type two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  for (const std::size_t piece : {1, 7, 64, 1000}) {
+    EXPECT_EQ(sha256_hex("", piece), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(sha256_hex("abc", piece), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(sha256_hex(two_blocks, piece), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+  }
+  EXPECT_EQ(sha256_hex(string_type(1000000, 'a'), 4096),
+            "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+TEST(canonical, writes_sorted_minimal_output) {
+  const auto doc = detail::parse::parse_document(
+    "\"node\" \"plain\" \"two words\" 0x10 1.50 1e2 zeta=#true alpha=\"a\" mid=-0 {\n"
+    "  child\n"
+    "}\n");
+  EXPECT_EQ(canonical_text(doc), "node plain \"two words\" 16 1.5 100.0 alpha=a mid=0 zeta=#true{child}\n");
+}
+
+TEST(canonical, digest_is_independent_of_insertion_order) {
+  document first;
+  document second;
+  first.root().get_children().emplace_back("n");
+  second.root().get_children().emplace_back("n");
+  for (int i = 0; i < 64; ++i) {
+    first.root().get_children()[0].get_properties().insert("k" + std::to_string(i), value{i});
+    second.root().get_children()[0].get_properties().insert("k" + std::to_string(63 - i), value{63 - i});
+  }
+  second.set_name("ignored");
+
+  EXPECT_EQ(canonical_text(first), canonical_text(second));
+  EXPECT_EQ(canonical_digest(first), canonical_digest(second));
+  EXPECT_EQ(to_hex(canonical_digest(first)), sha256_hex(canonical_text(first), 1));
+
+  second.root().get_children()[0].get_properties().insert("k0", value{1});
+  EXPECT_NE(canonical_digest(first), canonical_digest(second));
+}
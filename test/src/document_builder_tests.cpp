@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "kdlcpp/document_builder.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+
+using namespace kdlcpp;
+
+TEST(document_builder, matches_node_api) {
+  document expected;
+  node server{"server"};
+  server.get_arguments().push_back(value{8080});
+  server.get_properties().insert("host", value{string_type{"local"}});
+  node route{"route"};
+  route.get_arguments().push_back(value{string_type{"/"}});
+  server.get_children().push_back(route);
+  server.get_children().emplace_back("leaf");
+  expected.root().get_children().push_back(server);
+  expected.root().get_children().emplace_back("last");
+
+  document_builder builder{2};
+  builder.begin_node("server", {2, 1, 1}).arg(value{8080}).prop("host", value{string_type{"local"}});
+  builder.begin_node("route").arg(value{string_type{"/"}}).end_node();
+  builder.begin_node("leaf").end_node();
+  builder.end_node();
+  EXPECT_EQ(builder.depth(), 0u);
+  builder.begin_node("last").end_node();
+
+  stream<std::stringstream> built{std::stringstream{}};
+  detail::serialize::serialize_document(built, builder.finish());
+  stream<std::stringstream> wanted{std::stringstream{}};
+  detail::serialize::serialize_document(wanted, expected);
+  EXPECT_EQ(built.get().str(), wanted.get().str());
+  EXPECT_TRUE(builder.finish().root().get_children().empty());
+}
+
+TEST(document_builder, finish_fits_storage_exactly) {
+  document doc;
+  {
+    document_builder builder;
+    builder.begin_node("numbers", {0, 8, 0});
+    builder.arg(value{1});
+    EXPECT_EQ(builder.depth(), 1u);
+    builder.end_node();
+    builder.begin_node("parent", {10, 0, 0}).begin_node("child").end_node().end_node();
+    doc = builder.finish();
+  }
+  const auto& top = std::as_const(doc).root().get_children();
+  ASSERT_EQ(top.size(), 2u);
+  ASSERT_NE(top[0].get_arguments().packed_integrals(), nullptr);
+  EXPECT_EQ(top[0].get_arguments().packed_integrals()->capacity(), 1u);
+  EXPECT_EQ(top[1].get_children().capacity(), 1u);
+  EXPECT_EQ(top.capacity(), 2u);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "kdlcpp/emitter.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+
+TEST(emitter, matches_tree_serialization) {
+  node server{"server"};
+  server.get_arguments().push_back(value{8080});
+  server.get_properties().insert("host name", value{string_type{"local\"host"}});
+  node route{"route"};
+  route.get_arguments().push_back(value{2.5});
+  route.get_arguments().push_back(value{value::null});
+  server.get_children().push_back(route);
+  server.get_children().emplace_back("leaf");
+
+  stream<std::stringstream> expected{std::stringstream{}};
+  detail::serialize::serialize_node(expected, server);
+
+  stream<std::stringstream> out{std::stringstream{}};
+  {
+    emitter<std::stringstream> writer{out};
+    writer.begin_node("server").arg(value{8080}).prop("host name", value{string_type{"local\"host"}});
+    writer.begin_children();
+    writer.begin_node("route").arg(value{2.5}).arg(value{value::null}).end_node();
+    writer.begin_node("leaf").end_node();
+    writer.end_node();
+    EXPECT_EQ(writer.depth(), 0u);
+  }
+  EXPECT_EQ(out.get().str(), expected.get().str());
+}
+
+TEST(emitter, buffers_until_flushed) {
+  stream<std::stringstream> out{std::stringstream{}};
+  emitter<std::stringstream> writer{out, {}, 256};
+
+  writer.begin_node("first").arg(value{1}).end_node();
+  EXPECT_TRUE(out.get().str().empty());
+
+  for (int i = 0; i < 100; ++i) {
+    writer.begin_node("n").arg(value{i}).end_node();
+  }
+  EXPECT_FALSE(out.get().str().empty());
+
+  writer.flush();
+  const auto doc = detail::parse::parse_document(out.get().str());
+  ASSERT_EQ(doc.root().get_children().size(), 101u);
+  EXPECT_EQ(doc.root().get_children().back().get_arguments().at(0)->get<value::integral>(), 99);
+}
+
+#ifndef NDEBUG
+TEST(emitter, asserts_on_invalid_nesting) {
+  const auto misuse = [](auto action) {
+    stream<std::stringstream> out{std::stringstream{}};
+    emitter<std::stringstream> writer{out};
+    action(writer);
+  };
+  EXPECT_DEATH(misuse([](auto& w) { w.arg(value{1}); }), "");
+  EXPECT_DEATH(misuse([](auto& w) { w.end_node(); }), "");
+  EXPECT_DEATH(misuse([](auto& w) { w.begin_node("a").begin_node("b"); }), "");
+  EXPECT_DEATH(misuse([](auto& w) { w.begin_node("a").begin_children().arg(value{1}); }), "");
+}
+#endif
+
+TEST(emitter, matches_tree_serialization_in_every_style) {
+  node root{"root"};
+  root.get_arguments().push_back(value{1});
+  root.get_children().emplace_back("a");
+  root.get_children().emplace_back("b");
+  root.get_children().back().get_children().emplace_back("c");
+  root.get_children().back().get_properties().insert("k", value{true});
+
+  for (const auto style : {serialize_options::style::compact, serialize_options::style::pretty}) {
+    serialize_options options;
+    options.output_style = style;
+    stream<std::stringstream> expected{std::stringstream{}};
+    detail::serialize::serialize_node(expected, root, options);
+    detail::serialize::serialize_node(expected, root, options);
+
+    stream<std::stringstream> out{std::stringstream{}};
+    {
+      emitter<std::stringstream> writer{out, options};
+      for (int i = 0; i < 2; ++i) {
+        writer.begin_node("root").arg(value{1}).begin_children();
+        writer.begin_node("a").end_node();
+        writer.begin_node("b").prop("k", value{true}).begin_children();
+        writer.begin_node("c").end_node();
+        writer.end_node().end_node();
+      }
+    }
+    EXPECT_EQ(out.get().str(), expected.get().str());
+  }
+}
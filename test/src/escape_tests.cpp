@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "kdlcpp/detail/escape.hpp"
+
+using namespace kdlcpp;
+using namespace kdlcpp::detail::escape;
+
+TEST(escape, classifies_identifiers) {
+  EXPECT_EQ(classify("node"), string_class::identifier);
+  EXPECT_EQ(classify("retry-policy.v2"), string_class::identifier);
+  EXPECT_EQ(classify("a-rather-long-identifier-spanning-chunks"), string_class::identifier);
+  EXPECT_EQ(classify("-"), string_class::identifier);
+  EXPECT_EQ(classify("-.x"), string_class::identifier);
+}
+
+TEST(escape, classifies_strings_needing_quotes) {
+  EXPECT_EQ(classify(""), string_class::plain);
+  EXPECT_EQ(classify("two words"), string_class::plain);
+  EXPECT_EQ(classify("1abc"), string_class::plain);
+  EXPECT_EQ(classify("-1"), string_class::plain);
+  EXPECT_EQ(classify("+.5"), string_class::plain);
+  EXPECT_EQ(classify("true"), string_class::plain);
+  EXPECT_EQ(classify("nan"), string_class::plain);
+  EXPECT_EQ(classify("key=value"), string_class::plain);
+  EXPECT_EQ(classify("a long string with a # somewhere past sixteen bytes"), string_class::plain);
+}
+
+TEST(escape, classifies_strings_needing_escapes) {
+  EXPECT_EQ(classify("quote\"d"), string_class::escaped);
+  EXPECT_EQ(classify("back\\slash"), string_class::escaped);
+  EXPECT_EQ(classify("a string that ends with a newline past sixteen bytes\n"), string_class::escaped);
+  EXPECT_EQ(classify("caf\xC3\xA9"), string_class::escaped);
+}
+
+TEST(escape, finds_first_escape) {
+  const std::string clean(40, 'x');
+  EXPECT_EQ(find_escape(clean), clean.size());
+  for (std::size_t i = 0; i < clean.size(); ++i) {
+    std::string text = clean;
+    text[i] = '"';
+    EXPECT_EQ(find_escape(text), i);
+  }
+}
+
+TEST(escape, escapes_code_points) {
+  string_type out;
+  EXPECT_EQ(escape_code_point("\"x", out), 1u);
+  EXPECT_EQ(out, "\\\"");
+  EXPECT_EQ(escape_code_point("\n", out), 1u);
+  EXPECT_EQ(out, "\\n");
+  EXPECT_EQ(escape_code_point("\x01", out), 1u);
+  EXPECT_EQ(out, "\\u{1}");
+  EXPECT_EQ(escape_code_point("\xC3\xA9", out), 2u);
+  EXPECT_EQ(out, "\xC3\xA9");
+  EXPECT_EQ(escape_code_point("\xE2\x80\xA8", out), 3u);
+  EXPECT_EQ(out, "\\u{2028}");
+  EXPECT_EQ(escape_code_point("\xFF", out), 1u);
+  EXPECT_EQ(out, "\\u{fffd}");
+}
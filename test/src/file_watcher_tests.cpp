@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "kdlcpp/file_watcher.hpp"
+
+using namespace kdlcpp;
+
+namespace {
+
+class file_watcher_test : public ::testing::Test {
+protected:
+  void SetUp() override {
+    m_directory = std::filesystem::temp_directory_path() /
+      ("kdlcpp_watcher_" + std::to_string(::getpid()));
+    std::filesystem::create_directories(m_directory);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(m_directory);
+  }
+
+  string_type write(const string_type& name, const string_type& content) {
+    const auto path = (m_directory / name).string();
+    std::ofstream{path, std::ios::binary | std::ios::trunc} << content;
+    return path;
+  }
+
+  std::filesystem::path m_directory;
+};
+
+} // namespace
+
+TEST_F(file_watcher_test, reloads_modified_file) {
+  const auto path = write("config.kdl", "a 1\nb 2\n");
+
+  std::size_t calls = 0;
+  reload_summary last;
+  file_watcher watcher{[&](const string_type&, const document& doc, const reload_summary& summary) {
+    ++calls;
+    last = summary;
+    EXPECT_EQ(doc.root().get_children().at(1).get_arguments().at(0)->get<value::integral>(), 5);
+  }, std::chrono::milliseconds{20}};
+
+  EXPECT_EQ(watcher.watch(path).root().get_children().size(), 2u);
+
+  write("config.kdl", "a 1\nb 3\n");
+  write("config.kdl", "a 1\nb 5\n");
+  EXPECT_EQ(watcher.poll(std::chrono::milliseconds{2000}), 1u);
+  EXPECT_EQ(calls, 1u);
+  EXPECT_EQ(last.first_node, 1u);
+  EXPECT_EQ(last.inserted_nodes, 1u);
+}
+
+TEST_F(file_watcher_test, handles_renames_and_errors) {
+  const auto path = write("config.kdl", "a 1\n");
+
+  std::size_t reloads = 0;
+  std::size_t errors = 0;
+  file_watcher watcher{[&](const string_type&, const document&, const reload_summary&) {
+    ++reloads;
+  }, std::chrono::milliseconds{10}};
+  watcher.set_error_callback([&](const string_type&, const parse_error&) { ++errors; });
+  watcher.watch(path);
+
+  const auto temporary = write("config.kdl.tmp", "a 2\n");
+  std::filesystem::rename(temporary, path);
+  EXPECT_EQ(watcher.poll(std::chrono::milliseconds{2000}), 1u);
+
+  write("config.kdl", "a {\n");
+  EXPECT_EQ(watcher.poll(std::chrono::milliseconds{200}), 0u);
+  EXPECT_EQ(reloads, 1u);
+  EXPECT_EQ(errors, 1u);
+}
+
+TEST_F(file_watcher_test, reloads_every_file_after_queue_overflow) {
+  std::size_t limit = 0;
+  std::ifstream{"/proc/sys/fs/inotify/max_queued_events"} >> limit;
+  if (limit == 0 || limit > 1u << 20) {
+    GTEST_SKIP() << "inotify queue size unknown or too large to overflow";
+  }
+  const auto path = write("config.kdl", "a 1\n");
+
+  std::size_t reloads = 0;
+  file_watcher watcher{[&](const string_type&, const document&, const reload_summary&) {
+    ++reloads;
+  }, std::chrono::milliseconds{10}};
+  watcher.watch(path);
+
+  // Every rewrite queues a modification and a close event.
+  for (std::size_t i = 0; i < limit; ++i) {
+    write("noise.kdl", "n");
+  }
+  // Queued after the overflow, this event is dropped.
+  write("config.kdl", "a 2\n");
+  EXPECT_EQ(watcher.poll(std::chrono::milliseconds{2000}), 1u);
+  EXPECT_EQ(reloads, 1u);
+}
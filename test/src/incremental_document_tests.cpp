@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <iterator>
+
+#include "kdlcpp/incremental_document.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+
+namespace {
+
+std::vector<string_type> names(const document& doc) {
+  std::vector<string_type> result;
+  for (const auto& n : doc.root().get_children()) {
+    result.push_back(n.get_name());
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(incremental_document, reparses_only_the_edited_node) {
+  incremental_document doc{"a 1\nb 2\nc 3\nd 4\n"};
+
+  const auto summary = doc.update("a 1\nb 20\nc 3\nd 4\n");
+  EXPECT_EQ(summary.first_node, 1u);
+  EXPECT_EQ(summary.removed_nodes, 1u);
+  EXPECT_EQ(summary.inserted_nodes, 1u);
+  EXPECT_EQ(summary.reparsed_bytes, 5u);
+  const value::integral expected[] = {1, 20, 3, 4};
+  const auto& children = doc.get().root().get_children();
+  ASSERT_EQ(children.size(), std::size(expected));
+  for (std::size_t i = 0; i < children.size(); ++i) {
+    EXPECT_EQ(children[i].get_arguments().at(0)->get<value::integral>(), expected[i]);
+  }
+}
+
+TEST(incremental_document, handles_inserted_removed_and_merged_nodes) {
+  incremental_document doc{"a 1\nb 2\nc 3\n"};
+
+  auto summary = doc.update("a 1\nb 2\nx 9\nc 3\n");
+  EXPECT_EQ(names(doc.get()), (std::vector<string_type>{"a", "b", "x", "c"}));
+  EXPECT_LE(summary.removed_nodes, 1u);
+
+  summary = doc.update("a 1\nc 3\n");
+  EXPECT_EQ(names(doc.get()), (std::vector<string_type>{"a", "c"}));
+
+  // Removing a terminator merges two nodes into one.
+  summary = doc.update("a 1 c 3\n");
+  EXPECT_EQ(names(doc.get()), (std::vector<string_type>{"a"}));
+  EXPECT_EQ(doc.get().root().get_children().front().get_arguments().size(), 3u);
+
+  // Appending at the end of an unterminated node extends it.
+  doc.update("a 1");
+  doc.update("a 1 2");
+  EXPECT_EQ(doc.get().root().get_children().front().get_arguments().size(), 2u);
+}
+
+TEST(incremental_document, resynchronizes_after_context_changes) {
+  incremental_document doc{"a 1\nb 2\nc 3\nd 4\n"};
+
+  doc.update("a 1\n/* b 2\nc 3\n*/ d 4\n");
+  EXPECT_EQ(names(doc.get()), (std::vector<string_type>{"a", "d"}));
+
+  doc.update("a 1\nb 2 \\\nc 3\nd 4\n");
+  EXPECT_EQ(names(doc.get()), (std::vector<string_type>{"a", "b", "d"}));
+}
+
+TEST(incremental_document, matches_full_parse) {
+  const std::vector<string_type> versions = {
+    "node 1 {\n  child 2\n}\nother 3\n",
+    "node 1 {\n  child 2\n  child 5\n}\nother 3\n",
+    "/-node 1 {\n  child 2\n  child 5\n}\nother 3\n",
+    "other 3\n",
+    "other 3\nnode 7; tail 8",
+    "other 3\nnode 7; tail 8 // comment\n",
+  };
+
+  incremental_document doc{versions.front()};
+  for (const auto& text : versions) {
+    doc.update(text);
+    const auto full = detail::parse::parse_document(text);
+    EXPECT_EQ(names(doc.get()), names(full)) << text;
+  }
+}
+
+TEST(incremental_document, keeps_previous_version_on_error) {
+  incremental_document doc{"a 1\nb 2\n"};
+
+  EXPECT_THROW(doc.update("a 1\nb {\n"), parse_error);
+  EXPECT_EQ(doc.text(), "a 1\nb 2\n");
+  EXPECT_EQ(names(doc.get()), (std::vector<string_type>{"a", "b"}));
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "kdlcpp/jik.hpp"
+
+using namespace kdlcpp;
+
+namespace {
+
+string_type to_json(std::string_view kdl) {
+  stream<std::stringstream> out{std::stringstream{}};
+  kdl_to_json(kdl, out);
+  return out.get().str();
+}
+
+string_type to_kdl(std::string_view json) {
+  stream<std::stringstream> out{std::stringstream{}};
+  json_to_kdl(json, out);
+  return out.get().str();
+}
+
+} // namespace
+
+TEST(kdl_to_json, converts_each_node_shape) {
+  EXPECT_EQ(to_json("- 1"), "1");
+  EXPECT_EQ(to_json("- \"a\\\"b\\n\""), "\"a\\\"b\\n\"");
+  EXPECT_EQ(to_json("- #null"), "null");
+  EXPECT_EQ(to_json("- 1 2.5 #true"), "[1,2.5,true]");
+  EXPECT_EQ(to_json("(array)- 1"), "[1]");
+  EXPECT_EQ(to_json("(array)-"), "[]");
+  EXPECT_EQ(to_json("(object)-"), "{}");
+  EXPECT_EQ(to_json("- a=1 b=\"x\""), "{\"a\":1,\"b\":\"x\"}");
+  EXPECT_EQ(to_json("- 1 { - 2; - a=3 }"), "[1,2,{\"a\":3}]");
+  EXPECT_EQ(to_json("- { name \"kdl\"; tags 1 2; nested { - #false } }"),
+            "{\"name\":\"kdl\",\"tags\":[1,2],\"nested\":[false]}");
+  EXPECT_EQ(to_json("(object)- { - 1 }"), "{\"-\":1}");
+}
+
+TEST(kdl_to_json, rejects_invalid_documents) {
+  EXPECT_THROW(to_json(""), jik_error);
+  EXPECT_THROW(to_json("- 1\n- 2"), jik_error);
+  EXPECT_THROW(to_json("-"), jik_error);
+  EXPECT_THROW(to_json("- 1 a=2"), jik_error);
+  EXPECT_THROW(to_json("- { - 1; a 2 }"), jik_error);
+  EXPECT_THROW(to_json("(object)- 1"), jik_error);
+  EXPECT_THROW(to_json("(array)- a=1"), jik_error);
+  EXPECT_THROW(to_json("- #inf"), jik_error);
+  EXPECT_THROW(to_json("- {"), parse_error);
+}
+
+TEST(json_to_kdl, round_trips_through_kdl) {
+  const std::string_view json =
+    "{\"name\":\"kdl\",\"count\":3,\"ratio\":0.5,\"ok\":true,\"none\":null,"
+    "\"list\":[1,\"two\",{\"three\":3},4,[]],\"single\":[5],\"empty\":{},"
+    "\"-\":\"dash\",\"text\":\"tab\\tquote\\\"\"}";
+  const auto kdl = to_kdl(json);
+  EXPECT_EQ(to_json(kdl), json);
+  EXPECT_EQ(to_kdl("7"), "- 7\n");
+  EXPECT_EQ(to_json(to_kdl("\"\\u00e9\\ud83d\\ude00\"")), "\"\u00e9\U0001F600\"");
+  EXPECT_EQ(to_json(to_kdl("[[1,2],[]]")), "[[1,2],[]]");
+}
+
+TEST(json_to_kdl, reads_numbers_and_reports_errors) {
+  EXPECT_EQ(to_json(to_kdl("[-0,1e2,12345678901234567890,-9223372036854775808]")),
+            "[0,100.0,12345678901234567168.0,-9223372036854775808]");
+
+  EXPECT_THROW(to_kdl(""), parse_error);
+  EXPECT_THROW(to_kdl("[1,]"), parse_error);
+  EXPECT_THROW(to_kdl("{\"a\" 1}"), parse_error);
+  EXPECT_THROW(to_kdl("01"), parse_error);
+  EXPECT_THROW(to_kdl("\"\\ud800\""), parse_error);
+  EXPECT_THROW(to_kdl("1 2"), parse_error);
+  try {
+    to_kdl("[1,\n tru]");
+    FAIL();
+  } catch (const parse_error& e) {
+    EXPECT_EQ(e.line(), 2u);
+    EXPECT_EQ(e.column(), 2u);
+  }
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include "kdlcpp/overlay.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+
+namespace {
+
+const char* const base_text =
+  "server \"base.example\" 8080 timeout=30 retries=3 {\n"
+  "  route \"/\" weight=1\n"
+  "  route \"/api\" weight=2\n"
+  "  tls enabled=#false\n"
+  "}\n"
+  "logging level=\"info\"\n";
+
+const char* const region_text =
+  "server timeout=10 {\n"
+  "  route weight=5\n"
+  "  tls enabled=#true\n"
+  "}\n"
+  "region \"eu-west\"\n";
+
+const char* const host_text =
+  "server \"host.example\" {\n"
+  "  route \"/\"\n"
+  "  route \"/api\"\n"
+  "  route \"/debug\" weight=0\n"
+  "}\n";
+
+} // namespace
+
+TEST(overlay, resolves_lookups_across_layers) {
+  const auto base = detail::parse::parse_document(base_text);
+  const auto region = detail::parse::parse_document(region_text);
+  const auto host = detail::parse::parse_document(host_text);
+  overlay view;
+  view.push_layer(base);
+  view.push_layer(region);
+  view.push_layer(host);
+  ASSERT_EQ(view.layer_count(), 3u);
+
+  const auto server = view.root().get_child("server");
+  ASSERT_TRUE(server.has_value());
+  EXPECT_EQ(server->get_layers().size(), 3u);
+  ASSERT_EQ(server->get_arguments().size(), 1u);
+  EXPECT_EQ(server->get_arguments().at(0)->get<value::string>(), "host.example");
+  EXPECT_EQ(server->get_property("timeout")->get<value::integral>(), 10);
+  EXPECT_EQ(server->get_property("retries")->get<value::integral>(), 3);
+  EXPECT_FALSE(server->get_property("missing").has_value());
+  EXPECT_TRUE(server->has_property("retries"));
+  EXPECT_EQ(server->get_properties().size(), 2u);
+
+  const auto first = server->get_child("route");
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(first->get_arguments().at(0)->get<value::string>(), "/");
+  EXPECT_EQ(first->get_property("weight")->get<value::integral>(), 5);
+  const auto second = server->get_child("route", 1);
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(second->get_layers().size(), 2u);
+  EXPECT_EQ(second->get_property("weight")->get<value::integral>(), 2);
+  EXPECT_EQ(server->get_child("route", 2)->get_layers().size(), 1u);
+  EXPECT_FALSE(server->get_child("route", 3).has_value());
+  EXPECT_EQ(server->get_child("tls")->get_property("enabled")->get<value::boolean>(), true);
+
+  EXPECT_EQ(view.root().get_child("region")->get_arguments().at(0)->get<value::string>(), "eu-west");
+  EXPECT_FALSE(view.root().get_child("absent").has_value());
+}
+
+TEST(overlay, merges_children_in_layer_order) {
+  const auto base = detail::parse::parse_document(base_text);
+  const auto region = detail::parse::parse_document(region_text);
+  const auto host = detail::parse::parse_document(host_text);
+  overlay view;
+  view.push_layer(base);
+  view.push_layer(region);
+  view.push_layer(host);
+
+  const auto top = view.root().get_children();
+  ASSERT_EQ(top.size(), 3u);
+  EXPECT_EQ(top[0].get_name(), "server");
+  EXPECT_EQ(top[1].get_name(), "logging");
+  EXPECT_EQ(top[2].get_name(), "region");
+
+  const auto children = top[0].get_children();
+  ASSERT_EQ(children.size(), 4u);
+  EXPECT_EQ(children[0].get_name(), "route");
+  EXPECT_EQ(children[0].get_layers().size(), 3u);
+  EXPECT_EQ(children[1].get_arguments().at(0)->get<value::string>(), "/api");
+  EXPECT_EQ(children[2].get_name(), "tls");
+  EXPECT_EQ(children[3].get_arguments().at(0)->get<value::string>(), "/debug");
+}
+
+TEST(overlay, materializes_and_replaces_layers) {
+  const auto base = detail::parse::parse_document(base_text);
+  const auto region = detail::parse::parse_document(region_text);
+  auto reloaded = detail::parse::parse_document("server timeout=99\n");
+  overlay view;
+  view.push_layer(base);
+  view.push_layer(region);
+
+  const document merged = view.materialize();
+  const auto& server = merged.root().get_children().front();
+  EXPECT_EQ(server.get_name(), "server");
+  EXPECT_EQ(server.get_arguments().size(), 2u);
+  EXPECT_EQ(server.get_properties().at("timeout")->get<value::integral>(), 10);
+  ASSERT_EQ(server.get_children().size(), 3u);
+  EXPECT_EQ(server.get_children()[1].get_properties().at("weight")->get<value::integral>(), 2);
+  EXPECT_EQ(merged.root().get_children().size(), 3u);
+
+  view.replace_layer(1, reloaded);
+  EXPECT_EQ(view.root().get_child("server")->get_property("timeout")->get<value::integral>(), 99);
+  EXPECT_FALSE(view.root().get_child("region").has_value());
+  EXPECT_THROW(view.replace_layer(2, reloaded), std::out_of_range);
+
+  // The documents are untouched by the overlay.
+  EXPECT_EQ(base.root().get_children().front().get_properties().at("timeout")->get<value::integral>(), 30);
+}
+
+TEST(overlay, reads_empty_overlay) {
+  const overlay view;
+  EXPECT_EQ(view.root().get_name(), "");
+  EXPECT_EQ(view.root().get_arguments().size(), 0u);
+  EXPECT_TRUE(view.root().get_children().empty());
+  EXPECT_TRUE(view.materialize().root().get_children().empty());
+}
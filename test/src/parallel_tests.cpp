@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+
+#include "kdlcpp/parallel.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+
+namespace {
+
+/// A wide tree with subtrees of uneven sizes.
+node make_tree() {
+  node root{"root"};
+  for (int i = 0; i < 40; ++i) {
+    node child{"c" + std::to_string(i)};
+    for (int j = 0; j < i % 7; ++j) {
+      node inner{"i" + std::to_string(j)};
+      for (int k = 0; k < 5; ++k) {
+        inner.get_children().emplace_back("leaf");
+      }
+      child.get_children().push_back(std::move(inner));
+    }
+    root.get_children().push_back(std::move(child));
+  }
+  return root;
+}
+
+/// The names of a tree in pre-order, the sequential reference of the fold.
+string_type names(const node& current) {
+  auto result = current.get_name() + ",";
+  for (const auto& child : current.get_children()) {
+    result += names(child);
+  }
+  return result;
+}
+
+std::size_t count_nodes(const node& current) {
+  std::size_t count = 1;
+  for (const auto& child : current.get_children()) {
+    count += count_nodes(child);
+  }
+  return count;
+}
+
+} // namespace
+
+TEST(parallel_for_each_node, visits_every_node_once) {
+  thread_pool pool{4};
+  const node root = make_tree();
+  const auto expected = names(root).size();
+
+  for (const std::size_t grain : {1u, 3u, 50u, 100000u}) {
+    std::atomic<std::size_t> bytes{0};
+    std::atomic<std::size_t> count{0};
+    parallel_for_each_node(pool, root, [&](const node& current) {
+      bytes.fetch_add(current.get_name().size() + 1);
+      count.fetch_add(1);
+    }, grain);
+    EXPECT_EQ(bytes.load(), expected);
+    EXPECT_EQ(count.load(), count_nodes(root));
+  }
+}
+
+TEST(parallel_transform_reduce, folds_in_document_order) {
+  thread_pool pool{4};
+  const node root = make_tree();
+  const auto concatenate = [](string_type a, const string_type& b) { return a + b; };
+  const auto name = [](const node& current) { return current.get_name() + ","; };
+
+  for (const std::size_t grain : {1u, 7u, 64u}) {
+    EXPECT_EQ(parallel_transform_reduce(pool, root, string_type{">"}, name, concatenate, grain),
+              ">" + names(root));
+  }
+
+  document doc;
+  doc.root().get_children() = root.get_children();
+  EXPECT_EQ(parallel_transform_reduce(pool, doc, string_type{}, name, concatenate, 2),
+            names(root).substr(5));
+}
+
+TEST(parallel_transform, modifies_every_node) {
+  thread_pool pool{3};
+  auto doc = detail::parse::parse_document_lazy("a 1 { b 2 { c 3 }; d 4 }\ne 5 { f 6 }\n");
+  parallel_transform(pool, doc, [](node& current) {
+    current.get_arguments().insert_at(0, value{*current.get_arguments().at(0)->get<value::integral>() * 10});
+  }, 1);
+
+  const auto sum = parallel_transform_reduce(pool, doc, value::integral{0},
+    [](const node& current) { return *current.get_arguments().at(0)->get<value::integral>(); },
+    [](value::integral a, value::integral b) { return a + b; }, 1);
+  EXPECT_EQ(sum, 210);
+  EXPECT_TRUE(doc.root().is_dirty());
+}
+
+TEST(parallel_for_each_node, rethrows_exceptions) {
+  thread_pool pool{4};
+  const node root = make_tree();
+  EXPECT_THROW(parallel_for_each_node(pool, root, [](const node& current) {
+    if (current.get_name() == "c20") {
+      throw std::runtime_error{"failed"};
+    }
+  }, 2), std::runtime_error);
+}
@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <sstream>
+
+#include "kdlcpp/detail/parse.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+
+using namespace kdlcpp;
+using namespace kdlcpp::detail::parse;
+
+TEST(parse, parses_nodes_arguments_properties_and_children) {
+  const auto doc = parse_document(
+    "server 8080 \"localhost\" secure=#true {\n"
+    "  route \"/\" weight=0.5\n"
+    "  route \"/api\"; timeout #null\n"
+    "}\n");
+
+  const auto& nodes = doc.root().get_children();
+  ASSERT_EQ(nodes.size(), 1u);
+
+  const auto& server = nodes.front();
+  EXPECT_EQ(server.get_name(), "server");
+  EXPECT_EQ(server.get_arguments().at(0)->get<value::integral>(), 8080);
+  EXPECT_EQ(server.get_arguments().at(1)->get<value::string>(), "localhost");
+  EXPECT_EQ(server.get_properties().at("secure")->get<value::boolean>(), true);
+
+  const auto& children = server.get_children();
+  ASSERT_EQ(children.size(), 3u);
+  EXPECT_EQ(children[0].get_properties().at("weight")->get<value::decimal>(), 0.5);
+  EXPECT_EQ(children[1].get_arguments().at(0)->get<value::string>(), "/api");
+  EXPECT_EQ(children[2].get_name(), "timeout");
+  EXPECT_EQ(children[2].get_arguments().at(0)->get_type(), value::type::null);
+}
+
+TEST(parse, skips_comments_and_slashdashes) {
+  const auto doc = parse_document(
+    "// leading comment\n"
+    "/-disabled 1 2\n"
+    "node /* inline */ 1 /-2 3 \\ // continued\n"
+    "  key=\"value\" /-{ hidden }\n"
+    "/* multi\n /* nested */ line */ last\n");
+
+  const auto& nodes = doc.root().get_children();
+  ASSERT_EQ(nodes.size(), 2u);
+  EXPECT_EQ(nodes[0].get_name(), "node");
+  EXPECT_EQ(nodes[0].get_arguments().size(), 2u);
+  EXPECT_EQ(nodes[0].get_arguments().at(1)->get<value::integral>(), 3);
+  EXPECT_EQ(nodes[0].get_properties().at("key")->get<value::string>(), "value");
+  EXPECT_TRUE(nodes[0].get_children().empty());
+  EXPECT_EQ(nodes[1].get_name(), "last");
+}
+
+TEST(parse, counts_skipped_comments_and_slashdashes) {
+  const auto count = [](std::string_view text) {
+    document doc;
+    dom_handler handler{doc.root()};
+    parser<dom_handler> p{text, handler};
+    p.parse_document();
+    return p.comments();
+  };
+  EXPECT_EQ(count("node 1 \"// not a comment\" key=\"/* nor this */\"\n"), 0u);
+  EXPECT_EQ(count("// one\nnode /* two */ 1 /-2 {\n  /-child\n}\n"), 4u);
+}
+
+TEST(parse, counts_type_annotations) {
+  const auto count = [](std::string_view text) {
+    document doc;
+    dom_handler handler{doc.root()};
+    parser<dom_handler> p{text, handler};
+    p.parse_document();
+    return p.annotations();
+  };
+  EXPECT_EQ(count("node \"(u8)\" key=\"(date)\"\n"), 0u);
+  EXPECT_EQ(count("(u8)node (i32)10 key=(date)\"2020-01-01\"\n"), 3u);
+}
+
+TEST(parse, parses_string_forms) {
+  const auto doc = parse_document(
+    "\"quoted name\" \"a\\tb\\\"c\\u{e9}\" #\"raw \\n \"quotes\"\"# \"\"\"\n"
+    "    first\n"
+    "      second\n"
+    "    \"\"\"\n");
+
+  const auto& n = doc.root().get_children().front();
+  EXPECT_EQ(n.get_name(), "quoted name");
+  EXPECT_EQ(n.get_arguments().at(0)->get<value::string>(), "a\tb\"c\xC3\xA9");
+  EXPECT_EQ(n.get_arguments().at(1)->get<value::string>(), "raw \\n \"quotes\"");
+  EXPECT_EQ(n.get_arguments().at(2)->get<value::string>(), "first\n  second");
+}
+
+TEST(parse, reports_errors_with_position) {
+  EXPECT_THROW(parse_document("node {\n"), parse_error);
+  EXPECT_THROW(parse_document("node \"unterminated\n"), parse_error);
+  EXPECT_THROW(parse_document("node true\n"), parse_error);
+  EXPECT_THROW(parse_document("}\n"), parse_error);
+
+  try {
+    parse_document("ok\nnode 12abc\n");
+    FAIL();
+  } catch (const parse_error& error) {
+    EXPECT_EQ(error.line(), 2u);
+    EXPECT_EQ(error.column(), 6u);
+  }
+}
+
+TEST(parse, parses_top_level_nodes_incrementally) {
+  const std::string_view input = "a 1\n/-skipped\nb 2; c 3\n// trailing\n";
+  node root{""};
+  dom_handler handler{root};
+  parser<dom_handler> p{input, handler};
+
+  EXPECT_TRUE(p.parse_top_level_node());
+  EXPECT_EQ(p.position(), 4u);
+  EXPECT_TRUE(p.parse_top_level_node());
+  EXPECT_EQ(p.position(), 18u);
+  EXPECT_TRUE(p.parse_top_level_node());
+  EXPECT_FALSE(p.parse_top_level_node());
+  EXPECT_EQ(p.position(), input.size());
+  EXPECT_EQ(root.get_children().size(), 3u);
+}
+
+TEST(parse, round_trips_serialized_strings) {
+  const std::vector<string_type> samples = {
+    "plain", "two words", "quote\"and\\slash", "line\nbreak\ttab",
+    "caf\xC3\xA9", "sep\xE2\x80\xA8" "arator", "\x01\x7F", "true", "-1", "",
+  };
+
+  for (const auto& sample : samples) {
+    node n{sample};
+    n.get_arguments().push_back(value{sample});
+    n.get_properties().insert(sample, value{sample});
+
+    stream<std::stringstream> out{std::stringstream{}};
+    detail::serialize::serialize_node(out, n);
+    const auto doc = parse_document(out.get().str());
+
+    const auto& parsed = doc.root().get_children().at(0);
+    EXPECT_EQ(parsed.get_name(), sample);
+    EXPECT_EQ(parsed.get_arguments().at(0)->get<value::string>(), sample);
+    EXPECT_EQ(parsed.get_properties().at(sample)->get<value::string>(), sample);
+  }
+}
+
+TEST(parse, parses_number_syntax) {
+  const auto doc = parse_document(
+    "n 0xff_ff -0o17 0b1010_1010 +1_000_000 -9223372036854775808 "
+    "1.5e3 -2_500.000_1 1E-2 #inf #-inf #nan\n");
+
+  const auto& args = doc.root().get_children().front().get_arguments();
+  EXPECT_EQ(args.at(0)->get<value::integral>(), 0xffff);
+  EXPECT_EQ(args.at(1)->get<value::integral>(), -15);
+  EXPECT_EQ(args.at(2)->get<value::integral>(), 0xAA);
+  EXPECT_EQ(args.at(3)->get<value::integral>(), 1000000);
+  EXPECT_EQ(args.at(4)->get<value::integral>(), std::numeric_limits<value::integral>::min());
+  EXPECT_EQ(args.at(5)->get<value::decimal>(), 1500.0);
+  EXPECT_EQ(args.at(6)->get<value::decimal>(), -2500.0001);
+  EXPECT_EQ(args.at(7)->get<value::decimal>(), 0.01);
+  EXPECT_EQ(args.at(8)->get<value::decimal>(), std::numeric_limits<value::decimal>::infinity());
+  EXPECT_EQ(args.at(9)->get<value::decimal>(), -std::numeric_limits<value::decimal>::infinity());
+  EXPECT_TRUE(std::isnan(*args.at(10)->get<value::decimal>()));
+}
+
+TEST(parse, rejects_invalid_numbers) {
+  EXPECT_THROW(parse_document("n 0x\n"), parse_error);
+  EXPECT_THROW(parse_document("n 0b102\n"), parse_error);
+  EXPECT_THROW(parse_document("n 1._5\n"), parse_error);
+  EXPECT_THROW(parse_document("n 9223372036854775808\n"), parse_error);
+  EXPECT_THROW(parse_document("n 0x1_0000_0000_0000_0000\n"), parse_error);
+  EXPECT_THROW(parse_document("n 1e999\n"), parse_error);
+  EXPECT_THROW(parse_document("n #infinity\n"), parse_error);
+}
+
+TEST(parse, round_trips_serialized_numbers) {
+  const std::vector<value::decimal> decimals = {
+    3.14159265358979, 0.1, 1.0, -2.0, 1e300, 5e-324, 123456789012345680.0,
+    std::numeric_limits<value::decimal>::infinity(),
+  };
+  const std::vector<value::integral> integrals = {
+    0, -1, std::numeric_limits<value::integral>::max(), std::numeric_limits<value::integral>::min(),
+  };
+
+  node n{"n"};
+  for (const auto d : decimals) {
+    n.get_arguments().push_back(value{d});
+  }
+  for (const auto i : integrals) {
+    n.get_arguments().push_back(value{i});
+  }
+  stream<std::stringstream> out{std::stringstream{}};
+  detail::serialize::serialize_node(out, n);
+
+  const auto doc = parse_document(out.get().str());
+  const auto& args = doc.root().get_children().front().get_arguments();
+  for (std::size_t i = 0; i < decimals.size(); ++i) {
+    EXPECT_EQ(args.at(i)->get<value::decimal>(), decimals[i]);
+  }
+  for (std::size_t i = 0; i < integrals.size(); ++i) {
+    EXPECT_EQ(args.at(decimals.size() + i)->get<value::integral>(), integrals[i]);
+  }
+}
+
+TEST(parse, lazy_parse_defers_children_blocks) {
+  const string_type text =
+    "config 1 mode=\"fast\" {\n"
+    "  nested \"{not a brace}\" #\"raw } \"# {\n"
+    "    leaf \"\"\"\n      }\n      \"\"\" // }\n"
+    "  }\n"
+    "  /* } */ other /-{ } {}\n"
+    "}\n"
+    "second\n";
+  const auto eager = parse_document(text);
+  const auto lazy = parse_document_lazy(text);
+
+  const auto& nodes = lazy.root().get_children();
+  ASSERT_EQ(nodes.size(), 2u);
+  EXPECT_TRUE(nodes[0].has_deferred_children());
+  EXPECT_EQ(nodes[0].get_properties().at("mode")->get<value::string>(), "fast");
+
+  const auto& children = nodes[0].get_children();
+  EXPECT_FALSE(nodes[0].has_deferred_children());
+  ASSERT_EQ(children.size(), 2u);
+  EXPECT_TRUE(children[0].has_deferred_children());
+  EXPECT_EQ(children[0].get_arguments().at(1)->get<value::string>(), "raw } ");
+  EXPECT_EQ(children[0].get_children().front().get_arguments().at(0)->get<value::string>(), "}");
+  EXPECT_EQ(children[1].get_name(), "other");
+
+  stream<std::stringstream> eager_out{std::stringstream{}};
+  stream<std::stringstream> lazy_out{std::stringstream{}};
+  detail::serialize::serialize_document(eager_out, eager);
+  detail::serialize::serialize_document(lazy_out, lazy);
+  EXPECT_EQ(lazy_out.get().str(), eager_out.get().str());
+}
+
+TEST(parse, lazy_parse_reports_block_errors_on_access) {
+  EXPECT_THROW(parse_document_lazy("a {\n"), parse_error);
+  EXPECT_THROW(parse_document_lazy("a { \"}\n"), parse_error);
+
+  const auto doc = parse_document_lazy("a {\n  b 12abc\n}\n");
+  try {
+    (void)doc.root().get_children().front().get_children();
+    FAIL();
+  } catch (const parse_error& error) {
+    EXPECT_EQ(error.line(), 2u);
+    EXPECT_EQ(error.column(), 5u);
+  }
+}
+
+TEST(parse, lazy_parse_copies_keep_children_deferred) {
+  std::optional<node> copy;
+  {
+    const auto doc = parse_document_lazy("a { b 1; c 2 }\n");
+    copy.emplace(doc.root().get_children().front());
+  }
+  EXPECT_TRUE(copy->has_deferred_children());
+  ASSERT_EQ(copy->get_children().size(), 2u);
+  EXPECT_EQ(copy->get_children()[1].get_arguments().at(0)->get<value::integral>(), 2);
+
+  copy->get_children().emplace_back("d");
+  EXPECT_EQ(copy->get_children().size(), 3u);
+}
+
+TEST(parse, rejects_second_children_block) {
+  EXPECT_THROW(parse_document("a { b } { c }\n"), parse_error);
+  EXPECT_EQ(parse_document("a /-{ b } { c }\n").root().get_children().front().get_children().size(), 1u);
+}
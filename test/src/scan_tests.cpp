@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "kdlcpp/detail/scan.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+using namespace kdlcpp::detail::scan;
+
+namespace {
+
+/// The instruction sets this machine supports.
+std::vector<isa> supported_isas() {
+  std::vector<isa> kinds;
+  for (const isa kind : {isa::scalar, isa::sse42, isa::avx2}) {
+    if (is_supported(kind)) {
+      kinds.push_back(kind);
+    }
+  }
+  return kinds;
+}
+
+/// Restores the default instruction set when a test ends.
+struct isa_guard {
+  isa previous = active_isa();
+  ~isa_guard() {
+    use_isa(previous);
+  }
+};
+
+/// A code point by code point validation, the reference for validate_utf8().
+std::size_t reference_validate(std::string_view text) {
+  std::size_t i = 0;
+  while (i < text.size()) {
+    std::size_t length = 0;
+    detail::parse::decode_utf8(text, i, length);
+    if (length == 0) {
+      return i;
+    }
+    i += length;
+  }
+  return text.size();
+}
+
+/// Random text mixing ASCII, valid multi-byte sequences and stray bytes.
+std::string random_text(std::mt19937& random, std::size_t size, bool corrupt) {
+  static const char* const pieces[] = {"a", "key", " ", "\n", "\xC3\xA9", "\xE2\x82\xAC",
+                                       "\xF0\x9F\x98\x80", "\xEF\xBB\xBF", "\xC2\xA0", "\"", "\\"};
+  static const char* const broken[] = {"\x80", "\xC3", "\xE2\x82", "\xF0\x9F\x98", "\xC0\xAF",
+                                       "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xFF", "\xE0\x80\x80"};
+  std::string text;
+  while (text.size() < size) {
+    text += pieces[random() % std::size(pieces)];
+  }
+  if (corrupt) {
+    text.insert(random() % (text.size() + 1), broken[random() % std::size(broken)]);
+  }
+  return text;
+}
+
+} // namespace
+
+TEST(scan, selects_supported_instruction_sets) {
+  isa_guard guard;
+  EXPECT_TRUE(is_supported(isa::scalar));
+  EXPECT_TRUE(is_supported(active_isa()));
+  for (const isa kind : supported_isas()) {
+    EXPECT_TRUE(use_isa(kind));
+    EXPECT_EQ(active_isa(), kind);
+  }
+}
+
+TEST(scan, validates_utf8) {
+  isa_guard guard;
+  const std::vector<std::string> valid = {"", "plain ascii", "caf\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80",
+                                          "\xEF\xBF\xBD", "\xF4\x8F\xBF\xBF", "\xED\x9F\xBF"};
+  const std::vector<std::string> invalid = {"\x80", "\xC3", "\xC3(", "\xC0\xAF", "\xC1\xBF", "\xE0\x80\x80",
+                                            "\xE0\x9F\xBF", "\xED\xA0\x80", "\xF0\x8F\xBF\xBF",
+                                            "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xFF", "\xE2\x82",
+                                            "\xF0\x9F\x98", "\xC3\xA9\xA9"};
+  for (const isa kind : supported_isas()) {
+    use_isa(kind);
+    for (std::size_t prefix = 0; prefix < 70; ++prefix) {
+      for (const auto& piece : valid) {
+        const std::string text = std::string(prefix, 'x') + piece + std::string(prefix % 7, 'y');
+        EXPECT_EQ(validate_utf8(text), text.size()) << static_cast<int>(kind) << " " << prefix;
+      }
+      for (const auto& piece : invalid) {
+        const std::string text = std::string(prefix, 'x') + piece + std::string(prefix % 7, 'y');
+        EXPECT_EQ(validate_utf8(text), reference_validate(text)) << static_cast<int>(kind) << " " << prefix;
+      }
+    }
+  }
+}
+
+TEST(scan, validates_random_text_like_the_reference) {
+  isa_guard guard;
+  std::mt19937 random{42};
+  for (int round = 0; round < 2000; ++round) {
+    const std::string text = random_text(random, random() % 300, round % 2 == 1);
+    const std::size_t expected = reference_validate(text);
+    for (const isa kind : supported_isas()) {
+      use_isa(kind);
+      ASSERT_EQ(validate_utf8(text), expected) << static_cast<int>(kind) << " round " << round;
+    }
+  }
+}
+
+TEST(scan, classifies_kdl_bytes) {
+  EXPECT_TRUE(identifier_stops.contains(' '));
+  EXPECT_TRUE(identifier_stops.contains('='));
+  EXPECT_TRUE(identifier_stops.contains(0xE2));
+  EXPECT_FALSE(identifier_stops.contains('-'));
+  EXPECT_FALSE(identifier_stops.contains(0xC3));
+  EXPECT_FALSE(identifier_stops.contains(0xA9));
+
+  EXPECT_TRUE(string_stops.contains('"'));
+  EXPECT_TRUE(string_stops.contains('\\'));
+  EXPECT_TRUE(string_stops.contains('\n'));
+  EXPECT_TRUE(string_stops.contains(0x7F));
+  EXPECT_FALSE(string_stops.contains('\t'));
+  EXPECT_FALSE(string_stops.contains('='));
+
+  EXPECT_TRUE(text_stops.contains('\r'));
+  EXPECT_FALSE(text_stops.contains('"'));
+
+  EXPECT_TRUE(escape_stops.contains('\t'));
+  EXPECT_TRUE(escape_stops.contains(0xC3));
+  EXPECT_FALSE(escape_stops.contains('#'));
+
+  EXPECT_TRUE(bare_stops.contains('#'));
+  EXPECT_TRUE(bare_stops.contains(0xC3));
+  EXPECT_FALSE(bare_stops.contains('.'));
+
+  // Every byte the runtime parser sees as a single-byte non-identifier
+  // code point stops an identifier scan.
+  for (unsigned c = 0; c < 0x80; ++c) {
+    EXPECT_EQ(identifier_stops.contains(static_cast<unsigned char>(c)),
+              !detail::parse::is_identifier_char(c)) << c;
+  }
+}
+
+TEST(scan, finds_first_member_at_every_position) {
+  isa_guard guard;
+  for (const isa kind : supported_isas()) {
+    use_isa(kind);
+    for (std::size_t size : {1u, 15u, 16u, 17u, 31u, 32u, 33u, 63u, 64u, 65u, 130u}) {
+      const std::string clean(size, 'k');
+      EXPECT_EQ(find_first_of(clean, identifier_stops), size);
+      EXPECT_EQ(find_first_of_bulk(clean, identifier_stops), size);
+      for (std::size_t at = 0; at < size; ++at) {
+        for (const char stop : {' ', '"', '\x7F', '\xE2', '\x01'}) {
+          std::string text = clean;
+          text[at] = stop;
+          EXPECT_EQ(find_first_of_bulk(text, identifier_stops), at)
+            << static_cast<int>(kind) << " " << size << " " << at << " " << static_cast<int>(stop);
+        }
+        std::string text = clean;
+        text[at] = '\xC3';
+        EXPECT_EQ(find_first_of_bulk(text, escape_stops), at);
+        EXPECT_EQ(find_first_of_bulk(text, string_stops), size);
+      }
+    }
+  }
+}
+
+TEST(scan, parses_the_same_on_every_instruction_set) {
+  isa_guard guard;
+  std::string text;
+  for (int i = 0; i < 400; ++i) {
+    text += "n\xC3\xA9" + std::to_string(i) + " \"caf\xC3\xA9 \\\"quoted\\\" text\" // comment \xE2\x82\xAC\n";
+  }
+  for (const isa kind : supported_isas()) {
+    use_isa(kind);
+    const auto doc = detail::parse::parse_document(text);
+    ASSERT_EQ(doc.root().get_children().size(), 400u);
+    EXPECT_EQ(doc.root().get_children()[399].get_name(), "n\xC3\xA9" "399");
+    EXPECT_EQ(doc.root().get_children()[7].get_arguments().at(0)->get<value::string>(),
+              "caf\xC3\xA9 \"quoted\" text");
+
+    for (const std::size_t at : {std::size_t{10}, std::size_t{4095}, std::size_t{4097}, text.size() - 30}) {
+      std::string broken = text;
+      const std::size_t line_start = broken.rfind('\n', at) + 1;
+      broken.insert(broken.find('"', line_start) + 2, "\xFF");
+      try {
+        detail::parse::parse_document(broken);
+        FAIL() << at;
+      } catch (const parse_error& error) {
+        EXPECT_EQ(error.line(), static_cast<std::size_t>(std::count(broken.begin(), broken.begin() + line_start, '\n') + 1));
+      }
+    }
+  }
+}
@@ -1,9 +1,14 @@
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
 #include <sstream>
 
 #include "kdlcpp/value.hpp"
 #include "kdlcpp/stream.hpp"
 #include "kdlcpp/detail/serialize.hpp"
+#include "kdlcpp/detail/parse.hpp"
 
 using namespace kdlcpp;
 using namespace kdlcpp::detail;
@@ -57,3 +62,265 @@ TEST(serialize_value, serializes_null_value) {
   EXPECT_EQ(out.get().str(), tokens::$null);
 }
 
+
+namespace {
+
+node make_tree() {
+  node root{"root"};
+  for (int i = 0; i < 3; ++i) {
+    node child{"child" + std::to_string(i)};
+    child.get_arguments().push_back(value{static_cast<value::integral>(i)});
+    child.get_children().push_back(node{"leaf"});
+    root.get_children().push_back(child);
+  }
+  return root;
+}
+
+template <typename serialize_fn>
+std::string to_string(serialize_fn fn) {
+  stream<std::stringstream> out{std::stringstream{}};
+  fn(out);
+  return out.get().str();
+}
+
+} // namespace
+
+TEST(serialize_node_cached, matches_uncached_output_and_caches_subtrees) {
+  node root = make_tree();
+  const auto expected = to_string([&](auto& out) { serialize_node(out, root); });
+
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node_cached(out, root); }), expected);
+  EXPECT_FALSE(root.is_dirty());
+  EXPECT_EQ(root.get_serialized(), expected);
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node_cached(out, root); }), expected);
+}
+
+TEST(serialize_node_cached, reformats_only_modified_path) {
+  node root = make_tree();
+  to_string([&](auto& out) { serialize_node_cached(out, root); });
+
+  // Editing through a reference kept across serializations still
+  // invalidates every ancestor.
+  node& leaf = root.get_children()[1].get_children()[0];
+  to_string([&](auto& out) { serialize_node_cached(out, root); });
+  leaf.get_properties().insert("edited", value{true});
+
+  EXPECT_TRUE(leaf.is_dirty());
+  EXPECT_TRUE(root.get_children()[1].is_dirty());
+  EXPECT_TRUE(root.is_dirty());
+  EXPECT_FALSE(std::as_const(root).get_children()[0].is_dirty());
+  EXPECT_FALSE(std::as_const(root).get_children()[2].is_dirty());
+
+  const auto cached = to_string([&](auto& out) { serialize_node_cached(out, root); });
+  EXPECT_EQ(cached, to_string([&](auto& out) { serialize_node(out, root); }));
+  EXPECT_NE(cached.find("edited=#true"), std::string::npos);
+}
+
+TEST(serialize_node_cached, tracks_nodes_relocated_by_insertions) {
+  node root = make_tree();
+  to_string([&](auto& out) { serialize_node_cached(out, root); });
+
+  root.get_children().insert(root.get_children().begin(), node{"first"});
+  to_string([&](auto& out) { serialize_node_cached(out, root); });
+
+  node& moved = root.get_children()[3].get_children()[0];
+  to_string([&](auto& out) { serialize_node_cached(out, root); });
+  moved.get_arguments().push_back(value{42});
+
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node_cached(out, root); }),
+            to_string([&](auto& out) { serialize_node(out, root); }));
+}
+
+TEST(serialize_node_cached, detaches_children_moved_out_of_their_parent) {
+  auto parent = std::make_unique<node>(make_tree());
+  to_string([&](auto& out) { serialize_node_cached(out, *parent); });
+
+  auto children = std::move(parent->get_children());
+  parent.reset();
+  children[0].get_arguments().push_back(value{7});
+  EXPECT_TRUE(children[0].is_dirty());
+}
+
+TEST(serialize_node_cached, reformats_both_parents_of_swapped_children) {
+  node first = make_tree();
+  node second{"other"};
+  second.get_children().push_back(node{"single"});
+  to_string([&](auto& out) { serialize_node_cached(out, first); });
+  to_string([&](auto& out) { serialize_node_cached(out, second); });
+
+  std::swap(first.get_children(), second.get_children());
+  to_string([&](auto& out) { serialize_node_cached(out, first); });
+
+  // The children now under second no longer report to first.
+  node& moved = second.get_children()[1];
+  moved.get_arguments().push_back(value{"edited"});
+  EXPECT_FALSE(first.is_dirty());
+  EXPECT_TRUE(second.is_dirty());
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node_cached(out, first); }),
+            to_string([&](auto& out) { serialize_node(out, first); }));
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node_cached(out, second); }),
+            to_string([&](auto& out) { serialize_node(out, second); }));
+}
+
+TEST(serialize_node_cached, reattaches_children_when_cached_again) {
+  node parent = make_tree();
+  to_string([&](auto& out) { serialize_node_cached(out, parent); });
+  node& child = parent.get_children()[2];
+  parent.get_children()[0].get_arguments().push_back(value{7});
+  to_string([&](auto& out) { serialize_node_cached(out, parent); });
+  EXPECT_FALSE(parent.is_dirty());
+
+  child.get_arguments().push_back(value{9});
+  EXPECT_TRUE(parent.is_dirty());
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node_cached(out, parent); }),
+            to_string([&](auto& out) { serialize_node(out, parent); }));
+}
+
+TEST(document, write_to_file_writes_serialized_document) {
+  document doc;
+  doc.set_name("config");
+  doc.root().get_children().push_back(make_tree());
+
+  const auto path = std::string{::testing::TempDir()} + "kdlcpp_write_to_file.kdl";
+  doc.write_to_file(path);
+  doc.root().get_children().front().get_children()[0].get_arguments().push_back(value{7});
+  doc.write_to_file(path);
+
+  std::ifstream in{path};
+  const std::string written{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+  EXPECT_EQ(written, to_string([&](auto& out) { serialize_document(out, doc); }));
+  std::remove(path.c_str());
+}
+
+TEST(serialize_value, escapes_special_characters_in_strings) {
+  value val{string_type{"say \"hi\"\\\n\tnow"}};
+  std::stringstream ss;
+  stream<std::stringstream> out{std::move(ss)};
+  serialize_value(out, val);
+  EXPECT_EQ(out.get().str(), "\"say \\\"hi\\\"\\\\\\n\\tnow\"");
+}
+
+TEST(serialize_node, writes_identifiers_bare_and_quotes_others) {
+  node n{"my node"};
+  n.get_properties().insert("key", value{1});
+  n.get_properties().insert("1st", value{2});
+  stream<std::stringstream> out{std::stringstream{}};
+  serialize_node(out, n);
+
+  node bare{"plain-name"};
+  stream<std::stringstream> bare_out{std::stringstream{}};
+  serialize_node(bare_out, bare);
+
+  const auto text = out.get().str();
+  EXPECT_EQ(text.rfind("\"my node\" ", 0), 0u);
+  EXPECT_NE(text.find(" key=1"), std::string::npos);
+  EXPECT_NE(text.find(" \"1st\"=2"), std::string::npos);
+  EXPECT_EQ(bare_out.get().str().rfind("plain-name ", 0), 0u);
+}
+
+TEST(serialize_value, serializes_decimals_with_full_precision) {
+  const auto serialize = [](value::decimal d) {
+    stream<std::stringstream> out{std::stringstream{}};
+    serialize_value(out, value{d});
+    return out.get().str();
+  };
+
+  EXPECT_EQ(serialize(3.14159265), "3.14159265");
+  EXPECT_EQ(serialize(0.1), "0.1");
+  EXPECT_EQ(serialize(2.0), "2.0");
+  EXPECT_EQ(serialize(-0.0), "-0.0");
+  EXPECT_EQ(serialize(1e300), "1e+300");
+  EXPECT_EQ(serialize(std::numeric_limits<value::decimal>::infinity()), "#inf");
+  EXPECT_EQ(serialize(-std::numeric_limits<value::decimal>::infinity()), "#-inf");
+  EXPECT_EQ(serialize(std::numeric_limits<value::decimal>::quiet_NaN()), "#nan");
+}
+
+TEST(serialize_value, serializes_integral_extremes) {
+  value val{std::numeric_limits<value::integral>::min()};
+  stream<std::stringstream> out{std::stringstream{}};
+  serialize_value(out, val);
+  EXPECT_EQ(out.get().str(), "-9223372036854775808");
+}
+
+TEST(serialize_node, writes_compact_style) {
+  serialize_options options;
+  options.output_style = serialize_options::style::compact;
+
+  node root = make_tree();
+  root.get_properties().insert("k", value{string_type{"v w"}});
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node(out, root, options); }),
+            "root k=\"v w\"{child0 0{leaf};child1 1{leaf};child2 2{leaf}}\n");
+}
+
+TEST(serialize_node, sorts_properties_when_asked) {
+  serialize_options options;
+  options.output_style = serialize_options::style::pretty;
+  options.sort_properties = true;
+
+  node n{"n"};
+  for (const char* key : {"zeta", "alpha", "mid", "beta", "omega"}) {
+    n.get_properties().insert(key, value{1});
+  }
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node(out, n, options); }),
+            "n alpha=1 beta=1 mid=1 omega=1 zeta=1\n");
+
+  serialize_options unsorted = options;
+  unsorted.sort_properties = false;
+  EXPECT_NE(format_tag(options, 0), format_tag(unsorted, 0));
+  options.output_style = serialize_options::style::standard;
+  EXPECT_NE(format_tag(options, 0), 0u);
+}
+
+TEST(serialize_node, writes_pretty_style) {
+  serialize_options options;
+  options.output_style = serialize_options::style::pretty;
+  options.indent = 2;
+
+  node root{"root"};
+  root.get_children().push_back(make_tree().get_children()[1]);
+  root.get_children().emplace_back("last");
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node(out, root, options); }),
+            "root {\n  child1 1 {\n    leaf\n  }\n  last\n}\n");
+
+  options.indent = 1;
+  options.indent_char = '\t';
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node(out, root, options); }),
+            "root {\n\tchild1 1 {\n\t\tleaf\n\t}\n\tlast\n}\n");
+}
+
+TEST(serialize_document, every_style_round_trips) {
+  document doc;
+  doc.root().get_children().push_back(make_tree());
+  doc.root().get_children().emplace_back("second");
+  doc.root().get_children().back().get_arguments().push_back(value{1.5});
+  const auto expected = to_string([&](auto& out) { serialize_document(out, doc); });
+
+  for (const auto style : {serialize_options::style::compact, serialize_options::style::pretty}) {
+    serialize_options options;
+    options.output_style = style;
+    const auto text = to_string([&](auto& out) { serialize_document(out, doc, options); });
+    const auto parsed = parse::parse_document(text);
+    EXPECT_EQ(to_string([&](auto& out) { serialize_document(out, parsed); }), expected);
+    if (style == serialize_options::style::compact) {
+      EXPECT_LT(text.size(), expected.size());
+    }
+  }
+}
+
+TEST(serialize_node_cached, reformats_for_other_options) {
+  serialize_options pretty;
+  pretty.output_style = serialize_options::style::pretty;
+
+  node root = make_tree();
+  const auto standard = to_string([&](auto& out) { serialize_node_cached(out, root); });
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node_cached(out, root, pretty); }),
+            to_string([&](auto& out) { serialize_node(out, root, pretty); }));
+  EXPECT_FALSE(root.is_dirty());
+
+  // A clean subtree moved one level down is indented again.
+  node wrapper{"wrapper"};
+  wrapper.get_children().push_back(root);
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node_cached(out, wrapper, pretty); }),
+            to_string([&](auto& out) { serialize_node(out, wrapper, pretty); }));
+  EXPECT_EQ(to_string([&](auto& out) { serialize_node_cached(out, root); }), standard);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "kdlcpp/shared_document.hpp"
+
+using namespace kdlcpp;
+
+namespace {
+
+document make_document(const string_type& name) {
+  document doc;
+  doc.set_name(name);
+  doc.root().get_children().push_back(node{name});
+  return doc;
+}
+
+} // namespace
+
+TEST(shared_document, acquire_returns_initial_version) {
+  shared_document shared{make_document("initial")};
+
+  const auto snap = shared.acquire();
+  EXPECT_EQ(snap.version(), 0u);
+  EXPECT_EQ(snap->name(), "initial");
+}
+
+TEST(shared_document, snapshot_outlives_publish) {
+  shared_document shared{make_document("old")};
+
+  auto old_snap = shared.acquire();
+  EXPECT_EQ(shared.publish(make_document("new")), 1u);
+
+  const auto new_snap = shared.acquire();
+  EXPECT_EQ(old_snap->name(), "old");
+  EXPECT_EQ(old_snap->root().get_children().front().get_name(), "old");
+  EXPECT_EQ(new_snap->name(), "new");
+  EXPECT_EQ(shared.pending_reclamation(), 1u);
+
+  old_snap = shared.acquire();
+  shared.publish(make_document("newer"));
+  EXPECT_EQ(shared.pending_reclamation(), 1u);
+}
+
+TEST(shared_document, released_versions_are_reclaimed) {
+  shared_document shared{make_document("v0"), 4};
+
+  {
+    const auto snap = shared.acquire();
+    shared.publish(make_document("v1"));
+    EXPECT_EQ(shared.pending_reclamation(), 1u);
+  }
+
+  shared.publish(make_document("v2"));
+  EXPECT_EQ(shared.pending_reclamation(), 0u);
+}
+
+TEST(shared_document, concurrent_readers_and_writer) {
+  shared_document shared{make_document("0"), 8};
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> readers;
+  std::atomic<bool> consistent{true};
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      std::uint64_t last = 0;
+      while (!done.load()) {
+        const auto snap = shared.acquire();
+        const auto expected = std::to_string(snap.version());
+        if (snap.version() < last || snap->name() != expected ||
+            snap->root().get_children().front().get_name() != expected) {
+          consistent = false;
+        }
+        last = snap.version();
+      }
+    });
+  }
+
+  for (int v = 1; v <= 200; ++v) {
+    shared.publish(make_document(std::to_string(v)));
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_TRUE(consistent.load());
+  EXPECT_EQ(shared.acquire().version(), 200u);
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <string_view>
+
+#include "kdlcpp/static_document.hpp"
+#include "kdlcpp/detail/parse.hpp"
+
+using namespace kdlcpp;
+
+namespace {
+
+constexpr std::string_view config_text = R"(
+// Server defaults.
+server 8080 "localhost" secure=#true {
+  route "/" weight=0.5
+  route "/api"; timeout #null
+}
+/-disabled 1 { hidden }
+limits max=0x7fff_ffff ratio=-2.5e-3 flags=(u8)0b1010
+)";
+
+constexpr auto config = parse_static<config_text>();
+
+constexpr auto server = config.root().get_children()[0];
+
+static_assert(config.root().get_children().size() == 2);
+static_assert(server.get_name() == "server");
+static_assert(server.get_arguments().size() == 2);
+static_assert(server.get_arguments().at(0)->get<value::integral>() == 8080);
+static_assert(server.get_arguments().at(1)->get<std::string_view>() == std::string_view{"localhost"});
+static_assert(server.get_properties().at("secure")->get<value::boolean>() == true);
+static_assert(server.get_children().size() == 3);
+static_assert(server.get_children()[2].get_arguments().at(0)->get_type() == value::type::null);
+static_assert(config.root().get_children()[1].get_properties().at("max")->get<value::integral>() == 0x7fffffff);
+
+constexpr std::string_view strings_text =
+  "\"quoted name\" \"a\\tb\\\"c\\u{e9}\" #\"raw \\n \"quotes\"\"# \"\"\"\n"
+  "    first\n"
+  "      second \\\n"
+  "      continued\n"
+  "    \"\"\" key=1 key=2 other=#\"\"\"\n"
+  "  raw \\n\n"
+  "  \"\"\"#\n";
+
+constexpr auto strings = parse_static<strings_text>();
+
+constexpr std::string_view numbers_text =
+  "n 0xff_ff -0o17 0b1010_1010 +1_000_000 -9223372036854775808 "
+  "1.5e3 -2_500.000_1 1E-2 0.1 123456.789e-3 #inf #-inf #nan\n";
+
+constexpr auto numbers = parse_static<numbers_text>();
+
+constexpr std::string_view decimals_text =
+  "d 1.7976931348623157e308 1.7976931348623158e308 9007199254740993.0 9007199254740995.0 "
+  "123456789012345678901234.5 2.2250738585072011e-308 2.2250738585072014e-308 "
+  "4.9e-324 2.4703282292062328e-324 1e-320 0.30000000000000001665 "
+  "3.141592653589793238462643383279502884197169399375105820974944 "
+  "7.0e-10 -0.0 0e-500 1_000.000_001e+2\n";
+
+constexpr auto decimals = parse_static<decimals_text>();
+
+constexpr std::string_view empty_text = "// nothing but a comment\n";
+
+constexpr auto empty = parse_static<empty_text>();
+
+static_assert(empty.root().get_children().empty());
+
+void expect_same(const node& expected, const node& actual) {
+  EXPECT_EQ(actual.get_name(), expected.get_name());
+  ASSERT_EQ(actual.get_arguments().size(), expected.get_arguments().size());
+  for (std::size_t i = 0; i < expected.get_arguments().size(); ++i) {
+    const auto want = *expected.get_arguments().at(i);
+    const auto got = *actual.get_arguments().at(i);
+    ASSERT_EQ(got.get_type(), want.get_type());
+    EXPECT_EQ(got.get<value::boolean>(), want.get<value::boolean>());
+    EXPECT_EQ(got.get<value::integral>(), want.get<value::integral>());
+    EXPECT_EQ(got.get<value::string>(), want.get<value::string>());
+    if (want.get_type() == value::type::decimal && !std::isnan(*want.get<value::decimal>())) {
+      EXPECT_EQ(got.get<value::decimal>(), want.get<value::decimal>());
+    }
+  }
+  ASSERT_EQ(actual.get_properties().size(), expected.get_properties().size());
+  for (const auto& [key, want] : expected.get_properties()) {
+    ASSERT_TRUE(actual.get_properties().contains(key)) << key;
+    EXPECT_EQ(actual.get_properties().at(key)->get<value::string>(), want.get<value::string>());
+    EXPECT_EQ(actual.get_properties().at(key)->get<value::integral>(), want.get<value::integral>());
+    EXPECT_EQ(actual.get_properties().at(key)->get<value::decimal>(), want.get<value::decimal>());
+  }
+  ASSERT_EQ(actual.get_children().size(), expected.get_children().size());
+  for (std::size_t i = 0; i < expected.get_children().size(); ++i) {
+    expect_same(expected.get_children()[i], actual.get_children()[i]);
+  }
+}
+
+} // namespace
+
+TEST(static_document, matches_runtime_parser) {
+  expect_same(detail::parse::parse_document(config_text).root(), config.to_document().root());
+  expect_same(detail::parse::parse_document(strings_text).root(), strings.to_document().root());
+  expect_same(detail::parse::parse_document(numbers_text).root(), numbers.to_document().root());
+  expect_same(detail::parse::parse_document(decimals_text).root(), decimals.to_document().root());
+  expect_same(detail::parse::parse_document(empty_text).root(), empty.to_document().root());
+}
+
+TEST(static_document, reads_string_forms) {
+  const auto n = strings.root().get_children().front();
+  EXPECT_EQ(n.get_name(), "quoted name");
+  EXPECT_EQ(n.get_arguments().at(0)->get<std::string_view>(), "a\tb\"c\xC3\xA9");
+  EXPECT_EQ(n.get_arguments().at(1)->get<value::string>(), "raw \\n \"quotes\"");
+  EXPECT_EQ(n.get_arguments().at(2)->get<std::string_view>(), "first\n  second continued");
+  EXPECT_FALSE(n.get_arguments().at(3).has_value());
+
+  const auto props = n.get_properties();
+  ASSERT_EQ(props.size(), 2u);
+  EXPECT_EQ(props.at("key")->get<value::integral>(), 2);
+  EXPECT_EQ(props.at("other")->get<std::string_view>(), "raw \\n");
+  EXPECT_FALSE(props.contains("missing"));
+
+  std::size_t visited = 0;
+  for (const auto& [key, val] : props) {
+    EXPECT_EQ(key, visited == 0 ? "key" : "other");
+    EXPECT_EQ(val.get_type(), visited == 0 ? value::type::integral : value::type::string);
+    ++visited;
+  }
+  EXPECT_EQ(visited, 2u);
+}
+
+TEST(static_document, reads_numbers) {
+  const auto args = numbers.root().get_children().front().get_arguments();
+  ASSERT_EQ(args.size(), 13u);
+  EXPECT_EQ(args.at(0)->get<value::integral>(), 0xffff);
+  EXPECT_EQ(args.at(1)->get<value::integral>(), -15);
+  EXPECT_EQ(args.at(4)->get<value::integral>(), std::numeric_limits<value::integral>::min());
+  EXPECT_EQ(args.at(6)->get<value::decimal>(), -2500.0001);
+  EXPECT_EQ(args.at(8)->get<value::decimal>(), 0.1);
+  EXPECT_EQ(args.at(9)->get<value::decimal>(), 123.456789);
+  EXPECT_EQ(args.at(11)->get<value::decimal>(), -std::numeric_limits<value::decimal>::infinity());
+  EXPECT_TRUE(std::isnan(*args.at(12)->get<value::decimal>()));
+  EXPECT_FALSE(args.at(0)->get<value::decimal>().has_value());
+
+  std::size_t integrals = 0;
+  for (const auto arg : args) {
+    integrals += arg.get_type() == value::type::integral;
+  }
+  EXPECT_EQ(integrals, 5u);
+}
+
+TEST(static_document, rejects_invalid_documents) {
+  for (const std::string_view text : {"node {\n", "node \"unterminated\n", "node true\n", "}\n",
+                                      "n 0x\n", "n 9223372036854775808\n", "n 1e400\n",
+                                      "n \"\"\"\n  a\n b\n  \"\"\"\n", "n #bogus\n",
+                                      "n 1e-400\n", "n 2.4703282292062327e-324\n",
+                                      "n 1.7976931348623159e308\n"}) {
+    EXPECT_THROW(detail::static_kdl::measure(text), parse_error) << text;
+  }
+  try {
+    detail::static_kdl::measure("ok\nnode 12abc\n");
+    FAIL();
+  } catch (const parse_error& error) {
+    EXPECT_EQ(error.line(), 2u);
+    EXPECT_EQ(error.column(), 6u);
+  }
+}
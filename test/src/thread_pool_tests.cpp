@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+
+#include "kdlcpp/thread_pool.hpp"
+
+using namespace kdlcpp;
+
+TEST(thread_pool, runs_every_task_including_nested_ones) {
+  thread_pool pool{4};
+  EXPECT_EQ(pool.size(), 4u);
+
+  std::atomic<int> count{0};
+  for (int i = 0; i < 100; ++i) {
+    pool.submit([&] {
+      count.fetch_add(1);
+      for (int j = 0; j < 10; ++j) {
+        pool.submit([&] { count.fetch_add(1); });
+      }
+    });
+  }
+  pool.wait();
+  EXPECT_EQ(count.load(), 1100);
+
+  pool.submit([&] { count.fetch_add(1); });
+  pool.wait();
+  EXPECT_EQ(count.load(), 1101);
+}
+
+TEST(thread_pool, wait_rethrows_task_exceptions) {
+  thread_pool pool{2};
+  std::atomic<int> count{0};
+  pool.submit([] { throw std::runtime_error{"failed"}; });
+  for (int i = 0; i < 10; ++i) {
+    pool.submit([&] { count.fetch_add(1); });
+  }
+  EXPECT_THROW(pool.wait(), std::runtime_error);
+  EXPECT_EQ(count.load(), 10);
+  EXPECT_NO_THROW(pool.wait());
+}
@@ -0,0 +1,93 @@
+#include "file_io.hpp"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace kdlfmt {
+
+namespace {
+
+[[noreturn]] void throw_errno(const kdlcpp::string_type& what) {
+  throw std::system_error{errno, std::generic_category(), what};
+}
+
+/// Closes a file descriptor when leaving a scope.
+struct descriptor {
+  int fd;
+
+  ~descriptor() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+};
+
+} // namespace
+
+mapped_file::mapped_file(const kdlcpp::string_type& path) {
+  descriptor file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (file.fd < 0) {
+    throw_errno(path);
+  }
+  struct stat info {};
+  if (::fstat(file.fd, &info) != 0) {
+    throw_errno(path);
+  }
+  m_mode = static_cast<unsigned>(info.st_mode & 07777);
+  m_size = static_cast<std::size_t>(info.st_size);
+  if (m_size == 0) {
+    return;
+  }
+
+  m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+  if (m_data == MAP_FAILED) {
+    m_data = nullptr;
+    throw_errno(path);
+  }
+  ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+}
+
+mapped_file::~mapped_file() {
+  if (m_data) {
+    ::munmap(m_data, m_size);
+  }
+}
+
+void replace_file(const kdlcpp::string_type& path, std::string_view content, unsigned mode) {
+  kdlcpp::string_type temporary = path + ".kdlfmt-XXXXXX";
+  descriptor file{::mkstemp(temporary.data())};
+  if (file.fd < 0) {
+    throw_errno(path);
+  }
+
+  const auto fail = [&] {
+    const int error = errno;
+    ::unlink(temporary.c_str());
+    errno = error;
+    throw_errno(path);
+  };
+
+  while (!content.empty()) {
+    const auto written = ::write(file.fd, content.data(), content.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      fail();
+    }
+    content.remove_prefix(static_cast<std::size_t>(written));
+  }
+  if (::fchmod(file.fd, static_cast<mode_t>(mode)) != 0) {
+    fail();
+  }
+  if (::rename(temporary.c_str(), path.c_str()) != 0) {
+    fail();
+  }
+}
+
+} // namespace kdlfmt
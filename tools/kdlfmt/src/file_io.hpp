@@ -0,0 +1,57 @@
+#pragma once
+
+#include "kdlcpp/common.hpp"
+
+#include <string_view>
+
+namespace kdlfmt {
+
+/**
+ * A read-only memory mapping of a whole file.
+ */
+class mapped_file {
+public:
+  /**
+   * Maps a file.
+   * @param path The file to map.
+   * @throws std::system_error If the file cannot be opened or mapped.
+   */
+  explicit mapped_file(const kdlcpp::string_type& path);
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+  ~mapped_file();
+
+  /**
+   * Gets the content of the file.
+   */
+  [[nodiscard]] std::string_view view() const noexcept {
+    return {static_cast<const char*>(m_data), m_size};
+  }
+
+  /**
+   * Gets the permission bits of the file.
+   */
+  [[nodiscard]] unsigned mode() const noexcept {
+    return m_mode;
+  }
+
+private:
+  void* m_data{nullptr};
+  std::size_t m_size{0};
+  unsigned m_mode{0};
+};
+
+/**
+ * Replaces the content of a file atomically: the content is written to
+ * a temporary file in the same directory, which is then renamed over
+ * the target. Readers see either the old or the new content, never a
+ * partial one.
+ * @param path The file to replace.
+ * @param content The new content.
+ * @param mode The permission bits given to the new file.
+ * @throws std::system_error If the file cannot be written.
+ */
+void replace_file(const kdlcpp::string_type& path, std::string_view content, unsigned mode);
+
+} // namespace kdlfmt
@@ -0,0 +1,358 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "kdlcpp/serialize_options.hpp"
+#include "kdlcpp/thread_pool.hpp"
+#include "kdlcpp/detail/parse.hpp"
+#include "kdlcpp/detail/serialize.hpp"
+
+#include "file_io.hpp"
+
+/**
+ * kdlfmt checks, validates or reformats many KDL files in parallel.
+ *
+ * Usage: kdlfmt [options] [path...]
+ */
+
+namespace {
+
+constexpr const char* usage = R"(Usage: kdlfmt [options] [path...]
+
+Checks, validates or reformats KDL files in parallel. Directories are
+searched recursively for *.kdl files.
+
+Options:
+  --check           report the files that are not formatted (default)
+  --write           reformat the files that are not formatted, in place
+  --validate        only parse the files
+  --style NAME      standard, compact, pretty (default) or canonical
+  --indent N        indentation width of the pretty style (default 4)
+  --files-from FILE read more paths from FILE, one per line; - is stdin
+  -j, --jobs N      number of worker threads (default: one per core)
+  --slowest N       number of slowest files listed in the stats (default 5)
+  -q, --quiet       do not print the stats
+  -h, --help        print this help
+
+Properties are written sorted by key in every style.
+
+Files with comments, slashdashed content or type annotations are left
+out: --check skips them and --write refuses to rewrite them, as
+formatting drops all three.
+Exit status: 0 on success, 1 if a file is invalid, unreadable or, with
+--check, not formatted, or with --write, left out, 2 on usage errors.
+)";
+
+enum class mode { check, write, validate };
+
+struct options {
+  mode run_mode{mode::check};
+  kdlcpp::serialize_options layout{kdlcpp::serialize_options::style::pretty};
+  std::size_t jobs{0};
+  std::size_t slowest{5};
+  bool quiet{false};
+  std::vector<kdlcpp::string_type> paths;
+};
+
+/// The outcome of processing one file.
+struct file_result {
+  enum class status { unchanged, unformatted, reformatted, skipped, failed };
+
+  status outcome{status::unchanged};
+  std::size_t bytes{0};
+  double milliseconds{0};
+  kdlcpp::string_type message;
+};
+
+/// Gathers the formatted text of a file before it is written at once.
+struct string_sink {
+  kdlcpp::string_type text;
+
+  string_sink& operator<<(char c) {
+    text.push_back(c);
+    return *this;
+  }
+
+  string_sink& operator<<(std::string_view chunk) {
+    text.append(chunk);
+    return *this;
+  }
+
+  string_sink& operator<<(const char* chunk) {
+    return *this << std::string_view{chunk};
+  }
+
+  string_sink& operator<<(const kdlcpp::string_type& chunk) {
+    return *this << std::string_view{chunk};
+  }
+};
+
+[[noreturn]] void usage_error(const kdlcpp::string_type& message) {
+  std::cerr << "kdlfmt: " << message << "\n\n" << usage;
+  std::exit(2);
+}
+
+std::size_t parse_count(std::string_view flag, const char* text) {
+  char* end = nullptr;
+  const auto count = std::strtoul(text, &end, 10);
+  if (end == text || *end != '\0') {
+    usage_error(kdlcpp::string_type{flag} + " expects a number");
+  }
+  return count;
+}
+
+void read_path_list(const kdlcpp::string_type& list, std::vector<kdlcpp::string_type>& paths) {
+  std::ifstream file;
+  if (list != "-") {
+    file.open(list);
+    if (!file) {
+      usage_error("cannot open " + list);
+    }
+  }
+  std::istream& in = list == "-" ? std::cin : file;
+  for (kdlcpp::string_type line; std::getline(in, line);) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (!line.empty()) {
+      paths.push_back(std::move(line));
+    }
+  }
+}
+
+options parse_options(int argc, char** argv) {
+  options result;
+  // Sorted properties make the output independent of the standard
+  // library the tool was built with.
+  result.layout.sort_properties = true;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    const auto next = [&]() -> const char* {
+      if (i + 1 >= argc) {
+        usage_error(kdlcpp::string_type{arg} + " expects a value");
+      }
+      return argv[++i];
+    };
+
+    if (arg == "-h" || arg == "--help") {
+      std::cout << usage;
+      std::exit(0);
+    } else if (arg == "--check") {
+      result.run_mode = mode::check;
+    } else if (arg == "--write") {
+      result.run_mode = mode::write;
+    } else if (arg == "--validate") {
+      result.run_mode = mode::validate;
+    } else if (arg == "--style") {
+      const std::string_view name{next()};
+      using style = kdlcpp::serialize_options::style;
+      if (name == "standard") {
+        result.layout.output_style = style::standard;
+      } else if (name == "compact") {
+        result.layout.output_style = style::compact;
+      } else if (name == "pretty") {
+        result.layout.output_style = style::pretty;
+      } else if (name == "canonical") {
+        result.layout.output_style = style::canonical;
+      } else {
+        usage_error("unknown style " + kdlcpp::string_type{name});
+      }
+    } else if (arg == "--indent") {
+      result.layout.indent = parse_count(arg, next());
+    } else if (arg == "--files-from") {
+      read_path_list(next(), result.paths);
+    } else if (arg == "-j" || arg == "--jobs") {
+      result.jobs = parse_count(arg, next());
+    } else if (arg == "--slowest") {
+      result.slowest = parse_count(arg, next());
+    } else if (arg == "-q" || arg == "--quiet") {
+      result.quiet = true;
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      usage_error("unknown option " + kdlcpp::string_type{arg});
+    } else {
+      result.paths.emplace_back(arg);
+    }
+  }
+  if (result.paths.empty()) {
+    usage_error("no input files");
+  }
+  return result;
+}
+
+/// Expands directories into the *.kdl files below them, in a stable order.
+std::vector<kdlcpp::string_type> collect_files(const std::vector<kdlcpp::string_type>& paths) {
+  namespace fs = std::filesystem;
+  std::vector<kdlcpp::string_type> files;
+  for (const auto& path : paths) {
+    std::error_code error;
+    if (!fs::is_directory(path, error)) {
+      files.push_back(path);
+      continue;
+    }
+    std::vector<kdlcpp::string_type> found;
+    for (fs::recursive_directory_iterator it{path, error}, end; !error && it != end; it.increment(error)) {
+      if (it->is_regular_file(error) && it->path().extension() == ".kdl") {
+        found.push_back(it->path().string());
+      }
+    }
+    if (error) {
+      std::cerr << "kdlfmt: " << path << ": " << error.message() << '\n';
+    }
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+  }
+  return files;
+}
+
+file_result process(const kdlcpp::string_type& path, const options& opts) {
+  using clock = std::chrono::steady_clock;
+  const auto start = clock::now();
+  file_result result;
+
+  try {
+    const kdlfmt::mapped_file input{path};
+    const auto text = input.view();
+    result.bytes = text.size();
+    kdlcpp::document doc;
+    kdlcpp::detail::parse::dom_handler handler{doc.root()};
+    kdlcpp::detail::parse::parser<kdlcpp::detail::parse::dom_handler> parser{text, handler};
+    parser.parse_document();
+
+    // Comments and type annotations do not survive formatting: such files
+    // are never rewritten, and comparing them with their formatted text
+    // would always fail.
+    const char* const lost = parser.comments() != 0 ? "comments" :
+                             parser.annotations() != 0 ? "type annotations" : nullptr;
+    if (opts.run_mode != mode::validate && lost) {
+      if (opts.run_mode == mode::write) {
+        result.outcome = file_result::status::failed;
+        result.message = path + ": has " + lost + ", which formatting would drop; not rewritten";
+      } else {
+        result.outcome = file_result::status::skipped;
+      }
+    } else if (opts.run_mode != mode::validate) {
+      kdlcpp::stream<string_sink> out{string_sink{}};
+      out.get().text.reserve(text.size() + text.size() / 8);
+      for (const auto& node_ : doc.root().get_children()) {
+        kdlcpp::detail::serialize::serialize_node(out, node_, opts.layout);
+      }
+      const auto& formatted = out.get().text;
+      if (formatted != text) {
+        if (opts.run_mode == mode::write) {
+          kdlfmt::replace_file(path, formatted, input.mode());
+          result.outcome = file_result::status::reformatted;
+        } else {
+          result.outcome = file_result::status::unformatted;
+        }
+      }
+    }
+  } catch (const kdlcpp::parse_error& e) {
+    result.outcome = file_result::status::failed;
+    result.message = path + ':' + e.what();
+  } catch (const std::system_error& e) {
+    result.outcome = file_result::status::failed;
+    result.message = path + ": " + e.code().message();
+  } catch (const std::exception& e) {
+    result.outcome = file_result::status::failed;
+    result.message = path + ": " + e.what();
+  }
+
+  result.milliseconds =
+    std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  return result;
+}
+
+void print_stats(
+  const std::vector<kdlcpp::string_type>& files, const std::vector<file_result>& results,
+  double seconds, std::size_t threads, std::size_t slowest) {
+  std::size_t bytes = 0;
+  std::size_t counts[5] = {};
+  for (const auto& result : results) {
+    bytes += result.bytes;
+    ++counts[static_cast<std::size_t>(result.outcome)];
+  }
+  const double mib = static_cast<double>(bytes) / (1024.0 * 1024.0);
+  const double rate_seconds = std::max(seconds, 1e-9);
+
+  std::cout << std::fixed << std::setprecision(1)
+            << files.size() << " files, " << mib << " MiB in " << seconds * 1000.0 << " ms on "
+            << threads << " threads: "
+            << static_cast<double>(files.size()) / rate_seconds << " files/s, "
+            << mib / rate_seconds << " MiB/s\n"
+            << counts[static_cast<std::size_t>(file_result::status::unchanged)] << " formatted, "
+            << counts[static_cast<std::size_t>(file_result::status::unformatted)] << " not formatted, "
+            << counts[static_cast<std::size_t>(file_result::status::reformatted)] << " reformatted, "
+            << counts[static_cast<std::size_t>(file_result::status::skipped)] << " skipped for comments or annotations, "
+            << counts[static_cast<std::size_t>(file_result::status::failed)] << " failed\n";
+
+  std::vector<std::size_t> order(results.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  const auto listed = std::min(slowest, order.size());
+  std::partial_sort(order.begin(), order.begin() + listed, order.end(), [&](std::size_t a, std::size_t b) {
+    return results[a].milliseconds > results[b].milliseconds;
+  });
+  if (listed > 0) {
+    std::cout << "slowest files:\n";
+  }
+  for (std::size_t i = 0; i < listed; ++i) {
+    const auto& result = results[order[i]];
+    std::cout << std::setw(10) << result.milliseconds << " ms  "
+              << std::setw(10) << static_cast<double>(result.bytes) / 1024.0 << " KiB  "
+              << files[order[i]] << '\n';
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const auto opts = parse_options(argc, argv);
+  const auto files = collect_files(opts.paths);
+  std::vector<file_result> results(files.size());
+
+  const auto start = std::chrono::steady_clock::now();
+  std::size_t threads = 0;
+  {
+    kdlcpp::thread_pool pool{opts.jobs};
+    threads = pool.size();
+    for (std::size_t i = 0; i < files.size(); ++i) {
+      pool.submit([&, i] { results[i] = process(files[i], opts); });
+    }
+    pool.wait();
+  }
+  const double seconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  int status = 0;
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    switch (results[i].outcome) {
+      case file_result::status::failed:
+        std::cerr << results[i].message << '\n';
+        status = 1;
+        break;
+      case file_result::status::unformatted:
+        std::cerr << files[i] << ": not formatted\n";
+        status = 1;
+        break;
+      case file_result::status::reformatted:
+        std::cerr << files[i] << ": reformatted\n";
+        break;
+      case file_result::status::skipped:
+      case file_result::status::unchanged:
+        break;
+    }
+  }
+
+  if (!opts.quiet) {
+    print_stats(files, results, seconds, threads, opts.slowest);
+  }
+  return status;
+}